@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#pragma once
+
+/*
+ * libaql runs aql statements in process against an aerospike client owned by
+ * the caller. Results are handed over as client values instead of text:
+ *
+ *	aql_init(&as);
+ *	aql_stmt* stmt = aql_prepare("SELECT * FROM test.demo WHERE PK = 1", &cb, udata);
+ *	aql_execute(stmt, &cb, udata);
+ *	aql_stmt_destroy(stmt);
+ *	aql_destroy();
+ *
+ * The engine keeps its settings in process wide state, so there is one engine
+ * per process and calls are serialized internally.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_val.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+typedef struct aql_stmt_s aql_stmt;
+
+// Any callback may be NULL. Callbacks run on the calling thread or on client
+// threads for scans and queries, one at a time.
+typedef struct aql_callbacks_s {
+	// One result row: an as_record for record statements, an as_map for SHOW,
+	// DESC, EXPLAIN and the like, any as_val for aggregations and UDF results.
+	// val is only valid during the call. node is NULL for cluster wide
+	// results. A NULL val ends a result set. Returning false stops a scan or
+	// query early.
+	bool (* row)(const as_val* val, const as_node* node, void* udata);
+
+	// code is an as_status or -1 for aql's own errors.
+	void (* error)(int32_t code, const char* msg, void* udata);
+
+	// Statements without rows, e.g. INSERT, CREATE INDEX.
+	void (* ok)(const char* msg, void* udata);
+
+	// Status of a long running statement, e.g. records left to TRUNCATE.
+	void (* progress)(const char* msg, void* udata);
+} aql_callbacks;
+
+
+//==========================================================
+// Public API.
+//
+
+// Uses as, which stays owned by the caller. A disconnected client is
+// connected by the first statement which needs the cluster.
+bool aql_init(aerospike* as);
+void aql_destroy();
+
+// Same as the SET statement, e.g. aql_set("TIMEOUT", "500").
+bool aql_set(const char* name, const char* value);
+
+// Parses one statement. Parse errors go to cb and return NULL. SET, GET and
+// RESET take effect here and prepare to a statement which does nothing.
+aql_stmt* aql_prepare(const char* cmd, const aql_callbacks* cb, void* udata);
+
+// Runs a prepared statement, as often as needed. Returns false if an error
+// was passed to cb.
+bool aql_execute(aql_stmt* stmt, const aql_callbacks* cb, void* udata);
+
+void aql_stmt_destroy(aql_stmt* stmt);
@@ -21,6 +21,7 @@
 //==========================================================
 // Includes.
 //
+#include <signal.h>
 #include <stddef.h>
 
 #include <aerospike/aerospike.h>
@@ -46,12 +47,21 @@ typedef enum {
 	RAW = 3
 } output_t;
 
+// SET PROFILE, a named bundle of command policy settings. Changing any one of
+// them by hand makes the profile CUSTOM.
+typedef enum {
+	PROFILE_CUSTOM = 0,
+	PROFILE_INTERACTIVE = 1,
+	PROFILE_BULK = 2
+} policy_profile_t;
+
 typedef enum {
 	SECONDARY_INDEX_OP = 0,
 	PRIMARY_INDEX_OP,
 	INFO_OP,
 	SCAN_OP,
 	RUNFILE_OP,
+	LOCAL_OP,
 	OP_MAX = 6
 } atype;
 
@@ -60,12 +70,21 @@ typedef enum {
 	ASQL_OP_INSERT,
 	ASQL_OP_DELETE,
 	ASQL_OP_EXECUTE,
+	ASQL_OP_UPDATE,
+	ASQL_OP_TOUCH,
+	ASQL_OP_TRUNCATE,
 
 	ASQL_OP_SELECT,
 	ASQL_OP_AGGREGATE,
+	ASQL_OP_TAIL,
+	ASQL_OP_COMPARE,
+	ASQL_OP_PROFILE,
+	ASQL_OP_SCAN,
 
 	ASQL_OP_REGISTER,
 	ASQL_OP_REMOVE,
+	ASQL_OP_CREATE,
+	ASQL_OP_DROP,
 
 	ASQL_OP_SHOW,
 	ASQL_OP_DESC,
@@ -84,8 +103,16 @@ typedef struct asql_base_config {
 	char* host;
 	char* tls_name;
 	bool use_services_alternate;
+	bool use_shm;
+	int shm_key;
 	int port;
 
+	// Read routing. rack_id -1 means not rack aware.
+	int rack_id;
+	char* replica;      // master | any | sequence | prefer-rack
+	char* read_mode_ap; // one | all
+	char* read_mode_sc; // session | linearize | allow-replica | allow-unavailable
+
 	char* user;
 	char* password;
 	as_config_tls tls;
@@ -94,12 +121,22 @@ typedef struct asql_base_config {
 	// Env specific config with set option.
 	bool verbose;
 	bool echo;
+	bool unattended; // never prompt on stdin, set in --serve sessions
+	bool embedded;   // libaql, messages go to the renderer instead of stdout
+	bool shared;     // --serve and libaql, other callers wait while a statement runs
 	output_t outputmode;
 	bool outputtypes;
 	int timeout_ms;
 	int socket_timeout_ms;
+	int min_conns_per_node;  // -1 means use the C client default
+	int max_conns_per_node;
+	int conn_pools_per_node;
 	char* lua_userpath;
 	char* auth_mode;
+
+	// Daemon socket to serve on (--serve) or to send statements to (--socket).
+	char* serve_path;
+	char* socket_path;
 } asql_base_config;
 
 typedef struct asql_config {
@@ -114,6 +151,17 @@ typedef struct asql_config {
 	bool durable_delete;
 	int scan_records_per_second;
 	bool no_bins;
+	int reduce_threads; // > 1 splits client-side aggregation reduce
+	int index_wait_ms;  // index builds waited on give up after this
+
+	// Command policies, see policy_profile_t.
+	policy_profile_t profile;
+	int max_retries;           // -1 means use the C client default
+	int sleep_between_retries; // ms, -1 means use the C client default
+	bool compress;
+	bool concurrent;           // scans and batches to all nodes in parallel
+	bool short_query;
+	int record_exists;         // as_policy_exists for INSERT
 
 
 } asql_config;
@@ -134,14 +182,89 @@ typedef struct {
 	as_vector* values;
 } insert_param;
 
+typedef enum {
+	ASQL_UPDATE_OP_WRITE = 0,
+	ASQL_UPDATE_OP_INCR,
+	ASQL_UPDATE_OP_CONCAT,
+	ASQL_UPDATE_OP_LIST_APPEND,
+	ASQL_UPDATE_OP_MAP_PUT,
+	ASQL_UPDATE_OP_TOUCH
+} asql_update_op_type;
+
+typedef struct {
+	asql_update_op_type type;
+	asql_name bname;
+	asql_value key;   // MAP_PUT only
+	asql_value value;
+} asql_update_op;
+
+typedef struct {
+	as_vector* ops;
+	bool has_ttl; // TOUCH ... TTL <n>, otherwise RECORD_TTL applies
+	uint32_t ttl;
+} update_param;
+
+// Destination of INSERT INTO <ns>[.<set>] SELECT ...
+typedef struct {
+	asql_name ns;
+	asql_name set;
+} copy_param;
+
 typedef struct {
 	asql_name udfpkg;
 	asql_name udfname;
 	as_vector* params;
 } udf_param;
 
+typedef enum {
+	ASQL_CDT_STEP_INDEX = 0, // [i]
+	ASQL_CDT_STEP_RANGE,     // [beg:end], either bound may be omitted
+	ASQL_CDT_STEP_KEY        // ['key']
+} asql_cdt_step_type;
+
 typedef struct {
-	as_vector* bnames;
+	asql_cdt_step_type type;
+	int64_t beg;
+	int64_t end;
+	bool has_beg;
+	bool has_end;
+	asql_value key;
+} asql_cdt_step;
+
+typedef enum {
+	ASQL_EXPR_BIN = 0,
+	ASQL_EXPR_VALUE,
+	ASQL_EXPR_ADD,
+	ASQL_EXPR_SUB,
+	ASQL_EXPR_MUL,
+	ASQL_EXPR_DIV,
+	ASQL_EXPR_LIST_SIZE,
+	ASQL_EXPR_MAP_SIZE
+} asql_expr_type;
+
+// Computed SELECT column, evaluated on the server as a read expression.
+typedef struct asql_expr_s {
+	asql_expr_type type;
+	asql_name bname;   // BIN, LIST_SIZE, MAP_SIZE
+	as_vector* path;   // BIN only, asql_cdt_step
+	asql_value value;  // VALUE
+	struct asql_expr_s* left;
+	struct asql_expr_s* right;
+} asql_expr;
+
+typedef struct {
+	asql_name bname;
+	as_vector* path; // asql_cdt_step, NULL selects the whole bin
+	asql_expr* expr; // computed column, bname and path are unused
+} asql_projection;
+
+typedef struct {
+	as_vector* bnames; // output column names
+	as_vector* projs;  // asql_projection per column, NULL for plain bins
+	bool count;        // SELECT COUNT(*)
+	bool exists;       // SELECT EXISTS
+	bool header;       // only {ttl} / {gen}, read from the record header
+	int64_t since;     // SINCE, last-update-time in ns since epoch, 0 if unset
 } select_param;
 
 typedef struct {
@@ -182,11 +305,16 @@ typedef struct runfile_config {
 extern char* DEFAULTPASSWORD;
 extern asql_config* g_config;
 extern aerospike* g_aerospike;
+extern volatile sig_atomic_t g_interrupted; // Ctrl-C while a command runs
 
 //==========================================================
 // Public API.
 //
 
+bool asql_connect();
+void asql_policy_base_init(asql_config* c, as_policy_base* p);
+bool asql_hints_apply(asql_config* c, char* cmd, asql_config* hinted);
+aconfig* asql_prepare(asql_config* c, char* cmd, asql_config* hinted);
 bool parse_and_run(asql_config* c, char* cmd);
 bool parse_and_run_colon_delim(asql_config* c, char* cmd);
 const char* map_enum_to_string(map_enum_string map[], int value);
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+#pragma once
+
+
+//==========================================================
+// Includes.
+//
+
+#include <asql_query.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+typedef enum {
+	ASQL_ADVICE_INDEXED = 0, // answered by an index on the bin
+	ASQL_ADVICE_FILTERED,    // filter on records read through another bin's index
+	ASQL_ADVICE_NO_INDEX     // rejected, only a scan could answer it
+} asql_advice_outcome;
+
+
+//=========================================================
+// Public API.
+//
+
+void asql_advice_record(const char* ns, const char* set, const asql_where* where, const char* itype, asql_advice_outcome outcome, double reads);
+int asql_advice_show(asql_config* c);
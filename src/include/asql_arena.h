@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#pragma once
+
+//==========================================================
+// Includes.
+//
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+// Bump allocator over one reserved address range. Pages are made usable as
+// allocations reach them and stay so, memory is only given back by rewinding
+// to a mark, which releases everything allocated since in one shot. Being one
+// range, whether the arena owns a pointer is a bounds check.
+typedef struct asql_arena_s {
+	uint8_t* base; // reserved by the first allocation
+	size_t reserve;
+	size_t committed;
+	size_t used;
+	size_t peak;
+} asql_arena;
+
+typedef struct asql_arena_mark_s {
+	size_t used;
+} asql_arena_mark;
+
+
+//==========================================================
+// Public API.
+//
+
+void asql_arena_init(asql_arena* a, size_t reserve);
+void* asql_arena_alloc(asql_arena* a, size_t size);
+char* asql_arena_strndup(asql_arena* a, const char* s, size_t len);
+asql_arena_mark asql_arena_get_mark(const asql_arena* a);
+void asql_arena_rewind(asql_arena* a, asql_arena_mark mark);
+bool asql_arena_owns(const asql_arena* a, const void* p);
+void asql_arena_destroy(asql_arena* a);
+
+// The statement arena holds the names and values a statement is parsed into
+// from asql_stmt_begin() until the matching asql_stmt_end(). Outside of a
+// statement, or should the arena run out, these fall back to the heap, and
+// asql_stmt_free() frees heap pointers, so parsed structures may mix both.
+asql_arena_mark asql_stmt_begin();
+void asql_stmt_end(asql_arena_mark mark);
+void* asql_stmt_malloc(size_t size);
+char* asql_stmt_strdup(const char* s);
+void asql_stmt_free(void* p);
+
+// Peak bytes of the last top level statement and of any so far, and the
+// bytes the arena keeps usable for the next statements.
+void asql_stmt_arena_stats(size_t* last_peak, size_t* max_peak,
+		size_t* committed);
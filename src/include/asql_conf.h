@@ -34,9 +34,11 @@ bool config_init(asql_config* c, int argc, char *argv[], char** cmd, char** fnam
 bool config_free(asql_config* c);
 void print_config_help(int argc, char* argv[]);
 
+struct asql_set_option_s* option_table_new();
 void option_init(asql_config* c, struct asql_set_option_s* table);
 void option_free(struct asql_set_option_s* table);
 bool option_set(struct asql_config* c, char* name, char* value);
 bool option_reset(struct asql_config* c, char* name);
 bool option_get(struct asql_config* c, char* name);
+bool option_profile_apply(struct asql_config* c, const char* name);
 void print_option_help();
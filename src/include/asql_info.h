@@ -21,11 +21,24 @@
 // Includes.
 //
 
+#include <aerospike/aerospike_index.h>
+
 
 //==========================================================
 // Typedefs & Constants.
 //
 
+typedef struct index_param {
+	asql_name ns;
+	asql_name set;
+	asql_name iname;
+	asql_name bname;
+	as_index_type itype;
+	as_index_datatype dtype;
+	as_vector* ctx; // asql_cdt_step, NULL unless CTX was given
+	bool wait;      // CREATE ... WAIT, block until readable on all nodes
+} index_param;
+
 typedef struct info_config {
 	atype type;
 	asql_optype optype;
@@ -33,6 +46,8 @@ typedef struct info_config {
 	char* cmd;
 	char* backout_cmd;
 	bool is_ddl;
+
+	index_param* index; // CREATE / DROP INDEX
 } info_config;
 
 //=========================================================
@@ -41,3 +56,4 @@ typedef struct info_config {
 
 int asql_info(asql_config* c, aconfig* ac);
 info_config* asql_info_config_create(int optype, char* cmd, char* backout_cmd, bool is_ddl);
+int asql_index_wait_pending(asql_config* c, const char* ns, const char* bname);
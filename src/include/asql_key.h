@@ -23,6 +23,7 @@
 //
 
 #include <aerospike/as_hashmap.h>
+#include <aerospike/as_operations.h>
 #include <aerospike/as_record.h>
 
 //==========================================================
@@ -32,7 +33,8 @@
 typedef enum {
 	DELETE_OP = 0,
 	WRITE_OP = 1,
-	READ_OP = 2
+	READ_OP = 2,
+	UPDATE_OP = 3
 } pk_op;
 
 typedef struct pk_config {
@@ -48,9 +50,14 @@ typedef struct pk_config {
 	insert_param i;
 	select_param s;
 	udf_param u;
+	update_param up;
 	asql_value key;
+	as_vector* keys; // PK IN (...) batch, NULL for single key
 } pk_config;
 
+// Streaming INSERT INTO ... SELECT writer, see asql_copy_create().
+typedef struct asql_copy_s asql_copy;
+
 
 //=========================================================
 // Public API.
@@ -58,3 +65,10 @@ typedef struct pk_config {
 
 int asql_key(asql_config* c, aconfig* ac);
 void asql_record_set_renderer(as_record* rec, as_hashmap* m, char* bin_name, as_val* val);
+int asql_update_ops_init(as_error* err, as_vector* uops, as_operations* ops);
+int asql_projection_ops_init(as_error* err, select_param* s, as_operations* ops);
+void asql_record_set_header(as_record* rec, const as_key* key, const as_record* meta);
+bool asql_render_header(const as_val* val, void* rview);
+asql_copy* asql_copy_create(asql_config* c, copy_param* into, const char* src_set, as_error* err);
+bool asql_copy_callback(const as_val* val, void* udata);
+void asql_copy_finish(asql_copy* cp, as_error* err);
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#pragma once
+
+
+//==========================================================
+// Includes.
+//
+
+#include <asql.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+#define LOCAL_SAMPLE_DEFAULT 100
+
+// EXECUTE LOCAL / AGGREGATE LOCAL: run a UDF in the embedded Lua runtime
+// against records read from the cluster, or from a JSON-lines file.
+typedef struct local_config {
+	atype type;
+	asql_optype optype;
+
+	asql_name ns;
+	asql_name set;
+
+	udf_param u;
+
+	as_vector* keys; // asql_value, WHERE PK = / PK IN, otherwise sampled
+	uint32_t sample;
+	char* file;      // FILE '<path>', one JSON object of bins per line
+} local_config;
+
+
+//=========================================================
+// Public API.
+//
+
+int asql_local(asql_config* c, aconfig* ac);
@@ -31,12 +31,21 @@ aconfig* aql_parse_insert(tokenizer* tknzr);
 aconfig* aql_parse_explain(tokenizer* tknzr);
 aconfig* aql_parse_delete(tokenizer* tknzr);
 aconfig* aql_parse_execute(tokenizer* tknzr);
+aconfig* aql_parse_update(tokenizer* tknzr);
+aconfig* aql_parse_touch(tokenizer* tknzr);
+aconfig* aql_parse_truncate(tokenizer* tknzr);
 
 aconfig* aql_parse_select(tokenizer* tknzr);
 aconfig* aql_parse_aggregate(tokenizer* tknzr);
+aconfig* aql_parse_tail(tokenizer* tknzr);
+aconfig* aql_parse_compare(tokenizer* tknzr);
+aconfig* aql_parse_profile(tokenizer* tknzr);
+aconfig* aql_parse_scan(tokenizer* tknzr);
 
 aconfig* aql_parse_registerudf(tokenizer* tknzr);
 aconfig* aql_parse_removeudf(tokenizer* tknzr);
+aconfig* aql_parse_create(tokenizer* tknzr);
+aconfig* aql_parse_drop(tokenizer* tknzr);
 
 aconfig* aql_parse_show(tokenizer* tknzr);
 aconfig* aql_parse_desc(tokenizer* tknzr);
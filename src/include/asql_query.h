@@ -52,6 +52,8 @@ typedef struct sk_config {
 
 	select_param s;
 	udf_param u;
+	update_param up;
+	copy_param into;
 
 	asql_name itype;
 
@@ -66,3 +68,4 @@ typedef struct sk_config {
 //
 
 int asql_query(asql_config* c, aconfig* ac);
+void asql_filter_since(as_exp** filter, int64_t since);
@@ -37,8 +37,14 @@ typedef struct scan_config {
 
 	select_param s;
 	udf_param u;
+	update_param up;
+	copy_param into;
 
 	asql_value* limit;
+	uint32_t interval_ms; // TAIL
+	int64_t before;       // TRUNCATE ... BEFORE, ns since epoch, 0 if unset
+	char* host;           // COMPARE ... WITH HOST, seed of the other cluster
+	char* node;           // SELECT ... ON NODE, scan this node only
 } scan_config;
 
 
@@ -47,3 +53,4 @@ typedef struct scan_config {
 //
 
 int asql_scan(asql_config* c, aconfig* ac);
+as_status asql_set_object_count(asql_config* c, const char* ns, const char* set, uint64_t* count, as_error* err);
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+#pragma once
+
+
+//==========================================================
+// Includes.
+//
+
+#include <asql.h>
+
+
+//=========================================================
+// Public API.
+//
+
+// Daemon side, serves statements on a unix domain socket using the already
+// connected g_aerospike. Returns only on error.
+bool asql_serve(asql_config* c, const char* path);
+
+// Thin client side, sends cmd (or what is read from in_fd when cmd is NULL)
+// to a daemon and copies its output to stdout. Returns the process exit
+// status.
+int asql_serve_client(const char* path, const char* cmd, int in_fd);
@@ -22,6 +22,8 @@
 //
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <sql-lexer.h>
 
@@ -34,6 +36,7 @@ typedef struct tokenizer
 {
   char* tok;
   char* ocmd;
+  char* tok_copy; // keeps tok valid across a peek
 } tokenizer;
 
 
@@ -50,6 +53,13 @@ get_next_token (tokenizer* tknzr)
 static inline char*
 peek_next_token(tokenizer *tknzr)
 {
+  // Peeking rescans the lexer buffer, which invalidates the current token.
+  if (tknzr->tok && tknzr->tok != tknzr->tok_copy) {
+    free(tknzr->tok_copy);
+    tknzr->tok_copy = strdup(tknzr->tok);
+    tknzr->tok = tknzr->tok_copy;
+  }
+
   char* peek;
   as_sql_lexer(0, &peek, true);
   return peek;
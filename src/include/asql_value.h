@@ -68,4 +68,5 @@ int asql_set_args(as_error* err, as_vector *udfargs, as_arraylist* arglist);
 int asql_parse_value_as(char* s, asql_value* value, asql_value_type_t vtype);
 void asql_free_value(void*);
 char* asql_val_str(const as_val* val);
+as_val* asql_value_to_val(as_error* err, asql_value* value);
 asql_value_type_t asql_value_type_from_type_name(char* str);
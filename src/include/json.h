@@ -36,3 +36,4 @@
 int as_json_print(const as_val*);
 as_val* as_json_arg(char*, asql_value_type_t);
 void as_json_print_as_val(const as_val* val, int indent, bool metadata, bool no_bins);
+void as_json_print_named_val(const char* name, const as_val* val, int indent);
@@ -38,13 +38,19 @@
 #define COL_NAME_META_EDIGEST	"{edigest}"
 #define COL_NAME_META_TTL_NAME	"{ttl}"
 #define COL_NAME_META_GEN_NAME	"{gen}"
+#define COL_NAME_EXISTS			"exists"
 
 typedef struct {
 	void* (* view_new)(const as_node* node);
 	void (* view_destroy)(void* view);
 	bool (* render)(const as_val* val, void* view);
+	// One single column row named <name> per value, for value streams.
+	bool (* render_values)(const char* name, as_val** vals, uint32_t n_vals, void* view);
 	void (* render_error)(const int32_t code, const char* msg, void* view);
 	void (* render_ok)(const char* msg, void* view);
+	// Status of a statement still running, each replaces the last. NULL ends
+	// the status line.
+	void (* render_progress)(const char* msg, void* view);
 	void (* view_set_cols)(as_vector* bnames, void* view);
 	void (* view_set_node)(const as_node* node, void* view);
 } renderer;
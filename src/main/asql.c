@@ -19,19 +19,25 @@
 // Includes.
 //
 
+#include <ctype.h>
 #include <errno.h>
 #include <stdlib.h>
 
 #include <aerospike/as_log_macros.h>
 
 #include <asql.h>
+#include <asql_arena.h>
+#include <asql_conf.h>
 #include <asql_info.h>
 #include <asql_key.h>
+#include <asql_local.h>
 #include <asql_parser.h>
 #include <asql_print.h>
 #include <asql_query.h>
 #include <asql_scan.h>
 
+#include "renderer/table.h"
+
 
 //==========================================================
 // Typedefs & constants.
@@ -57,18 +63,36 @@ typedef struct {
 //
 
 static aconfig* parse(char* cmd);
+static bool needs_cluster(aconfig* ac);
 
 static int runfile(asql_config* c, aconfig* ac);
 
 static void destroy_select_param(select_param* s);
 static void destroy_insert_param(insert_param* i);
 static void destroy_udf_param(udf_param* u);
+static void destroy_update_param(update_param* u);
+static void destroy_copy_param(copy_param* cp);
+static void destroy_index_param(index_param* ip);
 static void destroy_where(asql_where* w);
 static void destroy_pkconfig(aconfig* ac);
 static void destroy_skconfig(aconfig* ac);
 static void destroy_infoconfig(aconfig* ac);
 static void destroy_scanconfig(aconfig* ac);
 static void destroy_runfileconfig(aconfig* ac);
+static void destroy_localconfig(aconfig* ac);
+
+
+//=========================================================
+// Globals.
+//
+
+// Engine state shared by the aql binary and libaql. The owner points
+// g_aerospike at its client before the first statement runs.
+bool g_inprogress = false;
+volatile sig_atomic_t g_interrupted = 0;
+asql_config* g_config = NULL;
+aerospike* g_aerospike = NULL;
+renderer* g_renderer = &table_renderer;
 
 
 //=========================================================
@@ -81,6 +105,7 @@ const op_fn op_map[OP_MAX] = {
 	asql_info,
 	asql_scan,
 	runfile,
+	asql_local,
 };
 
 const parse_entry parse_table[ASQL_OP_MAX] = {
@@ -88,12 +113,21 @@ const parse_entry parse_table[ASQL_OP_MAX] = {
 	{ "INSERT", aql_parse_insert },
 	{ "DELETE", aql_parse_delete },
 	{ "EXECUTE", aql_parse_execute },
+	{ "UPDATE", aql_parse_update },
+	{ "TOUCH", aql_parse_touch },
+	{ "TRUNCATE", aql_parse_truncate },
 
 	{ "SELECT", aql_parse_select },
 	{ "AGGREGATE", aql_parse_aggregate },
+	{ "TAIL", aql_parse_tail },
+	{ "COMPARE", aql_parse_compare },
+	{ "PROFILE", aql_parse_profile },
+	{ "SCAN", aql_parse_scan },
 
 	{ "REGISTER", aql_parse_registerudf },
 	{ "REMOVE", aql_parse_removeudf },
+	{ "CREATE", aql_parse_create },
+	{ "DROP", aql_parse_drop },
 
 	{ "SHOW", aql_parse_show },
 	{ "DESC", aql_parse_desc },
@@ -111,6 +145,7 @@ const destroy_fn destroy_table[OP_MAX] = {
 	destroy_infoconfig,
 	destroy_scanconfig,
 	destroy_runfileconfig,
+	destroy_localconfig,
 };
 
 
@@ -123,7 +158,7 @@ destroy_vector(as_vector* list, bool is_name)
 {
 	for (uint32_t i = 0; i < list->size; i++) {
 		if (is_name) {
-			free(as_vector_get_ptr(list, i));
+			asql_stmt_free(as_vector_get_ptr(list, i));
 		}
 		else {
 			asql_free_value(as_vector_get(list, i));
@@ -131,6 +166,51 @@ destroy_vector(as_vector* list, bool is_name)
 	}
 }
 
+void
+destroy_cdt_path(as_vector* path)
+{
+	if (!path) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < path->size; i++) {
+		asql_cdt_step* step = as_vector_get(path, i);
+		asql_free_value(&step->key);
+	}
+	as_vector_destroy(path);
+}
+
+void
+destroy_expr(asql_expr* expr)
+{
+	if (!expr) {
+		return;
+	}
+
+	destroy_expr(expr->left);
+	destroy_expr(expr->right);
+	destroy_cdt_path(expr->path);
+	asql_stmt_free(expr->bname);
+	asql_free_value(&expr->value);
+	free(expr);
+}
+
+void
+destroy_projections(as_vector* projs)
+{
+	if (!projs) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < projs->size; i++) {
+		asql_projection* proj = as_vector_get(projs, i);
+		asql_stmt_free(proj->bname);
+		destroy_cdt_path(proj->path);
+		destroy_expr(proj->expr);
+	}
+	as_vector_destroy(projs);
+}
+
 int
 destroy_aconfig(aconfig* ac)
 {
@@ -149,6 +229,11 @@ run(void* o)
 {
 	asql_config* c = (asql_config*)((asql_op*)o)->c;
 	aconfig* ac = (aconfig*)((asql_op*)o)->ac;
+
+	if (needs_cluster(ac) && ! asql_connect()) {
+		return 1;
+	}
+
 	if (op_map[ac->type]) {
 		return op_map[ac->type](c, ac);
 	}
@@ -222,15 +307,244 @@ parse_and_run(asql_config* c, char* cmd)
 		return true;
 	}
 
+	// Hints tune this statement only, on a copy of the session settings.
+	asql_config hinted;
+
+	if (strstr(cmd, "/*+")) {
+		if (!asql_hints_apply(c, cmd, &hinted)) {
+			return true;
+		}
+		c = &hinted;
+	}
+
+	// Names and values the statement parses into live in the statement arena
+	// and go away in one shot once it has run.
+	asql_arena_mark mark = asql_stmt_begin();
+
 	aconfig* ac = parse(cmd);
-	if (!ac) {
+	if (ac) {
+		asql_op op = { .c = c, .ac = ac, .backout = false, };
+		run((void*)&op);
+
+		destroy_aconfig(ac);
+	}
+
+	asql_stmt_end(mark);
+	return true;
+}
+
+// Parses cmd without running it, for callers which run the statement later,
+// possibly more than once. Hints land in hinted like for parse_and_run.
+aconfig*
+asql_prepare(asql_config* c, char* cmd, asql_config* hinted)
+{
+	if (!asql_hints_apply(c, cmd, hinted)) {
+		return NULL;
+	}
+
+	return parse(cmd);
+}
+
+// Connects on first use, so statements which never touch the cluster (SET,
+// GET, HELP, RUN of such statements, LOCAL against a file) skip the connect
+// and tend entirely.
+bool
+asql_connect()
+{
+	if (g_aerospike->cluster) {
+		return true;
+	}
+
+	// Pool sizes may have been SET since asql_init. A non zero minimum makes
+	// the client open that many connections to each node as it is added, so
+	// the first scan or batch does not pay for connection setup and TLS
+	// handshakes.
+	as_config* config = &g_aerospike->config;
+
+	if (g_config->base.min_conns_per_node >= 0) {
+		config->min_conns_per_node = g_config->base.min_conns_per_node;
+	}
+
+	if (g_config->base.max_conns_per_node > 0) {
+		config->max_conns_per_node = g_config->base.max_conns_per_node;
+	}
+
+	if (g_config->base.conn_pools_per_node > 0) {
+		config->conn_pools_per_node = g_config->base.conn_pools_per_node;
+	}
+
+	if (config->min_conns_per_node > config->max_conns_per_node) {
+		fprintf(stderr, "MIN_CONNS_PER_NODE %u is more than MAX_CONNS_PER_NODE %u\n",
+				config->min_conns_per_node, config->max_conns_per_node);
+		return false;
+	}
+
+	as_error err;
+
+	aerospike_connect(g_aerospike, &err);
+
+	if (err.code != AEROSPIKE_OK) {
+		fprintf(stderr, "Error %d: %s\n", err.code, err.message);
+		return false;
+	}
+
+	return true;
+}
+
+void
+asql_policy_base_init(asql_config* c, as_policy_base* p)
+{
+	p->total_timeout = c->base.timeout_ms;
+	if (c->base.socket_timeout_ms > -1) {
+		// set if non-default value
+		p->socket_timeout = c->base.socket_timeout_ms;
+	}
+
+	if (c->max_retries > -1) {
+		p->max_retries = c->max_retries;
+	}
+
+	if (c->sleep_between_retries > -1) {
+		p->sleep_between_retries = c->sleep_between_retries;
+	}
+
+	p->compress = c->compress;
+}
+
+// Copies c into hinted and applies an optimizer style comment, e.g.
+// "SELECT /*+ PARALLEL RPS(5000) COMPRESS */ * FROM test.demo". The
+// comment is blanked out of cmd so the parser never sees it.
+bool
+asql_hints_apply(asql_config* c, char* cmd, asql_config* hinted)
+{
+	memcpy(hinted, c, sizeof(asql_config));
+
+	bool in_dquote = false;
+	bool in_squote = false;
+	char* start = NULL;
+
+	for (char* p = cmd; *p; p++) {
+		// An escaped quote does not end a string, e.g. 'it\'s'.
+		if (*p == '\\' && (in_dquote || in_squote) && p[1]) {
+			p++;
+		}
+		else if (*p == '"' && !in_squote) {
+			in_dquote = !in_dquote;
+		}
+		else if (*p == '\'' && !in_dquote) {
+			in_squote = !in_squote;
+		}
+		else if (!in_dquote && !in_squote && !strncmp(p, "/*+", 3)) {
+			start = p;
+			break;
+		}
+	}
+
+	if (!start) {
 		return true;
 	}
 
-	asql_op op = { .c = c, .ac = ac, .backout = false, };
-	run((void*)&op);
+	char* end = strstr(start + 3, "*/");
+
+	if (!end) {
+		g_renderer->render_error(AEROSPIKE_ERR_PARAM, "Unterminated hint", NULL);
+		return false;
+	}
+
+	char hints[end - start - 2];
+	memcpy(hints, start + 3, end - start - 3);
+	hints[end - start - 3] = '\0';
+	memset(start, ' ', end + 2 - start);
+
+	char* p = hints;
+
+	// NAME or NAME(arg), blanks are allowed around the argument.
+	while (*(p += strspn(p, " \t\n,"))) {
+		char* h = p;
+		p += strcspn(p, " \t\n,(");
+		char* h_end = p;
+		p += strspn(p, " \t\n");
+
+		char* arg = NULL;
+
+		if (*p == '(') {
+			char* close = strchr(p, ')');
+
+			if (!close) {
+				g_renderer->render_error(AEROSPIKE_ERR_PARAM,
+						"Unterminated hint argument", NULL);
+				return false;
+			}
+
+			arg = p + 1 + strspn(p + 1, " \t\n");
+			*close = '\0';
+
+			for (char* t = close; t > arg && isspace((unsigned char)t[-1]); t--) {
+				t[-1] = '\0';
+			}
+
+			p = close + 1;
+		}
+		else if (*h_end) {
+			p = h_end + 1;
+		}
+
+		*h_end = '\0';
+
+		char* arg_end = NULL;
+		long n = arg ? strtol(arg, &arg_end, 10) : 0;
+		bool num = arg && *arg && *arg_end == '\0';
+
+		bool ok = true;
+
+		// The client fans a scan or batch out to every node at once or to
+		// one node at a time, there is no degree in between. Aggregations
+		// keep REDUCE_THREADS, their merge is not a scheduling choice.
+		if (!strcasecmp(h, "PARALLEL") && (!arg || (num && n == 1))) {
+			hinted->concurrent = !arg;
+		}
+		else if (!strcasecmp(h, "PARALLEL") && num && n > 1) {
+			g_renderer->render_error(AEROSPIKE_ERR_PARAM,
+					"PARALLEL degree not supported, use PARALLEL for all nodes at once or PARALLEL(1) for one at a time",
+					NULL);
+			return false;
+		}
+		else if (!strcasecmp(h, "RPS") && num && n >= 0) {
+			hinted->scan_records_per_second = (int)n;
+		}
+		else if (!strcasecmp(h, "RETRIES") && num && n >= 0) {
+			hinted->max_retries = (int)n;
+		}
+		else if (!strcasecmp(h, "SLEEP") && num && n >= 0) {
+			hinted->sleep_between_retries = (int)n;
+		}
+		else if (!strcasecmp(h, "TIMEOUT") && num && n >= 0) {
+			hinted->base.timeout_ms = (int)n;
+		}
+		else if (!strcasecmp(h, "COMPRESS") && !arg) {
+			hinted->compress = true;
+		}
+		else if (!strcasecmp(h, "NOCOMPRESS") && !arg) {
+			hinted->compress = false;
+		}
+		else if (!strcasecmp(h, "SHORT") && !arg) {
+			hinted->short_query = true;
+		}
+		else if (!strcasecmp(h, "PROFILE") && arg) {
+			ok = option_profile_apply(hinted, arg);
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			char msg[128];
+			snprintf(msg, sizeof(msg), "Unknown hint %s", h);
+			g_renderer->render_error(AEROSPIKE_ERR_PARAM, msg, NULL);
+			return false;
+		}
+	}
 
-	destroy_aconfig(ac);
 	return true;
 }
 
@@ -302,6 +616,23 @@ runfile(asql_config* c, aconfig* ac)
 	return 0;
 }
 
+// RUN connects when its statements need to, LOCAL only when it reads records
+// from the cluster rather than a file.
+static bool
+needs_cluster(aconfig* ac)
+{
+	switch (ac->type) {
+		case RUNFILE_OP:
+			return false;
+
+		case LOCAL_OP:
+			return ((local_config*)ac)->file == NULL;
+
+		default:
+			return true;
+	}
+}
+
 static aconfig*
 parse(char* cmd)
 {
@@ -346,6 +677,8 @@ destroy_select_param(select_param* s)
 		destroy_vector(s->bnames, true);
 		as_vector_destroy(s->bnames);
 	}
+
+	destroy_projections(s->projs);
 }
 
 static void
@@ -364,8 +697,8 @@ destroy_insert_param(insert_param* i)
 static void
 destroy_udf_param(udf_param* u)
 {
-	if (u->udfpkg) free(u->udfpkg);
-	if (u->udfname) free(u->udfname);
+	if (u->udfpkg) asql_stmt_free(u->udfpkg);
+	if (u->udfname) asql_stmt_free(u->udfname);
 
 	if (u->params) {
 		destroy_vector(u->params, false);
@@ -373,6 +706,44 @@ destroy_udf_param(udf_param* u)
 	}
 }
 
+static void
+destroy_update_param(update_param* u)
+{
+	if (!u->ops) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < u->ops->size; i++) {
+		asql_update_op* op = as_vector_get(u->ops, i);
+		asql_stmt_free(op->bname);
+		asql_free_value(&op->key);
+		asql_free_value(&op->value);
+	}
+	as_vector_destroy(u->ops);
+}
+
+static void
+destroy_copy_param(copy_param* cp)
+{
+	if (cp->ns) asql_stmt_free(cp->ns);
+	if (cp->set) asql_stmt_free(cp->set);
+}
+
+static void
+destroy_index_param(index_param* ip)
+{
+	if (!ip) {
+		return;
+	}
+
+	if (ip->ns) asql_stmt_free(ip->ns);
+	if (ip->set) asql_stmt_free(ip->set);
+	if (ip->iname) asql_stmt_free(ip->iname);
+	if (ip->bname) asql_stmt_free(ip->bname);
+	destroy_cdt_path(ip->ctx);
+	free(ip);
+}
+
 static void
 destroy_where(asql_where* w)
 {
@@ -388,7 +759,7 @@ destroy_where(asql_where* w)
 		asql_free_value(&w->end);
 	}
 
-	free(w->ibname);
+	asql_stmt_free(w->ibname);
 }
 
 static void
@@ -396,13 +767,19 @@ destroy_pkconfig(aconfig* ac)
 {
 	pk_config* p = (pk_config*)ac;
 
-	if (p->ns) free(p->ns);
-	if (p->set) free(p->set);
+	if (p->ns) asql_stmt_free(p->ns);
+	if (p->set) asql_stmt_free(p->set);
 
 	destroy_insert_param(&p->i);
 	destroy_select_param(&p->s);
 	destroy_udf_param(&p->u);
+	destroy_update_param(&p->up);
 	asql_free_value(&p->key);
+
+	if (p->keys) {
+		destroy_vector(p->keys, false);
+		as_vector_destroy(p->keys);
+	}
 	free(p);
 }
 
@@ -411,12 +788,14 @@ destroy_skconfig(aconfig* ac)
 {
 	sk_config* s = (sk_config*)ac;
 
-	if (s->ns) free(s->ns);
-	if (s->set) free(s->set);
-	if (s->itype) free(s->itype);
+	if (s->ns) asql_stmt_free(s->ns);
+	if (s->set) asql_stmt_free(s->set);
+	if (s->itype) asql_stmt_free(s->itype);
 
 	destroy_select_param(&s->s);
 	destroy_udf_param(&s->u);
+	destroy_update_param(&s->up);
+	destroy_copy_param(&s->into);
 	destroy_where(&s->where);
 	destroy_where(s->where2);
 	free(s->where2);
@@ -430,8 +809,9 @@ destroy_infoconfig(aconfig* ac)
 {
 	info_config* i = (info_config*)ac;
 
-	if (i->cmd) free(i->cmd);
-	if (i->backout_cmd) free(i->backout_cmd);
+	if (i->cmd) asql_stmt_free(i->cmd);
+	if (i->backout_cmd) asql_stmt_free(i->backout_cmd);
+	destroy_index_param(i->index);
 	free(i);
 }
 
@@ -440,11 +820,15 @@ destroy_scanconfig(aconfig* ac)
 {
 	scan_config* s = (scan_config*)ac;
 
-	if (s->ns) free(s->ns);
-	if (s->set) free(s->set);
+	if (s->ns) asql_stmt_free(s->ns);
+	if (s->set) asql_stmt_free(s->set);
+	if (s->host) asql_stmt_free(s->host);
+	if (s->node) asql_stmt_free(s->node);
 
 	destroy_select_param(&s->s);
 	destroy_udf_param(&s->u);
+	destroy_update_param(&s->up);
+	destroy_copy_param(&s->into);
 	free(s->limit);
 	free(s);
 }
@@ -453,6 +837,24 @@ static void
 destroy_runfileconfig(aconfig* ac)
 {
 	runfile_config* r = (runfile_config*)ac;
-	if (r->fname) free(r->fname);
+	if (r->fname) asql_stmt_free(r->fname);
 	free(r);
+}
+
+static void
+destroy_localconfig(aconfig* ac)
+{
+	local_config* l = (local_config*)ac;
+
+	if (l->ns) asql_stmt_free(l->ns);
+	if (l->set) asql_stmt_free(l->set);
+
+	destroy_udf_param(&l->u);
+
+	if (l->keys) {
+		destroy_vector(l->keys, false);
+		as_vector_destroy(l->keys);
+	}
+	if (l->file) asql_stmt_free(l->file);
+	free(l);
 }
\ No newline at end of file
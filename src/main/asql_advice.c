@@ -0,0 +1,256 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <stdlib.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_string.h>
+#include <aerospike/as_vector.h>
+
+#include <renderer.h>
+#include <asql.h>
+#include <asql_advice.h>
+#include <asql_scan.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+// One predicate shape, the unit an index would be created for.
+typedef struct {
+	char ns[AS_NAMESPACE_MAX_SIZE];
+	char set[AS_SET_MAX_SIZE];
+	char bname[AS_BIN_NAME_MAX_SIZE];
+	as_val_t type;
+	char itype[16];
+
+	uint64_t n_indexed;
+	uint64_t n_filtered;
+	uint64_t n_no_index;
+	double filtered_reads; // records read through other indexes, estimated
+} advice_shape;
+
+typedef struct {
+	advice_shape* shape;
+	uint64_t saved;
+} advice_row;
+
+
+//==========================================================
+// Globals.
+//
+
+static as_vector* g_shapes = NULL;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static advice_shape* shape_get(const char* ns, const char* set, const asql_where* where, const char* itype);
+static const char* type_name(as_val_t type);
+static int row_cmp(const void* a, const void* b);
+
+
+//=========================================================
+// Public API.
+//
+
+void
+asql_advice_record(const char* ns, const char* set, const asql_where* where,
+		const char* itype, asql_advice_outcome outcome, double reads)
+{
+	if (!ns || !where || !where->ibname) {
+		return;
+	}
+
+	advice_shape* shape = shape_get(ns, set, where, itype);
+
+	switch (outcome) {
+		case ASQL_ADVICE_INDEXED:
+			shape->n_indexed++;
+			break;
+		case ASQL_ADVICE_FILTERED:
+			shape->n_filtered++;
+			shape->filtered_reads += reads;
+			break;
+		case ASQL_ADVICE_NO_INDEX:
+			shape->n_no_index++;
+			break;
+	}
+}
+
+// SHOW INDEX ADVICE
+// Predicates are only kept in this process' memory, the OK message says so
+// since an "aql -c" run starts with none. Each predicate that had no index
+// of its own is a candidate. A rejected predicate is charged a full scan of
+// its set, a filtered one the records read through the index that answered
+// it. Candidates are listed by that estimate, largest first.
+int
+asql_advice_show(asql_config* c)
+{
+	uint32_t n_shapes = g_shapes ? g_shapes->size : 0;
+	advice_row* rows = malloc(sizeof(advice_row) * (n_shapes ? n_shapes : 1));
+	uint32_t n_rows = 0;
+
+	for (uint32_t i = 0; i < n_shapes; i++) {
+		advice_shape* shape = as_vector_get(g_shapes, i);
+
+		if (shape->n_no_index == 0 && shape->n_filtered == 0) {
+			continue;
+		}
+
+		uint64_t objects = 0;
+
+		if (shape->n_no_index) {
+			as_error err;
+			as_error_init(&err);
+
+			if (asql_set_object_count(c, shape->ns,
+					shape->set[0] ? shape->set : NULL, &objects,
+					&err) != AEROSPIKE_OK) {
+				g_renderer->render_error(err.code, err.message, NULL);
+				free(rows);
+				return 1;
+			}
+		}
+
+		rows[n_rows].shape = shape;
+		rows[n_rows].saved = shape->n_no_index * objects
+				+ (uint64_t)shape->filtered_reads;
+		n_rows++;
+	}
+
+	qsort(rows, n_rows, sizeof(advice_row), row_cmp);
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), 8);
+	const char* names[] = { "ns", "set", "bin", "type", "indextype",
+			"no_index", "filtered", "est_records_saved" };
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		as_vector_append(&cols, &names[i]);
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	for (uint32_t i = 0; i < n_rows; i++) {
+		advice_shape* shape = rows[i].shape;
+
+		as_hashmap m;
+		as_hashmap_init(&m, 8);
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("ns"),
+				(as_val*)as_string_new_strdup(shape->ns));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("set"),
+				(as_val*)as_string_new_strdup(shape->set));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("bin"),
+				(as_val*)as_string_new_strdup(shape->bname));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("type"),
+				(as_val*)as_string_new_strdup(type_name(shape->type)));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("indextype"),
+				(as_val*)as_string_new_strdup(shape->itype));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("no_index"),
+				(as_val*)as_integer_new((int64_t)shape->n_no_index));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("filtered"),
+				(as_val*)as_integer_new((int64_t)shape->n_filtered));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("est_records_saved"),
+				(as_val*)as_integer_new((int64_t)rows[i].saved));
+
+		g_renderer->render((as_val*)&m, rview);
+		as_hashmap_destroy(&m);
+	}
+
+	g_renderer->render(NULL, rview);
+	g_renderer->render_ok("advice covers statements run by this aql process only", rview);
+	g_renderer->view_destroy(rview);
+
+	as_vector_destroy(&cols);
+	free(rows);
+	return 0;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+static advice_shape*
+shape_get(const char* ns, const char* set, const asql_where* where,
+		const char* itype)
+{
+	if (!g_shapes) {
+		g_shapes = as_vector_create(sizeof(advice_shape), 16);
+	}
+
+	const char* it = itype ? itype : "DEFAULT";
+	as_val_t type = where->beg.type;
+
+	for (uint32_t i = 0; i < g_shapes->size; i++) {
+		advice_shape* shape = as_vector_get(g_shapes, i);
+
+		if (shape->type == type && !strcmp(shape->ns, ns)
+				&& !strcmp(shape->set, set ? set : "")
+				&& !strcmp(shape->bname, where->ibname)
+				&& !strcasecmp(shape->itype, it)) {
+			return shape;
+		}
+	}
+
+	advice_shape shape;
+	bzero(&shape, sizeof(advice_shape));
+	snprintf(shape.ns, sizeof(shape.ns), "%s", ns);
+	snprintf(shape.set, sizeof(shape.set), "%s", set ? set : "");
+	snprintf(shape.bname, sizeof(shape.bname), "%s", where->ibname);
+	snprintf(shape.itype, sizeof(shape.itype), "%s", it);
+	shape.type = type;
+
+	as_vector_append(g_shapes, &shape);
+	return as_vector_get(g_shapes, g_shapes->size - 1);
+}
+
+static const char*
+type_name(as_val_t type)
+{
+	switch (type) {
+		case AS_INTEGER:
+			return "NUMERIC";
+		case AS_STRING:
+			return "STRING";
+		case AS_GEOJSON:
+			return "GEO2DSPHERE";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+static int
+row_cmp(const void* a, const void* b)
+{
+	uint64_t sa = ((const advice_row*)a)->saved;
+	uint64_t sb = ((const advice_row*)b)->saved;
+
+	return sa < sb ? 1 : (sa > sb ? -1 : 0);
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <aerospike/as_log_macros.h>
+
+#include <asql_arena.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+#define ARENA_ALIGN sizeof(uint64_t)
+
+// Pages are made usable this many bytes at a time, a multiple of any page
+// size.
+#define ARENA_COMMIT_STEP (64 * 1024)
+
+// Address space only, a statement's names and values are far smaller. Pages
+// are used as the statement reaches them.
+#define STMT_ARENA_RESERVE ((size_t)1024 * 1024 * 1024)
+
+
+//=========================================================
+// Globals.
+//
+
+// Statements run one at a time, RUN nests them, so marks are taken and
+// rewound in stack order. Nothing here is locked: the CLI runs one statement
+// at a time, --serve sessions take turns under the daemon's s_exec_lock
+// (asql_serve.c) and libaql calls hold its engine lock.
+static asql_arena s_stmt_arena = { .reserve = STMT_ARENA_RESERVE };
+static uint32_t s_stmt_depth = 0;
+static size_t s_stmt_last_peak = 0;
+static size_t s_stmt_max_peak = 0;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static bool arena_commit(asql_arena* a, size_t size);
+
+
+//=========================================================
+// Public API.
+//
+
+void
+asql_arena_init(asql_arena* a, size_t reserve)
+{
+	memset(a, 0, sizeof(asql_arena));
+	a->reserve = (reserve + ARENA_COMMIT_STEP - 1) & ~(size_t)(ARENA_COMMIT_STEP - 1);
+}
+
+void*
+asql_arena_alloc(asql_arena* a, size_t size)
+{
+	size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if (!a->base) {
+		void* base = mmap(NULL, a->reserve, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (base == MAP_FAILED) {
+			return NULL;
+		}
+
+		a->base = base;
+	}
+
+	if (a->reserve - a->used < size) {
+		return NULL;
+	}
+
+	if (a->used + size > a->committed && !arena_commit(a, a->used + size)) {
+		return NULL;
+	}
+
+	void* p = a->base + a->used;
+
+	a->used += size;
+
+	if (a->used > a->peak) {
+		a->peak = a->used;
+	}
+
+	return p;
+}
+
+char*
+asql_arena_strndup(asql_arena* a, const char* s, size_t len)
+{
+	char* p = asql_arena_alloc(a, len + 1);
+
+	if (p) {
+		memcpy(p, s, len);
+		p[len] = 0;
+	}
+
+	return p;
+}
+
+asql_arena_mark
+asql_arena_get_mark(const asql_arena* a)
+{
+	asql_arena_mark mark = { .used = a->used };
+	return mark;
+}
+
+// Pages stay usable, so a steady state never makes a system call.
+void
+asql_arena_rewind(asql_arena* a, asql_arena_mark mark)
+{
+	a->used = mark.used;
+}
+
+bool
+asql_arena_owns(const asql_arena* a, const void* p)
+{
+	return (const uint8_t*)p >= a->base
+			&& (const uint8_t*)p < a->base + a->used;
+}
+
+void
+asql_arena_destroy(asql_arena* a)
+{
+	if (a->base) {
+		munmap(a->base, a->reserve);
+	}
+
+	asql_arena_init(a, a->reserve);
+}
+
+asql_arena_mark
+asql_stmt_begin()
+{
+	if (s_stmt_depth++ == 0) {
+		s_stmt_arena.peak = s_stmt_arena.used;
+	}
+
+	return asql_arena_get_mark(&s_stmt_arena);
+}
+
+void
+asql_stmt_end(asql_arena_mark mark)
+{
+	asql_arena_rewind(&s_stmt_arena, mark);
+
+	if (--s_stmt_depth == 0) {
+		s_stmt_last_peak = s_stmt_arena.peak;
+
+		if (s_stmt_last_peak > s_stmt_max_peak) {
+			s_stmt_max_peak = s_stmt_last_peak;
+		}
+
+		as_log_debug("Statement arena peak %zu bytes", s_stmt_last_peak);
+	}
+}
+
+void*
+asql_stmt_malloc(size_t size)
+{
+	void* p = s_stmt_depth == 0
+			? NULL : asql_arena_alloc(&s_stmt_arena, size);
+
+	return p ? p : malloc(size);
+}
+
+char*
+asql_stmt_strdup(const char* s)
+{
+	char* p = s_stmt_depth == 0
+			? NULL : asql_arena_strndup(&s_stmt_arena, s, strlen(s));
+
+	return p ? p : strdup(s);
+}
+
+// Arena memory goes with the statement, only heap pointers are freed.
+void
+asql_stmt_free(void* p)
+{
+	if (p && !asql_arena_owns(&s_stmt_arena, p)) {
+		free(p);
+	}
+}
+
+void
+asql_stmt_arena_stats(size_t* last_peak, size_t* max_peak, size_t* committed)
+{
+	*last_peak = s_stmt_last_peak;
+	*max_peak = s_stmt_max_peak;
+	*committed = s_stmt_arena.committed;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+static bool
+arena_commit(asql_arena* a, size_t size)
+{
+	size_t committed = (size + ARENA_COMMIT_STEP - 1)
+			& ~(size_t)(ARENA_COMMIT_STEP - 1);
+
+	if (committed > a->reserve) {
+		committed = a->reserve;
+	}
+
+	if (mprotect(a->base + a->committed, committed - a->committed,
+			PROT_READ | PROT_WRITE) != 0) {
+		return false;
+	}
+
+	a->committed = committed;
+	return true;
+}
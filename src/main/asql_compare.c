@@ -0,0 +1,547 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_config.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_partition.h>
+#include <aerospike/as_partition_filter.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_scan.h>
+#include <aerospike/as_string.h>
+
+#include <citrusleaf/alloc.h>
+
+#include <renderer.h>
+#include <asql.h>
+#include <asql_compare.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+#define COMPARE_N_PARTITIONS 4096
+
+// Partitions drilled into down to the record, beyond that only the partition
+// count is reported.
+#define COMPARE_DRILL_MAX 256
+
+// Order independent summary of a partition's digests and generations.
+typedef struct {
+	atomic_uint_fast64_t count;
+	atomic_uint_fast64_t hash_xor;
+	atomic_uint_fast64_t hash_sum;
+} compare_partition;
+
+typedef struct {
+	uint8_t digest[AS_DIGEST_VALUE_SIZE];
+	uint16_t gen;
+} compare_rec;
+
+// One cluster's side of the comparison, scanned on its own thread.
+typedef struct {
+	aerospike* as;
+	as_policy_scan policy;
+	as_scan scan;
+	pthread_t thread;
+	as_error err;
+
+	compare_partition* parts;
+
+	// Drill down, the records of one partition.
+	bool drill;
+	uint32_t pid;
+	pthread_mutex_t lock;
+	as_vector recs; // compare_rec
+} compare_side;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static as_status compare_connect(asql_config* c, const char* host,
+		aerospike* as, as_error* err);
+static void compare_tls_copy(as_config_tls* to, const as_config_tls* from);
+static char* compare_strdup(const char* s);
+static void compare_side_init(asql_config* c, compare_side* side,
+		aerospike* as, scan_config* s);
+static void compare_side_destroy(compare_side* side);
+static bool compare_run(compare_side* local, compare_side* remote,
+		as_error* err);
+static void* compare_scan_run(void* udata);
+static bool compare_summary_cb(const as_val* val, void* udata);
+static bool compare_drill_cb(const as_val* val, void* udata);
+static uint64_t compare_drill(compare_side* local, compare_side* remote,
+		uint32_t pid, void* rview, as_error* err);
+static int compare_rec_cmp(const void* a, const void* b);
+static void compare_render(uint32_t pid, const compare_rec* lrec,
+		const compare_rec* rrec, void* rview);
+
+
+//=========================================================
+// Public API.
+//
+
+// COMPARE <ns>[.<set>] WITH HOST '<host>': scan both clusters for metadata
+// only, summarize each partition, and list the records of the partitions
+// whose summaries differ.
+int
+asql_compare(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	aerospike other;
+
+	if (compare_connect(c, s->host, &other, &err) != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	compare_side local;
+	compare_side remote;
+	compare_side_init(c, &local, g_aerospike, s);
+	compare_side_init(c, &remote, &other, s);
+
+	int rv = 1;
+
+	if (!compare_run(&local, &remote, &err)) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		goto CLEANUP;
+	}
+
+	uint64_t n_local = 0;
+	uint64_t n_remote = 0;
+	uint32_t n_diff = 0;
+	uint64_t n_rec_diff = 0;
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), 5);
+	const char* names[] = { "partition", "digest", "local_gen", "remote_gen",
+			"status" };
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		as_vector_append(&cols, &names[i]);
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	for (uint32_t pid = 0; pid < COMPARE_N_PARTITIONS && !g_interrupted;
+			pid++) {
+		compare_partition* lp = &local.parts[pid];
+		compare_partition* rp = &remote.parts[pid];
+
+		n_local += lp->count;
+		n_remote += rp->count;
+
+		if (lp->count == rp->count && lp->hash_xor == rp->hash_xor
+				&& lp->hash_sum == rp->hash_sum) {
+			continue;
+		}
+
+		if (n_diff++ < COMPARE_DRILL_MAX) {
+			n_rec_diff += compare_drill(&local, &remote, pid, rview, &err);
+
+			if (err.code != AEROSPIKE_OK) {
+				break;
+			}
+		}
+	}
+
+	g_renderer->render(NULL, rview);
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, rview);
+	}
+	else {
+		char msg[512];
+		int len = snprintf(msg, sizeof(msg),
+				"%u of %u partitions differ, %" PRIu64 " records local, %" PRIu64 " records on %s",
+				n_diff, COMPARE_N_PARTITIONS, n_local, n_remote, s->host);
+
+		if (n_diff > COMPARE_DRILL_MAX) {
+			snprintf(msg + len, sizeof(msg) - len,
+					", %" PRIu64 " differing records listed for the first %u",
+					n_rec_diff, COMPARE_DRILL_MAX);
+		}
+		else if (n_diff > 0) {
+			snprintf(msg + len, sizeof(msg) - len,
+					", %" PRIu64 " differing records", n_rec_diff);
+		}
+
+		g_renderer->render_ok(msg, rview);
+		rv = 0;
+	}
+
+	g_renderer->view_destroy(rview);
+	as_vector_destroy(&cols);
+
+CLEANUP:
+	compare_side_destroy(&local);
+	compare_side_destroy(&remote);
+
+	as_error_reset(&err);
+	aerospike_close(&other, &err);
+	aerospike_destroy(&other);
+	return rv;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+// The other cluster is reached with this session's credentials and TLS
+// settings.
+static as_status
+compare_connect(asql_config* c, const char* host, aerospike* as,
+		as_error* err)
+{
+	as_config config;
+	as_config_init(&config);
+
+	if (!as_config_add_hosts(&config, host, 3000)) {
+		as_error_update(err, AEROSPIKE_ERR_PARAM, "Invalid host(s) %s", host);
+		goto CONFIG_ERROR;
+	}
+
+	if (c->base.user && !as_config_set_user(&config, c->base.user,
+			c->base.password)) {
+		as_error_update(err, AEROSPIKE_ERR_PARAM,
+				"Invalid password for user name `%s`", c->base.user);
+		goto CONFIG_ERROR;
+	}
+
+	// Hosts given without a TLS name use the session's, as at connect.
+	if (c->base.tls_name) {
+		for (uint32_t i = 0; i < config.hosts->size; i++) {
+			as_host* h = as_vector_get(config.hosts, i);
+
+			if (!h->tls_name) {
+				h->tls_name = compare_strdup(c->base.tls_name);
+			}
+		}
+	}
+
+	// The connected client's copy, its key file password is already read.
+	compare_tls_copy(&config.tls, &g_aerospike->config.tls);
+
+	config.conn_timeout_ms = c->base.timeout_ms;
+	config.fail_if_not_connected = true;
+	config.use_services_alternate = c->base.use_services_alternate;
+	config.auth_mode = g_aerospike->config.auth_mode;
+
+	// The client owns config from here, and destroys it with the cluster.
+	aerospike_init(as, &config);
+
+	if (aerospike_connect(as, err) != AEROSPIKE_OK) {
+		aerospike_destroy(as);
+	}
+	return err->code;
+
+CONFIG_ERROR:
+	as_config_destroy(&config);
+	return err->code;
+}
+
+// Both configs free their TLS strings, copy each.
+static void
+compare_tls_copy(as_config_tls* to, const as_config_tls* from)
+{
+	to->enable = from->enable;
+	to->cafile = compare_strdup(from->cafile);
+	to->capath = compare_strdup(from->capath);
+	to->protocols = compare_strdup(from->protocols);
+	to->cipher_suite = compare_strdup(from->cipher_suite);
+	to->crl_check = from->crl_check;
+	to->crl_check_all = from->crl_check_all;
+	to->cert_blacklist = compare_strdup(from->cert_blacklist);
+	to->log_session_info = from->log_session_info;
+	to->for_login_only = from->for_login_only;
+	to->keyfile = compare_strdup(from->keyfile);
+	to->keyfile_pw = compare_strdup(from->keyfile_pw);
+	to->certfile = compare_strdup(from->certfile);
+}
+
+static char*
+compare_strdup(const char* s)
+{
+	return s ? cf_strdup(s) : NULL;
+}
+
+static void
+compare_side_init(asql_config* c, compare_side* side, aerospike* as,
+		scan_config* s)
+{
+	bzero(side, sizeof(compare_side));
+	side->as = as;
+	side->parts = calloc(COMPARE_N_PARTITIONS, sizeof(compare_partition));
+	as_error_init(&side->err);
+
+	// Both sides scan with this session's scan defaults.
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &side->policy);
+	asql_policy_base_init(c, &side->policy.base);
+	side->policy.records_per_second = (uint32_t)c->scan_records_per_second;
+
+	// Digest and generation come with the record header, no bin is read.
+	as_scan_init(&side->scan, s->ns, s->set);
+	side->scan.no_bins = true;
+
+	pthread_mutex_init(&side->lock, NULL);
+	as_vector_init(&side->recs, sizeof(compare_rec), 64);
+}
+
+static void
+compare_side_destroy(compare_side* side)
+{
+	as_scan_destroy(&side->scan);
+	as_vector_destroy(&side->recs);
+	pthread_mutex_destroy(&side->lock);
+	free(side->parts);
+}
+
+// Scan both sides at once, each on a thread of its own.
+static bool
+compare_run(compare_side* local, compare_side* remote, as_error* err)
+{
+	as_error_reset(&local->err);
+	as_error_reset(&remote->err);
+
+	if (pthread_create(&remote->thread, NULL, compare_scan_run, remote)
+			!= 0) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Unable to start scan thread");
+		return false;
+	}
+
+	compare_scan_run(local);
+	pthread_join(remote->thread, NULL);
+
+	if (local->err.code != AEROSPIKE_OK) {
+		as_error_copy(err, &local->err);
+		return false;
+	}
+
+	if (remote->err.code != AEROSPIKE_OK) {
+		as_error_copy(err, &remote->err);
+		return false;
+	}
+
+	if (g_interrupted) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT_ABORT, "Interrupted");
+		return false;
+	}
+	return true;
+}
+
+static void*
+compare_scan_run(void* udata)
+{
+	compare_side* side = (compare_side*)udata;
+
+	if (side->drill) {
+		as_partition_filter pf;
+		as_partition_filter_set_id(&pf, side->pid);
+		aerospike_scan_partitions(side->as, &side->err, &side->policy,
+				&side->scan, &pf, compare_drill_cb, side);
+	}
+	else {
+		aerospike_scan_foreach(side->as, &side->err, &side->policy,
+				&side->scan, compare_summary_cb, side);
+	}
+	return NULL;
+}
+
+// Called from the client's scan threads, one per node.
+static bool
+compare_summary_cb(const as_val* val, void* udata)
+{
+	if (!val) {
+		return true;
+	}
+
+	compare_side* side = (compare_side*)udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (!rec) {
+		return true;
+	}
+
+	const uint8_t* digest = rec->key.digest.value;
+	uint32_t pid = as_partition_getid(digest, COMPARE_N_PARTITIONS);
+
+	// The partition id comes from the digest's first bytes, hash the rest.
+	uint64_t h;
+	memcpy(&h, digest + 8, sizeof(h));
+	h ^= (uint64_t)rec->gen * 0x9E3779B97F4A7C15ULL;
+
+	compare_partition* p = &side->parts[pid];
+	atomic_fetch_add(&p->count, 1);
+	atomic_fetch_xor(&p->hash_xor, h);
+	atomic_fetch_add(&p->hash_sum, h);
+
+	return !g_interrupted;
+}
+
+static bool
+compare_drill_cb(const as_val* val, void* udata)
+{
+	if (!val) {
+		return true;
+	}
+
+	compare_side* side = (compare_side*)udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (!rec) {
+		return true;
+	}
+
+	compare_rec cr;
+	memcpy(cr.digest, rec->key.digest.value, AS_DIGEST_VALUE_SIZE);
+	cr.gen = rec->gen;
+
+	pthread_mutex_lock(&side->lock);
+	as_vector_append(&side->recs, &cr);
+	pthread_mutex_unlock(&side->lock);
+
+	return !g_interrupted;
+}
+
+// Scan one partition on both sides and render the records that differ.
+static uint64_t
+compare_drill(compare_side* local, compare_side* remote, uint32_t pid,
+		void* rview, as_error* err)
+{
+	local->drill = remote->drill = true;
+	local->pid = remote->pid = pid;
+	as_vector_clear(&local->recs);
+	as_vector_clear(&remote->recs);
+
+	if (!compare_run(local, remote, err)) {
+		return 0;
+	}
+
+	qsort(local->recs.list, local->recs.size, sizeof(compare_rec),
+			compare_rec_cmp);
+	qsort(remote->recs.list, remote->recs.size, sizeof(compare_rec),
+			compare_rec_cmp);
+
+	uint64_t n_diff = 0;
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	while (i < local->recs.size || j < remote->recs.size) {
+		compare_rec* l = i < local->recs.size ?
+				as_vector_get(&local->recs, i) : NULL;
+		compare_rec* r = j < remote->recs.size ?
+				as_vector_get(&remote->recs, j) : NULL;
+		int cmp = !l ? 1 : !r ? -1 : compare_rec_cmp(l, r);
+
+		if (cmp < 0) {
+			compare_render(pid, l, NULL, rview);
+			i++;
+		}
+		else if (cmp > 0) {
+			compare_render(pid, NULL, r, rview);
+			j++;
+		}
+		else {
+			i++;
+			j++;
+
+			if (l->gen == r->gen) {
+				continue;
+			}
+			compare_render(pid, l, r, rview);
+		}
+		n_diff++;
+	}
+	return n_diff;
+}
+
+static int
+compare_rec_cmp(const void* a, const void* b)
+{
+	return memcmp(((const compare_rec*)a)->digest,
+			((const compare_rec*)b)->digest, AS_DIGEST_VALUE_SIZE);
+}
+
+static void
+compare_render(uint32_t pid, const compare_rec* lrec, const compare_rec* rrec,
+		void* rview)
+{
+	const compare_rec* cr = lrec ? lrec : rrec;
+	char hex[AS_DIGEST_VALUE_SIZE * 2 + 1];
+
+	for (uint32_t i = 0; i < AS_DIGEST_VALUE_SIZE; i++) {
+		sprintf(hex + i * 2, "%02X", cr->digest[i]);
+	}
+
+	as_hashmap m;
+	as_hashmap_init(&m, 8);
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("partition"),
+			(as_val*)as_integer_new(pid));
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("digest"),
+			(as_val*)as_string_new_strdup(hex));
+
+	if (lrec) {
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("local_gen"),
+				(as_val*)as_integer_new(lrec->gen));
+	}
+
+	if (rrec) {
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("remote_gen"),
+				(as_val*)as_integer_new(rrec->gen));
+	}
+
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("status"),
+			(as_val*)as_string_new_strdup(!rrec ? "missing on remote" :
+					!lrec ? "missing on local" : "generation differs"));
+
+	g_renderer->render((as_val*)&m, rview);
+	as_hashmap_destroy(&m);
+}
@@ -21,6 +21,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <getopt.h>
@@ -28,6 +29,7 @@
 #include <dirent.h>
 #include <sys/stat.h>
 
+#include <aerospike/as_log_macros.h>
 #include <aerospike/mod_lua.h>
 #include <aerospike/mod_lua_config.h>
 
@@ -49,6 +51,29 @@
 #define ASQL_CONFIG_FILE ".aerospike/astools.conf"
 #define ERR_BUF_SIZE 1024
 
+// Settings bundled by SET PROFILE.
+typedef struct {
+	const char* name;
+	int max_retries;
+	int sleep_between_retries;
+	bool compress;
+	bool concurrent;
+	bool short_query;
+	int record_exists;
+} policy_profile;
+
+// Interactive fails fast on short queries and refuses to INSERT over an
+// existing record, a mistyped key is reported instead of overwriting. Bulk
+// rides out node hiccups, trades client CPU for network with compression and
+// upserts, so a load retried after a timeout rewrites what already landed.
+static const policy_profile s_profiles[] = {
+	[PROFILE_CUSTOM] = { "CUSTOM" },
+	[PROFILE_INTERACTIVE] = { "INTERACTIVE", 1, 0, false, false, true,
+			AS_POLICY_EXISTS_CREATE },
+	[PROFILE_BULK] = { "BULK", 5, 200, true, true, false,
+			AS_POLICY_EXISTS_IGNORE },
+};
+
 //=========================================================
 // Inline and Macros.
 //
@@ -56,6 +81,11 @@
 #define ASQL_SET_OPTION_IS_VAR(entry, var) ((entry).offset == offsetof(struct asql_config, var))
 #define PTR(c, offset) (((char* )(c)) + (offset))
 
+#define ASQL_SET_OPTION_BOOL(var, name, help, val) {ASQL_SET_OPTION_TYPE_BOOL, offsetof(struct asql_config, var), name, help, .default_value=val}
+#define ASQL_SET_OPTION_INT(var, name, help, val) {ASQL_SET_OPTION_TYPE_INT, offsetof(struct asql_config, var), name, help, .default_value=val}
+#define ASQL_SET_OPTION_ENUM(var, name, map, val) {ASQL_SET_OPTION_TYPE_ENUM, offsetof(struct asql_config, var), name, .enum_map=map, .default_value=val}
+#define ASQL_SET_OPTION_STRING(var, name, help, val, fn) {ASQL_SET_OPTION_TYPE_STRING, offsetof(struct asql_config, var), name, help, .default_string=strdup(val), .validate=fn}
+
 #ifndef MAX
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #endif
@@ -67,6 +97,30 @@
 char* DEFAULTPASSWORD = "SomeRandomDefaultPassword";
 asql_set_option* g_asql_set_option_table;
 
+static map_enum_string output_t_map[] = {
+	{TABLE, "TABLE"},
+	{JSON, "JSON"},
+	{MUTE, "MUTE"},
+	{RAW, "RAW"},
+	{0, NULL}
+};
+
+static map_enum_string profile_map[] = {
+	{PROFILE_CUSTOM, "CUSTOM"},
+	{PROFILE_INTERACTIVE, "INTERACTIVE"},
+	{PROFILE_BULK, "BULK"},
+	{0, NULL}
+};
+
+static map_enum_string record_exists_map[] = {
+	{AS_POLICY_EXISTS_IGNORE, "IGNORE"},
+	{AS_POLICY_EXISTS_CREATE, "CREATE"},
+	{AS_POLICY_EXISTS_UPDATE, "UPDATE"},
+	{AS_POLICY_EXISTS_REPLACE, "REPLACE"},
+	{AS_POLICY_EXISTS_CREATE_OR_REPLACE, "CREATE_OR_REPLACE"},
+	{0, NULL}
+};
+
 static struct option options[] =
 {
 	// Non Config file options
@@ -75,6 +129,8 @@ static struct option options[] =
 	{"help", no_argument, 0, 'E'},
 	{"command", required_argument, 0, 'c'},
 	{"file", required_argument, 0, 'f'},
+	{"serve", required_argument, 0, 1017},
+	{"socket", required_argument, 0, 1018},
 
 	{"instance", required_argument, 0, 'I'},
 	{"config-file", required_argument, 0, 'C'},
@@ -87,6 +143,12 @@ static struct option options[] =
 	{"host", required_argument, 0, 'h'},
 	{"tls-name", required_argument, 0, 1014},
 	{"services-alternate", no_argument, 0, 'a'},
+	{"use-shm", no_argument, 0, 1015},
+	{"shm-key", required_argument, 0, 1016},
+	{"rack-id", required_argument, 0, 1019},
+	{"replica", required_argument, 0, 1020},
+	{"read-mode-ap", required_argument, 0, 1021},
+	{"read-mode-sc", required_argument, 0, 1022},
 	{"port", required_argument, 0, 'p'},
 	{"user", required_argument, 0, 'U'},
 	{"password", optional_argument, 0, 'P'},
@@ -134,6 +196,8 @@ static struct option options[] =
 extern void strncpy_and_strip_quotes(char* to, const char* from, size_t size);
 
 static bool print_option(uint16_t i);
+static void profile_load(asql_config* c);
+static bool is_profile_option(const asql_set_option* option);
 static bool set(uint16_t i, char* value);
 static char* safe_strdup(char* in, char* val);
 
@@ -178,6 +242,24 @@ print_config_file_option()
 	fprintf(stdout, "                      cluster's nodes publish IP addresses through access-address \n");
 	fprintf(stdout, "                      which are not accessible over WAN and alternate IP addresses \n");
 	fprintf(stdout, "                      accessible over WAN through alternate-access-address. Default: false.\n");
+	fprintf(stdout, " --use-shm            Share cluster tending between aql invocations on this\n");
+	fprintf(stdout, "                      host through a shared memory segment. The first process\n");
+	fprintf(stdout, "                      tends the cluster, later processes attach to the existing\n");
+	fprintf(stdout, "                      node and partition maps instead of discovering the cluster\n");
+	fprintf(stdout, "                      again. Default: false.\n");
+	fprintf(stdout, " --shm-key=KEY        Shared memory segment key used with --use-shm. Processes\n");
+	fprintf(stdout, "                      talking to different clusters must use different keys.\n");
+	fprintf(stdout, "                      Default: 0xA9000000\n");
+	fprintf(stdout, " --rack-id=ID         Rack this client runs in. Enables rack awareness and\n");
+	fprintf(stdout, "                      defaults --replica to prefer-rack, so reads stay in the\n");
+	fprintf(stdout, "                      local rack or availability zone. Default: none\n");
+	fprintf(stdout, " --replica=REPLICA    Replica reads go to. (master | any | sequence | prefer-rack)\n");
+	fprintf(stdout, "                      Default: sequence\n");
+	fprintf(stdout, " --read-mode-ap=MODE  Read consistency for AP namespaces. (one | all)\n");
+	fprintf(stdout, "                      Default: one\n");
+	fprintf(stdout, " --read-mode-sc=MODE  Read consistency for strong consistency namespaces.\n");
+	fprintf(stdout, "                      (session | linearize | allow-replica | allow-unavailable)\n");
+	fprintf(stdout, "                      Default: session\n");
 	fprintf(stdout, " -p, --port=PORT Server default port. Default: 3000\n");
 	fprintf(stdout, " -U, --user=USER User name used to authenticate with cluster. Default: none\n");
 	fprintf(stdout, " -P, --password\n");
@@ -255,6 +337,16 @@ print_config_file_option()
 	fprintf(stdout, "                      Default: same as C client\n");
 	fprintf(stdout, "                      Default for scan/query: 30000ms\n");
 	fprintf(stdout, "                      Default for other commands: 0 (no socket idle time limit)\n");
+	fprintf(stdout, " min-conns-per-node=count\n");
+	fprintf(stdout, "                      Connections opened to each node at connect, so the\n");
+	fprintf(stdout, "                      first commands do not pay for connection setup.\n");
+	fprintf(stdout, "                      Config file and SET only. Default: 0\n");
+	fprintf(stdout, " max-conns-per-node=count\n");
+	fprintf(stdout, "                      Connection limit per node. Config file and SET only.\n");
+	fprintf(stdout, "                      Default: 100\n");
+	fprintf(stdout, " conn-pools-per-node=count\n");
+	fprintf(stdout, "                      Connection pools per node. Config file and SET only.\n");
+	fprintf(stdout, "                      Default: 1\n");
 	fprintf(stdout, " -u, --udfuser=path   Path to User managed UDF modules.\n");
 	fprintf(stdout, "                      Default: /opt/aerospike/usr/udf/lua\n");
 }
@@ -273,6 +365,13 @@ print_config_help(int argc, char* argv[])
 	fprintf(stdout, "                      documentation.\n");
 	fprintf(stdout, " -c, --command=cmd    Execute the specified command.\n");
 	fprintf(stdout, " -f, --file=path      Execute the commands in the specified file.\n");
+	fprintf(stdout, " --serve=path         Stay connected to the cluster and execute statements\n");
+	fprintf(stdout, "                      received on the unix domain socket at path. Each\n");
+	fprintf(stdout, "                      connection is a session with its own SET options.\n");
+	fprintf(stdout, "                      Sessions' statements run one at a time, so TAIL is\n");
+	fprintf(stdout, "                      refused and TRUNCATE does not wait.\n");
+	fprintf(stdout, " --socket=path        Send the -c command, -f file or stdin to an aql started\n");
+	fprintf(stdout, "                      with --serve instead of connecting to the cluster.\n");
 
 
 	// Base Config
@@ -430,6 +529,38 @@ config_init(asql_config* conf, int argc, char* argv[], char** cmd, char** fname,
 				base->use_services_alternate = true;
 				break;
 
+			case 1015:
+				base->use_shm = true;
+				break;
+
+			case 1016:
+				base->shm_key = (int)strtoul(optarg, NULL, 0);
+				break;
+
+			case 1019:
+				base->rack_id = atoi(optarg);
+				break;
+
+			case 1020:
+				base->replica = safe_strdup(base->replica, optarg);
+				break;
+
+			case 1021:
+				base->read_mode_ap = safe_strdup(base->read_mode_ap, optarg);
+				break;
+
+			case 1022:
+				base->read_mode_sc = safe_strdup(base->read_mode_sc, optarg);
+				break;
+
+			case 1017:
+				base->serve_path = safe_strdup(base->serve_path, optarg);
+				break;
+
+			case 1018:
+				base->socket_path = safe_strdup(base->socket_path, optarg);
+				break;
+
 			case 'p':
 				base->port = atoi(optarg);
 				break;
@@ -575,7 +706,7 @@ config_init(asql_config* conf, int argc, char* argv[], char** cmd, char** fname,
 	}
 
 	// Print Connection statistics only for interactive case.
-	if (! *cmd && ! *fname) {
+	if (! *cmd && ! *fname && ! base->socket_path) {
 		if (instance) {
 			fprintf(stdout, "Instance:     %s\n", instance);
 		}
@@ -583,6 +714,11 @@ config_init(asql_config* conf, int argc, char* argv[], char** cmd, char** fname,
 		fprintf(stdout, "User:         %s\n", conf->base.user
 				? conf->base.user : "None");
 
+		if (conf->base.use_shm) {
+			fprintf(stdout, "Shared Mem:   0x%X\n", conf->base.shm_key
+					? (uint32_t)conf->base.shm_key : 0xA9000000);
+		}
+
 		if (read_conf_files) {
 			char user_config_fname[128];
 			snprintf(user_config_fname, 127, "%s/%s", getenv("HOME"), ASQL_CONFIG_FILE);
@@ -622,6 +758,26 @@ config_free(asql_config* conf)
 	if (base->lua_userpath) {
 		free(base->lua_userpath);
 	}
+
+	if (base->replica) {
+		free(base->replica);
+	}
+
+	if (base->read_mode_ap) {
+		free(base->read_mode_ap);
+	}
+
+	if (base->read_mode_sc) {
+		free(base->read_mode_sc);
+	}
+
+	if (base->serve_path) {
+		free(base->serve_path);
+	}
+
+	if (base->socket_path) {
+		free(base->socket_path);
+	}
 }
 
 
@@ -689,6 +845,52 @@ print_option_help()
 	}
 }
 
+// Heap copy of the SET option table, released by option_free().
+asql_set_option*
+option_table_new()
+{
+	asql_set_option table[] = {
+		// General set options, also available at command line.
+		ASQL_SET_OPTION_BOOL(base.echo, "ECHO", NULL, false),
+		ASQL_SET_OPTION_BOOL(base.verbose, "VERBOSE", NULL, false),
+		// C client thread pool size (negative value means use the default.)
+		ASQL_SET_OPTION_ENUM(base.outputmode, "OUTPUT", output_t_map, TABLE),
+		ASQL_SET_OPTION_BOOL(base.outputtypes, "OUTPUT_TYPES",	NULL, true),
+		ASQL_SET_OPTION_INT(base.timeout_ms, "TIMEOUT", "time in ms", 1000),
+		ASQL_SET_OPTION_INT(base.socket_timeout_ms, "SOCKET_TIMEOUT", "time in ms", -1),
+		// Connection pools, applied when aql connects (-1 means use the default.)
+		ASQL_SET_OPTION_INT(base.min_conns_per_node, "MIN_CONNS_PER_NODE", "connections opened per node at connect", -1),
+		ASQL_SET_OPTION_INT(base.max_conns_per_node, "MAX_CONNS_PER_NODE", "connection limit per node", -1),
+		ASQL_SET_OPTION_INT(base.conn_pools_per_node, "CONN_POOLS_PER_NODE", "pools per node, to reduce lock contention", -1),
+		ASQL_SET_OPTION_STRING(base.lua_userpath, "LUA_USERPATH", "<path>", "/opt/aerospike/usr/udf/lua", NULL),
+
+		// Operation specific set options, not available at command line.
+		ASQL_SET_OPTION_INT(record_ttl_sec, "RECORD_TTL", "time in sec", 0),
+		ASQL_SET_OPTION_BOOL(record_print_metadata, "RECORD_PRINT_METADATA", "prints record metadata", false),
+		ASQL_SET_OPTION_BOOL(key_send, "KEY_SEND", NULL, true),
+		ASQL_SET_OPTION_BOOL(durable_delete, "DURABLE_DELETE", NULL, false),
+		ASQL_SET_OPTION_INT(scan_records_per_second, "SCAN_RECORDS_PER_SECOND", "Limit returned records per second (rps) rate for each server", 0),
+		ASQL_SET_OPTION_BOOL(no_bins, "NO_BINS", "No bins as part of scan and query result", false),
+		ASQL_SET_OPTION_INT(reduce_threads, "REDUCE_THREADS", "Reduce aggregations on the client in this many threads, 0 for one", 0),
+		ASQL_SET_OPTION_INT(index_wait_ms, "INDEX_WAIT_TIMEOUT", "time in ms to wait for an index build", 300000),
+
+		// Command policies, PROFILE sets the ones below it.
+		ASQL_SET_OPTION_ENUM(profile, "PROFILE", profile_map, PROFILE_CUSTOM),
+		ASQL_SET_OPTION_INT(max_retries, "MAX_RETRIES", "retries per command, -1 for the default", -1),
+		ASQL_SET_OPTION_INT(sleep_between_retries, "SLEEP_BETWEEN_RETRIES", "time in ms, -1 for the default", -1),
+		ASQL_SET_OPTION_BOOL(compress, "COMPRESS", "compress commands and replies", false),
+		ASQL_SET_OPTION_BOOL(concurrent, "CONCURRENT", "send scans and batches to all nodes in parallel", false),
+		ASQL_SET_OPTION_BOOL(short_query, "SHORT_QUERY", "hint the server that queries return few records", false),
+		ASQL_SET_OPTION_ENUM(record_exists, "RECORD_EXISTS", record_exists_map, AS_POLICY_EXISTS_IGNORE),
+
+		{.offset=-1}
+	};
+
+	asql_set_option* t = malloc(sizeof(table));
+	memcpy(t, table, sizeof(table));
+	return t;
+}
+
 void
 option_init(asql_config* c, struct asql_set_option_s* table)
 {
@@ -731,6 +933,9 @@ option_free(struct asql_set_option_s* table)
 				break;
 		}
 	}
+
+	free(table);
+	g_asql_set_option_table = NULL;
 }
 
 
@@ -760,7 +965,9 @@ option_set(asql_config* c, char* name, char* value)
 				? AS_LOG_LEVEL_TRACE
 				: AS_LOG_LEVEL_INFO);
 	}
-	else if (ASQL_SET_OPTION_IS_VAR(table[i], base.outputmode)) {
+	// Embedded sessions always render to their callbacks.
+	else if (ASQL_SET_OPTION_IS_VAR(table[i], base.outputmode)
+			&& !c->base.embedded) {
 		if (c->base.outputmode == JSON) {
 			g_renderer = &json_renderer;
 		}
@@ -774,6 +981,26 @@ option_set(asql_config* c, char* name, char* value)
 			g_renderer = &no_renderer;
 		}
 	}
+	else if (ASQL_SET_OPTION_IS_VAR(table[i], base.min_conns_per_node)
+			|| ASQL_SET_OPTION_IS_VAR(table[i], base.max_conns_per_node)
+			|| ASQL_SET_OPTION_IS_VAR(table[i], base.conn_pools_per_node)) {
+		// Pools are sized when nodes are added.
+		if (g_aerospike->cluster) {
+			as_log_info("Connection pool sizes take effect on the next connect");
+		}
+	}
+	else if (ASQL_SET_OPTION_IS_VAR(table[i], profile)) {
+		profile_load(c);
+
+		for (uint16_t j = 0; table[j].offset >= 0; j++) {
+			if (is_profile_option(&table[j])) {
+				print_option(j);
+			}
+		}
+	}
+	else if (is_profile_option(&table[i])) {
+		c->profile = PROFILE_CUSTOM;
+	}
 	else if (ASQL_SET_OPTION_IS_VAR(table[i], base.lua_userpath)) {
 
 		as_config_lua lua;
@@ -788,6 +1015,20 @@ option_set(asql_config* c, char* name, char* value)
 	return true;
 }
 
+// Loads a profile by name into c without touching the session, for hints.
+bool
+option_profile_apply(asql_config* c, const char* name)
+{
+	for (uint32_t i = 0; i < sizeof(s_profiles) / sizeof(s_profiles[0]); i++) {
+		if (! strcasecmp(name, s_profiles[i].name)) {
+			c->profile = (policy_profile_t)i;
+			profile_load(c);
+			return true;
+		}
+	}
+	return false;
+}
+
 bool
 option_reset(asql_config* c, char* name)
 {
@@ -860,36 +1101,76 @@ option_get(asql_config* c, char* name)
 // Local API.
 //
 
+// Embedded (libaql) sessions get the line as an ok message, they have no
+// stdout to speak of.
 static bool
 print_option(uint16_t i)
 {
 	const asql_set_option* table = g_asql_set_option_table;
 	void* ptr = PTR(g_config, table[i].offset);
-	fprintf(stdout, "%s = ", table[i].name);
+	char line[1024];
+
 	switch (table[i].type) {
 		case ASQL_SET_OPTION_TYPE_BOOL: {
-			fprintf(stdout, "%s\n", *((bool*)ptr) ? "true": "false");
+			snprintf(line, sizeof(line), "%s = %s", table[i].name,
+					*((bool*)ptr) ? "true": "false");
 		}
 			break;
 		case ASQL_SET_OPTION_TYPE_INT: {
-			fprintf(stdout, "%d\n", *((int*)ptr));
+			snprintf(line, sizeof(line), "%s = %d", table[i].name, *((int*)ptr));
 		}
 			break;
 		case ASQL_SET_OPTION_TYPE_ENUM: {
-			fprintf(stdout, "%s\n", map_enum_to_string(table[i].enum_map,
-			                          *(int*)ptr));
+			snprintf(line, sizeof(line), "%s = %s", table[i].name,
+					map_enum_to_string(table[i].enum_map, *(int*)ptr));
 		}
 			break;
 		case ASQL_SET_OPTION_TYPE_STRING: {
-			fprintf(stdout, "%s\n", *((char**)ptr));
+			snprintf(line, sizeof(line), "%s = %s", table[i].name,
+					*((char**)ptr));
 		}
 			break;
 		default:
 			return false;
 	}
+
+	if (g_config->base.embedded) {
+		g_renderer->render_ok(line, NULL);
+	}
+	else {
+		fprintf(stdout, "%s\n", line);
+	}
 	return true;
 }
 
+static void
+profile_load(asql_config* c)
+{
+	if (c->profile == PROFILE_CUSTOM) {
+		return;
+	}
+
+	const policy_profile* p = &s_profiles[c->profile];
+
+	c->max_retries = p->max_retries;
+	c->sleep_between_retries = p->sleep_between_retries;
+	c->compress = p->compress;
+	c->concurrent = p->concurrent;
+	c->short_query = p->short_query;
+	c->record_exists = p->record_exists;
+}
+
+static bool
+is_profile_option(const asql_set_option* option)
+{
+	return ASQL_SET_OPTION_IS_VAR(*option, max_retries)
+			|| ASQL_SET_OPTION_IS_VAR(*option, sleep_between_retries)
+			|| ASQL_SET_OPTION_IS_VAR(*option, compress)
+			|| ASQL_SET_OPTION_IS_VAR(*option, concurrent)
+			|| ASQL_SET_OPTION_IS_VAR(*option, short_query)
+			|| ASQL_SET_OPTION_IS_VAR(*option, record_exists);
+}
+
 static bool
 set(uint16_t i, char* value)
 {
@@ -1059,6 +1340,15 @@ config_aql(toml_table_t* conftab, asql_config* c, const char* instance, char err
 		} else if (! strcasecmp("socket-timeout", name)) {
 			status = config_int(curtab, name, &c->base.socket_timeout_ms);
 
+		} else if (! strcasecmp("min-conns-per-node", name)) {
+			status = config_int(curtab, name, &c->base.min_conns_per_node);
+
+		} else if (! strcasecmp("max-conns-per-node", name)) {
+			status = config_int(curtab, name, &c->base.max_conns_per_node);
+
+		} else if (! strcasecmp("conn-pools-per-node", name)) {
+			status = config_int(curtab, name, &c->base.conn_pools_per_node);
+
 		} else if (! strcasecmp("udfuser", name)) {
 			status = config_str(curtab, name, &c->base.lua_userpath);
 
@@ -1106,6 +1396,24 @@ config_cluster(toml_table_t* conftab, asql_config* c, const char* instance, char
 		} else if (! strcasecmp("services-alternate",  name)) {
 			status = config_bool(curtab, name, &c->base.use_services_alternate);
 
+		} else if (! strcasecmp("use-shm", name)) {
+			status = config_bool(curtab, name, &c->base.use_shm);
+
+		} else if (! strcasecmp("shm-key", name)) {
+			status = config_int(curtab, name, &c->base.shm_key);
+
+		} else if (! strcasecmp("rack-id", name)) {
+			status = config_int(curtab, name, &c->base.rack_id);
+
+		} else if (! strcasecmp("replica", name)) {
+			status = config_str(curtab, name, &c->base.replica);
+
+		} else if (! strcasecmp("read-mode-ap", name)) {
+			status = config_str(curtab, name, &c->base.read_mode_ap);
+
+		} else if (! strcasecmp("read-mode-sc", name)) {
+			status = config_str(curtab, name, &c->base.read_mode_sc);
+
 		} else if (! strcasecmp("port", name)) {
 			status = config_int(curtab, name, &c->base.port);
 
@@ -1329,6 +1637,7 @@ config_default(asql_config* c, const char* instance)
 	}
 	c->base.port = 3000;
 	c->base.auth_mode = NULL;
+	c->base.rack_id = -1;
 
 	// Non dynamically configuration option
 	// -1 is to set it to default
@@ -92,10 +92,34 @@ asql_key_select_explain(asql_config* c, pk_config* p, as_key* key,
 	as_node *prole_1 = NULL;  // REPLICA 1
 	as_node *prole_2 = NULL;  // REPLICA 2
 
-	if (g_aerospike->cluster->shm_info) {
-		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, "Using shared memory (use_shm) is not supported by aql", NULL);
-		as_hashmap_destroy(&m);
-		return 1;
+	as_shm_info* shm_info = g_aerospike->cluster->shm_info;
+
+	if (shm_info) {
+		// Shared memory partition map stores 1-based indexes into the shared
+		// node array, 0 meaning no node. Map them to this process' nodes.
+		as_partition_table_shm* table =
+				as_shm_find_partition_table(shm_info->cluster_shm, key->ns);
+
+		if (!table) {
+			g_renderer->render_error(AEROSPIKE_ERR_CLIENT, "Error getting partition table", NULL);
+			as_hashmap_destroy(&m);
+			return 1;
+		}
+
+		as_partition_shm* p = &table->partitions[partition_id];
+		as_node* nodes[3] = { NULL, NULL, NULL };
+
+		for (uint32_t i = 0; i < 3 && i < table->replica_size; i++) {
+			uint32_t index = as_load_uint32(&p->nodes[i]);
+
+			if (index > 0) {
+				nodes[i] = (as_node*)as_load_ptr((void* const*)&shm_info->local_nodes[index - 1]);
+			}
+		}
+
+		master = nodes[0];
+		prole_1 = nodes[1];
+		prole_2 = nodes[2];
 	} else {
 		as_partition_tables* pptables = &g_aerospike->cluster->partition_tables;
 		as_partition_table* pptable = as_partition_tables_get(pptables, key->ns);
@@ -21,10 +21,14 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <aerospike/aerospike.h>
+#include <aerospike/aerospike_index.h>
 #include <aerospike/aerospike_info.h>
+#include <aerospike/aerospike_stats.h>
 #include <aerospike/aerospike_udf.h>
+#include <aerospike/as_cdt_ctx.h>
 #include <aerospike/as_cluster.h>
 #include <aerospike/as_error.h>
 #include <aerospike/as_hashmap.h>
@@ -35,8 +39,11 @@
 #include <aerospike/as_udf.h>
 
 #include <citrusleaf/cf_b64.h>
+#include <citrusleaf/cf_clock.h>
 
 #include <asql.h>
+#include <asql_advice.h>
+#include <asql_arena.h>
 #include <asql_info.h>
 #include <asql_info_parser.h>
 
@@ -60,6 +67,21 @@ typedef struct info_obj_s {
 	void* udata;
 } info_obj;
 
+// Index created in this session without WAIT, queries on its bin wait for it.
+typedef struct {
+	char ns[AS_NAMESPACE_MAX_SIZE];
+	char bname[AS_BIN_NAME_MAX_SIZE];
+	char iname[256];
+} pending_index;
+
+typedef struct {
+	uint32_t n_nodes;
+	uint32_t n_done;
+	char line[1024]; // "<node> <pct>%" per node
+} sindex_progress;
+
+#define SINDEX_POLL_MS 500
+
 
 //==========================================================
 // Forward Declarations.
@@ -68,6 +90,13 @@ typedef struct info_obj_s {
 
 static int udfput(asql_config* c, info_config* ic);
 static int udfremove(asql_config* c, info_config* ic);
+static int sindex_create(asql_config* c, info_config* ic);
+static int sindex_drop(asql_config* c, info_config* ic);
+static int pool_show(asql_config* c);
+static as_status sindex_wait(asql_config* c, const char* ns, const char* iname, as_error* err);
+static bool sindex_stat_cb(const as_error* err, const as_node* node, const char* req, char* res, void* udata);
+static void pending_index_add(index_param* ip);
+static void pending_index_remove(const char* ns, const char* iname);
 static int info_generic(asql_config* c, info_config* ic, info_obj* iobj);
 
 static info_obj* new_obj(parser_callback callback, void* udata, void* view);
@@ -83,6 +112,13 @@ static void udf_get_res_render(void* udata, const as_node* node, const char* req
 static void list_udf_res_render(void* udata, const as_node* node, const char* req, char* res);
 static void list_render(info_obj* iobj, const as_node* node, const char* req, char* res);
 
+//==========================================================
+// Globals.
+//
+
+static as_vector* g_pending_indexes = NULL;
+
+
 //==========================================================
 // Public API.
 //
@@ -96,6 +132,7 @@ asql_info_config_create(int optype, char* cmd, char* backout_cmd, bool is_ddl)
 	i->is_ddl = is_ddl;
 	i->cmd = cmd;
 	i->backout_cmd = backout_cmd;
+	i->index = NULL;
 	return i;
 }
 
@@ -151,6 +188,18 @@ asql_info(asql_config* c, aconfig* ac)
 	else if (strstr(ic->cmd, "udf-remove") == ic->cmd) {
 		rv = udfremove(c, ic);
 	}
+	else if (strstr(ic->cmd, "index-advice") == ic->cmd) {
+		rv = asql_advice_show(c);
+	}
+	else if (strstr(ic->cmd, "pool-stats") == ic->cmd) {
+		rv = pool_show(c);
+	}
+	else if (strstr(ic->cmd, "sindex-create") == ic->cmd) {
+		rv = sindex_create(c, ic);
+	}
+	else if (strstr(ic->cmd, "sindex-delete") == ic->cmd) {
+		rv = sindex_drop(c, ic);
+	}
 	else if (strstr(ic->cmd, "udf-get") == ic->cmd) {
 		parsed_resp = as_vector_create(sizeof(as_hashmap *), 128);
 		iobj = new_obj(udf_get_res_render, (void *)parsed_resp, NULL);
@@ -180,6 +229,38 @@ asql_info(asql_config* c, aconfig* ac)
 	return rv;
 }
 
+// Block until an index created earlier in this session on <ns> <bname> is
+// readable, a query issued while it builds returns partial results.
+int
+asql_index_wait_pending(asql_config* c, const char* ns, const char* bname)
+{
+	if (!g_pending_indexes || !ns || !bname) {
+		return 0;
+	}
+
+	uint32_t i = 0;
+
+	while (i < g_pending_indexes->size) {
+		pending_index* pi = as_vector_get(g_pending_indexes, i);
+
+		if (strcmp(pi->ns, ns) || strcmp(pi->bname, bname)) {
+			i++;
+			continue;
+		}
+
+		as_error err;
+		as_error_init(&err);
+
+		if (sindex_wait(c, pi->ns, pi->iname, &err) != AEROSPIKE_OK) {
+			g_renderer->render_error(err.code, err.message, NULL);
+			return -1;
+		}
+
+		as_vector_remove(g_pending_indexes, i);
+	}
+	return 0;
+}
+
 //==========================================================
 // Local Helpers.
 //
@@ -291,6 +372,296 @@ udfremove(asql_config* c, info_config* ic)
 	return 0;
 }
 
+static int
+sindex_create(asql_config* c, info_config* ic)
+{
+	index_param* ip = ic->index;
+
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	uint32_t n_ctx = ip->ctx ? ip->ctx->size : 0;
+
+	as_cdt_ctx ctx;
+	as_cdt_ctx_inita(&ctx, n_ctx ? n_ctx : 1);
+
+	for (uint32_t i = 0; i < n_ctx; i++) {
+		asql_cdt_step* step = as_vector_get(ip->ctx, i);
+
+		if (step->type == ASQL_CDT_STEP_KEY) {
+			as_val* key = asql_value_to_val(&err, &step->key);
+			if (!key) {
+				as_cdt_ctx_destroy(&ctx);
+				g_renderer->render_error(err.code, err.message, NULL);
+				return 1;
+			}
+			// Consumes key
+			as_cdt_ctx_add_map_key(&ctx, key);
+		}
+		else {
+			as_cdt_ctx_add_list_index(&ctx, (int)step->beg);
+		}
+	}
+
+	as_index_task task;
+	aerospike_index_create_ctx(g_aerospike, &err, &task, &info_policy, ip->ns,
+			ip->set, ip->bname, ip->iname, ip->itype, ip->dtype,
+			n_ctx ? &ctx : NULL);
+	as_cdt_ctx_destroy(&ctx);
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	if (!ip->wait) {
+		pending_index_add(ip);
+		g_renderer->render_ok("1 index created.", NULL);
+		return 0;
+	}
+
+	if (sindex_wait(c, ip->ns, ip->iname, &err) != AEROSPIKE_OK) {
+		pending_index_add(ip);
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	g_renderer->render_ok("1 index created and readable.", NULL);
+	return 0;
+}
+
+static int
+sindex_drop(asql_config* c, info_config* ic)
+{
+	index_param* ip = ic->index;
+
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	aerospike_index_remove(g_aerospike, &err, &info_policy, ip->ns, ip->iname);
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	pending_index_remove(ip->ns, ip->iname);
+	g_renderer->render_ok("1 index removed.", NULL);
+	return 0;
+}
+
+// Poll sindex-stat on every node until each reports load_pct=100, or until
+// INDEX_WAIT_TIMEOUT passes. Progress is redrawn on one line, and only if the
+// index was not already complete.
+static as_status
+sindex_wait(asql_config* c, const char* ns, const char* iname, as_error* err)
+{
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	char req[512];
+	snprintf(req, sizeof(req), "sindex-stat:namespace=%s;indexname=%s", ns,
+			iname);
+
+	bool shown = false;
+	uint64_t deadline = cf_getms() + (uint64_t)(c->index_wait_ms > 0 ?
+			c->index_wait_ms : 0);
+	g_interrupted = 0;
+
+	while (true) {
+		sindex_progress progress;
+		bzero(&progress, sizeof(sindex_progress));
+
+		if (aerospike_info_foreach(g_aerospike, err, &info_policy, req,
+				sindex_stat_cb, &progress) != AEROSPIKE_OK) {
+			break;
+		}
+
+		if (progress.n_nodes && progress.n_done == progress.n_nodes) {
+			break;
+		}
+
+		g_renderer->render_progress(progress.line, NULL);
+		shown = true;
+
+		if (g_interrupted) {
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Wait interrupted, index %s is still building", iname);
+			break;
+		}
+
+		if (cf_getms() >= deadline) {
+			as_error_update(err, AEROSPIKE_ERR_TIMEOUT,
+					"Index %s is still building after %d ms (INDEX_WAIT_TIMEOUT)",
+					iname, c->index_wait_ms);
+			break;
+		}
+
+		usleep(SINDEX_POLL_MS * 1000);
+	}
+
+	if (shown) {
+		g_renderer->render_progress(NULL, NULL);
+	}
+	return err->code;
+}
+
+static bool
+sindex_stat_cb(const as_error* err, const as_node* node, const char* req,
+		char* res, void* udata)
+{
+	sindex_progress* progress = (sindex_progress*)udata;
+	int pct = 0;
+
+	// A node that has not picked up the index yet answers FAIL, count it as 0%.
+	char* resp = err->code == AEROSPIKE_OK ? info_res_split(res) : NULL;
+	char* load = resp ? strstr(resp, "load_pct=") : NULL;
+
+	if (load) {
+		pct = atoi(load + strlen("load_pct="));
+	}
+
+	progress->n_nodes++;
+
+	if (pct >= 100) {
+		progress->n_done++;
+	}
+
+	size_t len = strlen(progress->line);
+	snprintf(progress->line + len, sizeof(progress->line) - len, "%s%s %d%%",
+			len ? "  " : "", node->name, pct);
+	return true;
+}
+
+static void
+pending_index_add(index_param* ip)
+{
+	if (!g_pending_indexes) {
+		g_pending_indexes = as_vector_create(sizeof(pending_index), 4);
+	}
+
+	pending_index pi;
+	bzero(&pi, sizeof(pending_index));
+	snprintf(pi.ns, sizeof(pi.ns), "%s", ip->ns);
+	snprintf(pi.bname, sizeof(pi.bname), "%s", ip->bname);
+	snprintf(pi.iname, sizeof(pi.iname), "%s", ip->iname);
+	as_vector_append(g_pending_indexes, &pi);
+}
+
+static void
+pending_index_remove(const char* ns, const char* iname)
+{
+	if (!g_pending_indexes) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < g_pending_indexes->size; i++) {
+		pending_index* pi = as_vector_get(g_pending_indexes, i);
+
+		if (!strcmp(pi->ns, ns) && !strcmp(pi->iname, iname)) {
+			as_vector_remove(g_pending_indexes, i);
+			return;
+		}
+	}
+}
+
+// Client side connection pool usage per node, to size MIN_CONNS_PER_NODE and
+// MAX_CONNS_PER_NODE for bulk work.
+static int
+pool_show(asql_config* c)
+{
+	as_cluster_stats stats;
+	aerospike_stats(g_aerospike, &stats);
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), 7);
+	const char* names[] = { "node", "in_use", "in_pool", "opened", "closed",
+			"min", "max" };
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		as_vector_append(&cols, &names[i]);
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	for (uint32_t i = 0; i < stats.nodes_size; i++) {
+		as_node_stats* ns = &stats.nodes[i];
+
+		as_hashmap m;
+		as_hashmap_init(&m, 8);
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("node"),
+				(as_val*)as_string_new_strdup(ns->node->name));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("in_use"),
+				(as_val*)as_integer_new(ns->sync.in_use));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("in_pool"),
+				(as_val*)as_integer_new(ns->sync.in_pool));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("opened"),
+				(as_val*)as_integer_new(ns->sync.opened));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("closed"),
+				(as_val*)as_integer_new(ns->sync.closed));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("min"),
+				(as_val*)as_integer_new(g_aerospike->config.min_conns_per_node));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("max"),
+				(as_val*)as_integer_new(g_aerospike->config.max_conns_per_node));
+
+		g_renderer->render((as_val*)&m, rview);
+		as_hashmap_destroy(&m);
+	}
+
+	g_renderer->render(NULL, rview);
+	g_renderer->view_destroy(rview);
+
+	// The memory statements parse into, last_peak is the statement before
+	// this one.
+	size_t last_peak;
+	size_t max_peak;
+	size_t committed;
+	asql_stmt_arena_stats(&last_peak, &max_peak, &committed);
+
+	as_vector_clear(&cols);
+	const char* arena_names[] = { "arena", "last_peak", "max_peak",
+			"committed" };
+
+	for (uint32_t i = 0; i < sizeof(arena_names) / sizeof(arena_names[0]); i++) {
+		as_vector_append(&cols, &arena_names[i]);
+	}
+
+	rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	as_hashmap m;
+	as_hashmap_init(&m, 4);
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("arena"),
+			(as_val*)as_string_new_strdup("statement"));
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("last_peak"),
+			(as_val*)as_integer_new((int64_t)last_peak));
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("max_peak"),
+			(as_val*)as_integer_new((int64_t)max_peak));
+	as_hashmap_set(&m, (as_val*)as_string_new_strdup("committed"),
+			(as_val*)as_integer_new((int64_t)committed));
+
+	g_renderer->render((as_val*)&m, rview);
+	as_hashmap_destroy(&m);
+
+	g_renderer->render(NULL, rview);
+	g_renderer->render_ok("", rview);
+	g_renderer->view_destroy(rview);
+
+	as_vector_destroy(&cols);
+	aerospike_stats_destroy(&stats);
+	return 0;
+}
+
 static int
 info_generic(asql_config* c, info_config* ic, info_obj* iobj)
 {
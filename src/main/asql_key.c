@@ -20,10 +20,13 @@
 //
 
 
+#include <pthread.h>
+
 #include <asql_log.h>
 #include <citrusleaf/cf_b64.h>
 
 #include <aerospike/aerospike.h>
+#include <aerospike/aerospike_batch.h>
 #include <aerospike/aerospike_key.h>
 #include <aerospike/as_aerospike.h>
 #include <aerospike/as_config.h>
@@ -33,7 +36,11 @@
 #include <aerospike/as_stringmap.h>
 
 #include <aerospike/as_arraylist.h>
+#include <aerospike/as_cdt_ctx.h>
+#include <aerospike/as_exp.h>
 #include <aerospike/as_list.h>
+#include <aerospike/as_list_operations.h>
+#include <aerospike/as_map_operations.h>
 
 #include <renderer.h>
 #include <json.h>
@@ -44,17 +51,68 @@
 #include <asql_key.h>
 
 
+//=========================================================
+// Typedefs & constants.
+//
+
+typedef struct {
+	select_param* s;
+	void* rview;
+	uint32_t n_found;
+} batch_select_udata;
+
+// Records per batch write, and batch writes allowed in flight at once. Scan
+// and query callbacks block once the limit is reached, which throttles the
+// source to the speed of the destination.
+#define COPY_BATCH_SIZE 500
+#define COPY_MAX_IN_FLIGHT 4
+
+struct asql_copy_s {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	as_policy_batch batch_policy;
+	as_policy_batch_write write_policy;
+
+	const char* ns;
+	const char* set;
+	bool same_set; // digests can be reused when no user key is stored
+
+	as_batch_records* pending;
+	uint32_t in_flight;
+
+	uint64_t n_copied;
+	uint64_t n_failed;
+	uint64_t n_skipped;
+	as_error err; // first batch level error, stops the stream
+};
+
+
 //=========================================================
 // Forward Declarations.
 //
 
 int key_init(as_error* err, as_key* key, char* ns, char* set, asql_value* in_key);
 
+extern void asql_query_render_count(uint64_t count);
+
 static int key_select(asql_config* c, pk_config* p);
+static int key_select_batch(asql_config* c, pk_config* p);
+static bool batch_select_cb(const as_batch_read* results, uint32_t n, void* udata);
 static int key_execute(asql_config* c, pk_config* p);
 static int key_read(asql_config* c, pk_config* p);
 static int key_delete(asql_config* c, pk_config* p);
 static int key_write(asql_config* c, pk_config* p);
+static int key_update(asql_config* c, pk_config* p);
+static as_exp* projection_exp(as_error* err, asql_projection* proj);
+static bool expr_has_float(asql_expr* expr);
+static as_exp* computed_exp(as_error* err, asql_expr* expr, bool is_float);
+static int key_update_batch(asql_config* c, pk_config* p, as_operations* ops);
+static bool batch_update_cb(const as_batch_result* results, uint32_t n, void* udata);
+
+static bool copy_record_add(asql_copy* cp, const as_record* src);
+static as_bin_value* copy_bin_value(const as_bin_value* v);
+static void copy_flush(asql_copy* cp, as_batch_records* recs);
 
 static void record_set_string(as_record* rec, as_error* err, as_hashmap *m, char* name, asql_value* val);
 
@@ -74,6 +132,8 @@ asql_key(asql_config* c, aconfig* ac)
 			return key_delete(c, p);
 		case READ_OP:
 			return key_read(c, p);
+		case UPDATE_OP:
+			return key_update(c, p);
 		default:
 			return 0;
 	}
@@ -92,6 +152,273 @@ asql_record_set_renderer(as_record* rec, as_hashmap* m, char* bin_name,
 	}
 }
 
+// Fill a record with the {ttl} and {gen} columns of a record header.
+void
+asql_record_set_header(as_record* rec, const as_key* key, const as_record* meta)
+{
+	if (key && key->valuep) {
+		rec->key.valuep = (as_key_value*)as_val_reserve(key->valuep);
+	}
+
+	// -1 is special and is treated as never expire
+	as_record_set_int64(rec, COL_NAME_META_TTL_NAME,
+			(int32_t)meta->ttl == -1 ? -1 : (int64_t)meta->ttl);
+	as_record_set_int64(rec, COL_NAME_META_GEN_NAME, meta->gen);
+}
+
+// Render callback for scans and queries run with no_bins, shows the header
+// columns instead of the digest.
+bool
+asql_render_header(const as_val* val, void* rview)
+{
+	if (!val) {
+		return g_renderer->render(val, rview);
+	}
+
+	as_record* meta = as_record_fromval(val);
+	as_record rec;
+	as_record_inita(&rec, 2);
+	asql_record_set_header(&rec, &meta->key, meta);
+
+	bool rv = g_renderer->render((as_val*)&rec, rview);
+	as_record_destroy(&rec);
+	return rv;
+}
+
+// Start an INSERT INTO ... SELECT copy. Records handed to asql_copy_callback()
+// are written to the destination in batches with their key, bins and TTL.
+asql_copy*
+asql_copy_create(asql_config* c, copy_param* into, const char* src_set,
+		as_error* err)
+{
+	if (strlen(into->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Namespace is too long: '%s'", into->ns);
+		return NULL;
+	}
+
+	if (into->set && (strlen(into->set) >= AS_SET_MAX_SIZE)) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT, "Set name is too long: '%s'",
+				into->set);
+		return NULL;
+	}
+
+	asql_copy* cp = malloc(sizeof(asql_copy));
+	bzero(cp, sizeof(asql_copy));
+	pthread_mutex_init(&cp->lock, NULL);
+	pthread_cond_init(&cp->cond, NULL);
+	as_error_init(&cp->err);
+
+	as_policy_batch_copy(&g_aerospike->config.policies.batch, &cp->batch_policy);
+	asql_policy_base_init(c, &cp->batch_policy.base);
+	cp->batch_policy.concurrent = c->concurrent;
+
+	// Keep the user key of the source record with the copy.
+	as_policy_batch_write_init(&cp->write_policy);
+	cp->write_policy.key = AS_POLICY_KEY_SEND;
+
+	cp->ns = into->ns;
+	cp->set = into->set;
+	cp->same_set = !strcmp(src_set ? src_set : "", into->set ? into->set : "");
+	cp->pending = as_batch_records_create(COPY_BATCH_SIZE);
+	return cp;
+}
+
+// Scan and query callback feeding the copy, may be called from several
+// threads at once.
+bool
+asql_copy_callback(const as_val* val, void* udata)
+{
+	asql_copy* cp = (asql_copy*)udata;
+
+	if (!val) {
+		return false;
+	}
+
+	as_batch_records* full = NULL;
+
+	pthread_mutex_lock(&cp->lock);
+
+	if (cp->err.code != AEROSPIKE_OK) {
+		pthread_mutex_unlock(&cp->lock);
+		return false;
+	}
+
+	if (!copy_record_add(cp, as_record_fromval(val))) {
+		cp->n_skipped++;
+	}
+
+	if (cp->pending->list.size >= COPY_BATCH_SIZE) {
+		while (cp->in_flight >= COPY_MAX_IN_FLIGHT) {
+			pthread_cond_wait(&cp->cond, &cp->lock);
+		}
+
+		// Another thread may have taken the batch while we waited.
+		if (cp->pending->list.size >= COPY_BATCH_SIZE) {
+			full = cp->pending;
+			cp->pending = as_batch_records_create(COPY_BATCH_SIZE);
+			cp->in_flight++;
+		}
+	}
+
+	pthread_mutex_unlock(&cp->lock);
+
+	if (full) {
+		copy_flush(cp, full);
+	}
+	return true;
+}
+
+// Write what is left, render the result and free the copy. <err> is the
+// status of the scan or query that fed it.
+void
+asql_copy_finish(asql_copy* cp, as_error* err)
+{
+	if (cp->pending->list.size > 0 && cp->err.code == AEROSPIKE_OK) {
+		cp->in_flight++;
+		copy_flush(cp, cp->pending);
+	}
+	else {
+		as_batch_records_destroy(cp->pending);
+	}
+
+	if (cp->err.code != AEROSPIKE_OK) {
+		as_error_copy(err, &cp->err);
+	}
+
+	if (err->code == AEROSPIKE_OK) {
+		char ok_msg[256];
+		int len = snprintf(ok_msg, sizeof(ok_msg), "%" PRIu64 " record%s copied.",
+				cp->n_copied, cp->n_copied == 1 ? "" : "s");
+
+		if (cp->n_failed || cp->n_skipped) {
+			snprintf(ok_msg + len, sizeof(ok_msg) - len,
+					" %" PRIu64 " failed, %" PRIu64 " skipped without a stored key.",
+					cp->n_failed, cp->n_skipped);
+		}
+		g_renderer->render_ok(ok_msg, NULL);
+	}
+	else {
+		g_renderer->render_error(err->code, err->message, NULL);
+	}
+
+	pthread_cond_destroy(&cp->cond);
+	pthread_mutex_destroy(&cp->lock);
+	free(cp);
+}
+
+// Translate parsed UPDATE assignments into record operations.
+int
+asql_update_ops_init(as_error* err, as_vector* uops, as_operations* ops)
+{
+	for (uint32_t i = 0; i < uops->size; i++) {
+		asql_update_op* uop = as_vector_get(uops, i);
+		char* name = uop->bname;
+		asql_value* value = &uop->value;
+
+		if (uop->type == ASQL_UPDATE_OP_TOUCH) {
+			as_operations_add_touch(ops);
+			continue;
+		}
+
+		if (strlen(name) > AS_BIN_NAME_MAX_LEN) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Bin name is too long: '%s'", name);
+		}
+
+		switch (uop->type) {
+			case ASQL_UPDATE_OP_INCR: {
+				if (value->type == AS_DOUBLE) {
+					as_operations_add_incr_double(ops, name, value->u.dbl);
+				}
+				else {
+					as_operations_add_incr(ops, name, value->u.i64);
+				}
+				break;
+			}
+			case ASQL_UPDATE_OP_CONCAT: {
+				as_operations_add_append_strp(ops, name, value->u.str, false);
+				break;
+			}
+			case ASQL_UPDATE_OP_LIST_APPEND: {
+				as_val* val = asql_value_to_val(err, value);
+				if (!val) {
+					return err->code;
+				}
+				// Consumes val
+				as_operations_list_append(ops, name, NULL, NULL, val);
+				break;
+			}
+			case ASQL_UPDATE_OP_MAP_PUT: {
+				as_val* key = asql_value_to_val(err, &uop->key);
+				if (!key) {
+					return err->code;
+				}
+
+				as_val* val = asql_value_to_val(err, value);
+				if (!val) {
+					as_val_destroy(key);
+					return err->code;
+				}
+
+				as_map_policy map_policy;
+				as_map_policy_init(&map_policy);
+				// Consumes key and val
+				as_operations_map_put(ops, name, NULL, &map_policy, key, val);
+				break;
+			}
+			case ASQL_UPDATE_OP_WRITE:
+			default: {
+				as_val* val = asql_value_to_val(err, value);
+				if (!val) {
+					return err->code;
+				}
+				// Consumes val
+				as_operations_add_write(ops, name, (as_bin_value*)val);
+				break;
+			}
+		}
+	}
+	return AEROSPIKE_OK;
+}
+
+// Translate a SELECT list with CDT paths and computed columns into read
+// operations. Whole bins are plain reads, paths and computed columns are
+// expression reads so only the result leaves the server.
+int
+asql_projection_ops_init(as_error* err, select_param* s, as_operations* ops)
+{
+	for (uint32_t i = 0; i < s->projs->size; i++) {
+		asql_projection* proj = as_vector_get(s->projs, i);
+		char* name = as_vector_get_ptr(s->bnames, i);
+
+		if (strlen(name) > AS_BIN_NAME_MAX_LEN
+				|| (proj->bname && strlen(proj->bname) > AS_BIN_NAME_MAX_LEN)) {
+			return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Bin name is too long: '%s'", name);
+		}
+
+		if (!proj->path && !proj->expr) {
+			as_operations_add_read(ops, proj->bname);
+			continue;
+		}
+
+		as_exp* exp = proj->expr
+				? computed_exp(err, proj->expr, expr_has_float(proj->expr))
+				: projection_exp(err, proj);
+		if (!exp) {
+			return err->code;
+		}
+
+		// A computed column over a missing or non numeric bin reads as nil,
+		// rather than failing the whole record.
+		as_operations_exp_read(ops, name, exp, proj->expr
+				? AS_EXP_READ_EVAL_NO_FAIL : AS_EXP_READ_DEFAULT);
+		as_exp_destroy(exp);
+	}
+	return AEROSPIKE_OK;
+}
+
 int
 key_init(as_error* err, as_key* key, char* ns, char* set, asql_value* in_key)
 {
@@ -162,12 +489,8 @@ key_select(asql_config* c, pk_config* p)
 	as_error_init(&err);
 
 	as_policy_read read_policy;
-	as_policy_read_init(&read_policy);
-	read_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		read_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	as_policy_read_copy(&g_aerospike->config.policies.read, &read_policy);
+	asql_policy_base_init(c, &read_policy.base);
 
 	if (p->key.vt == ASQL_VALUE_TYPE_EDIGEST
 		   || p->key.vt == ASQL_VALUE_TYPE_DIGEST) {
@@ -177,6 +500,10 @@ key_select(asql_config* c, pk_config* p)
 		read_policy.key = AS_POLICY_KEY_SEND;
 	}
 
+	if (p->keys) {
+		return key_select_batch(c, p);
+	}
+
 	as_key key;
 
 	if (key_init(&err, &key, p->ns, p->set, &p->key) != 0) {
@@ -186,7 +513,75 @@ key_select(asql_config* c, pk_config* p)
 
 	as_record* rec = NULL;
 
-	if (!p->s.bnames) {
+	if (p->s.exists || p->s.header) {
+		// Header only, no bin data is sent.
+		as_record* meta = NULL;
+		as_status status = aerospike_key_exists(g_aerospike, &err, &read_policy,
+				&key, &meta);
+
+		if (p->explain) {
+			asql_key_select_explain(c, p, &key, &err);
+		}
+		else if (p->s.exists && (status == AEROSPIKE_OK
+				|| status == AEROSPIKE_ERR_RECORD_NOT_FOUND)) {
+			as_record hrec;
+			as_record_inita(&hrec, 1);
+			as_record_set_int64(&hrec, COL_NAME_EXISTS, meta ? 1 : 0);
+			print_rec(&hrec, NULL);
+			as_record_destroy(&hrec);
+		}
+		else if (status == AEROSPIKE_OK) {
+			as_record hrec;
+			as_record_inita(&hrec, 2);
+			asql_record_set_header(&hrec, NULL, meta);
+			print_rec(&hrec, p->s.bnames);
+			as_record_destroy(&hrec);
+		}
+		else {
+			g_renderer->render_error(err.code, err.message, NULL);
+		}
+		as_record_destroy(meta);
+		return 0;
+	}
+
+	if (p->s.count) {
+		// COUNT(*) on a single key is an existence check.
+		as_record* meta = NULL;
+		as_status status = aerospike_key_exists(g_aerospike, &err, &read_policy,
+				&key, &meta);
+
+		if (status == AEROSPIKE_OK || status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			asql_query_render_count(meta ? 1 : 0);
+		}
+		else {
+			g_renderer->render_error(err.code, err.message, NULL);
+		}
+		as_record_destroy(meta);
+		return 0;
+	}
+
+	if (p->s.projs) {
+		// select CDT paths
+		as_operations ops;
+		as_operations_inita(&ops, p->s.projs->size);
+
+		if (asql_projection_ops_init(&err, &p->s, &ops) == AEROSPIKE_OK) {
+			// A read only operate, routed like the plain read.
+			as_policy_operate operate_policy;
+			as_policy_operate_copy(&g_aerospike->config.policies.operate,
+					&operate_policy);
+			operate_policy.base = read_policy.base;
+			operate_policy.key = read_policy.key;
+			operate_policy.replica = read_policy.replica;
+			operate_policy.read_mode_ap = read_policy.read_mode_ap;
+			operate_policy.read_mode_sc = read_policy.read_mode_sc;
+
+			aerospike_key_operate(g_aerospike, &err, &operate_policy, &key,
+					&ops, &rec);
+		}
+		as_operations_destroy(&ops);
+	}
+	else if (!p->s.bnames) {
 		// select all bins
 		aerospike_key_get(g_aerospike, &err, &read_policy, &key, &rec);
 	}
@@ -230,6 +625,273 @@ key_select(asql_config* c, pk_config* p)
 	return 0;
 }
 
+// Read every key of "PK IN (...)" in one batch. EXISTS, COUNT(*) and metadata
+// columns use batch exists so only record headers are returned.
+static int
+key_select_batch(asql_config* c, pk_config* p)
+{
+	as_error err;
+	as_error_init(&err);
+
+	if (p->explain || p->s.projs) {
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT,
+				"EXPLAIN, CDT paths and computed columns are not supported with PK IN",
+				NULL);
+		return 1;
+	}
+
+	as_policy_batch batch_policy;
+	as_policy_batch_copy(&g_aerospike->config.policies.batch, &batch_policy);
+	asql_policy_base_init(c, &batch_policy.base);
+	batch_policy.concurrent = c->concurrent;
+
+	as_batch batch;
+	as_batch_init(&batch, p->keys->size);
+
+	for (uint32_t i = 0; i < p->keys->size; i++) {
+		asql_value* in_key = as_vector_get(p->keys, i);
+
+		if (key_init(&err, as_batch_keyat(&batch, i), p->ns, p->set,
+				in_key) != 0) {
+			g_renderer->render_error(err.code, err.message, NULL);
+			as_batch_destroy(&batch);
+			return 1;
+		}
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	batch_select_udata udata = { .s = &p->s, .rview = rview, .n_found = 0 };
+
+	if (p->s.exists || p->s.header || p->s.count) {
+		// record headers only
+		if (p->s.header) {
+			g_renderer->view_set_cols(p->s.bnames, rview);
+		}
+		aerospike_batch_exists(g_aerospike, &err, &batch_policy, &batch,
+				batch_select_cb, &udata);
+	}
+	else if (!p->s.bnames) {
+		// select all bins
+		aerospike_batch_get(g_aerospike, &err, &batch_policy, &batch,
+				batch_select_cb, &udata);
+	}
+	else {
+		// select specific bins
+		const char** bins = (const char**)alloca(
+		        sizeof(char*) * p->s.bnames->size);
+
+		for (uint32_t i = 0; i < p->s.bnames->size; i++) {
+			char* bname = as_vector_get_ptr(p->s.bnames, i);
+			if (strlen(bname) > AS_BIN_NAME_MAX_LEN) {
+				as_error_update(&err, AEROSPIKE_ERR_CLIENT,
+				                "Bin name is too long: '%s'", bname);
+				break;
+			}
+			bins[i] = bname;
+		}
+
+		if (err.code == AEROSPIKE_OK) {
+			g_renderer->view_set_cols(p->s.bnames, rview);
+			aerospike_batch_select(g_aerospike, &err, &batch_policy, &batch,
+					bins, p->s.bnames->size, batch_select_cb, &udata);
+		}
+	}
+
+	// Individual key failures surface as AEROSPIKE_BATCH_FAILED.
+	if (err.code == AEROSPIKE_OK || err.code == AEROSPIKE_BATCH_FAILED) {
+		if (p->s.count) {
+			asql_query_render_count(udata.n_found);
+		}
+		else {
+			g_renderer->render(NULL, rview);
+			g_renderer->render_ok("", rview);
+		}
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, rview);
+	}
+
+	g_renderer->view_destroy(rview);
+	as_batch_destroy(&batch);
+	return 0;
+}
+
+static bool
+batch_select_cb(const as_batch_read* results, uint32_t n, void* udata)
+{
+	batch_select_udata* bu = (batch_select_udata*)udata;
+
+	for (uint32_t i = 0; i < n; i++) {
+		const as_batch_read* r = &results[i];
+
+		if (r->result == AEROSPIKE_OK) {
+			bu->n_found++;
+		}
+		else if (r->result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			char* key_str = r->key->valuep
+					? as_val_tostring(r->key->valuep) : NULL;
+			char msg[256];
+			snprintf(msg, sizeof(msg), "read failed for key %s",
+					key_str ? key_str : "<digest>");
+			g_renderer->render_error(r->result, msg, NULL);
+			free(key_str);
+			continue;
+		}
+
+		if (bu->s->count) {
+			continue;
+		}
+
+		if (bu->s->exists) {
+			as_record rec;
+			as_record_inita(&rec, 1);
+			if (r->key->valuep) {
+				rec.key.valuep = (as_key_value*)as_val_reserve(r->key->valuep);
+			}
+			as_record_set_int64(&rec, COL_NAME_EXISTS,
+					r->result == AEROSPIKE_OK ? 1 : 0);
+			g_renderer->render((as_val*)&rec, bu->rview);
+			as_record_destroy(&rec);
+		}
+		else if (r->result == AEROSPIKE_OK && bu->s->header) {
+			as_record rec;
+			as_record_inita(&rec, 2);
+			asql_record_set_header(&rec, r->key, &r->record);
+			g_renderer->render((as_val*)&rec, bu->rview);
+			as_record_destroy(&rec);
+		}
+		else if (r->result == AEROSPIKE_OK) {
+			g_renderer->render((as_val*)&r->record, bu->rview);
+		}
+	}
+	return true;
+}
+
+// Queue a streamed record as a batch write to the copy destination. The record
+// is freed once the callback returns, so key and bins are copied. Returns
+// false if the destination key cannot be derived.
+static bool
+copy_record_add(asql_copy* cp, const as_record* src)
+{
+	as_val* kv = (as_val*)src->key.valuep;
+
+	if (kv) {
+		as_val_t t = as_val_type(kv);
+
+		if (t != AS_INTEGER && t != AS_STRING && t != AS_BYTES) {
+			return false;
+		}
+	}
+	else if (!cp->same_set) {
+		// The digest covers the set name, it can't be moved to another set.
+		return false;
+	}
+
+	as_batch_write_record* r = as_batch_write_reserve(cp->pending);
+
+	if (!kv) {
+		as_key_init_digest(&r->key, cp->ns, cp->set, src->key.digest.value);
+	}
+	else if (as_val_type(kv) == AS_INTEGER) {
+		as_key_init_int64(&r->key, cp->ns, cp->set,
+				as_integer_get((as_integer*)kv));
+	}
+	else if (as_val_type(kv) == AS_STRING) {
+		as_key_init_strp(&r->key, cp->ns, cp->set,
+				strdup(as_string_get((as_string*)kv)), true);
+	}
+	else {
+		as_bytes* b = (as_bytes*)kv;
+		uint8_t* raw = malloc(b->size);
+		memcpy(raw, b->value, b->size);
+		as_key_init_rawp(&r->key, cp->ns, cp->set, raw, b->size, true);
+	}
+
+	r->ops = as_operations_new(src->bins.size);
+	r->ops->ttl = src->ttl;
+	r->policy = &cp->write_policy;
+
+	for (uint16_t i = 0; i < src->bins.size; i++) {
+		as_bin* bin = &src->bins.entries[i];
+		as_operations_add_write(r->ops, bin->name, copy_bin_value(bin->valuep));
+	}
+	return true;
+}
+
+// Scalar bin values live inside the streamed record, lists and maps are
+// separate values and are shared.
+static as_bin_value*
+copy_bin_value(const as_bin_value* v)
+{
+	as_val* val = (as_val*)v;
+
+	switch (as_val_type(val)) {
+		case AS_INTEGER:
+			return (as_bin_value*)as_integer_new(
+					as_integer_get((as_integer*)val));
+		case AS_DOUBLE:
+			return (as_bin_value*)as_double_new(as_double_get((as_double*)val));
+		case AS_BOOLEAN:
+			return (as_bin_value*)as_boolean_new(
+					as_boolean_get((as_boolean*)val));
+		case AS_STRING:
+			return (as_bin_value*)as_string_new_strdup(
+					as_string_get((as_string*)val));
+		case AS_GEOJSON:
+			return (as_bin_value*)as_geojson_new(
+					strdup(as_geojson_get((as_geojson*)val)), true);
+		case AS_BYTES: {
+			as_bytes* b = (as_bytes*)val;
+			uint8_t* raw = malloc(b->size);
+			memcpy(raw, b->value, b->size);
+			as_bytes* copy = as_bytes_new_wrap(raw, b->size, true);
+			copy->type = b->type;
+			return (as_bin_value*)copy;
+		}
+		case AS_LIST:
+		case AS_MAP:
+			return (as_bin_value*)as_val_reserve(val);
+		default:
+			return (as_bin_value*)&as_nil;
+	}
+}
+
+static void
+copy_flush(asql_copy* cp, as_batch_records* recs)
+{
+	as_error err;
+	as_error_init(&err);
+
+	aerospike_batch_write(g_aerospike, &err, &cp->batch_policy, recs);
+
+	uint32_t n_ok = 0;
+
+	for (uint32_t i = 0; i < recs->list.size; i++) {
+		as_batch_base_record* r = as_vector_get(&recs->list, i);
+
+		if (r->result == AEROSPIKE_OK) {
+			n_ok++;
+		}
+	}
+
+	pthread_mutex_lock(&cp->lock);
+
+	cp->n_copied += n_ok;
+	cp->n_failed += recs->list.size - n_ok;
+
+	// Individual key failures surface as AEROSPIKE_BATCH_FAILED.
+	if (err.code != AEROSPIKE_OK && err.code != AEROSPIKE_BATCH_FAILED
+			&& cp->err.code == AEROSPIKE_OK) {
+		as_error_copy(&cp->err, &err);
+	}
+
+	cp->in_flight--;
+	pthread_cond_signal(&cp->cond);
+	pthread_mutex_unlock(&cp->lock);
+
+	as_batch_records_destroy(recs);
+}
+
 static int
 key_execute(asql_config* c, pk_config* p)
 {
@@ -238,11 +900,7 @@ key_execute(asql_config* c, pk_config* p)
 
 	as_policy_apply apply_policy;
 	as_policy_apply_init(&apply_policy);
-	apply_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		apply_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	asql_policy_base_init(c, &apply_policy.base);
 	apply_policy.durable_delete = c->durable_delete;
 
 	if (p->key.vt == ASQL_VALUE_TYPE_EDIGEST
@@ -319,11 +977,7 @@ key_delete(asql_config* c, pk_config* p)
 
 	as_policy_remove remove_policy;
 	as_policy_remove_init(&remove_policy);
-	remove_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		remove_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	asql_policy_base_init(c, &remove_policy.base);
 	remove_policy.durable_delete = c->durable_delete;
 
 	if (p->key.vt == ASQL_VALUE_TYPE_EDIGEST
@@ -365,12 +1019,9 @@ key_write(asql_config* c, pk_config* p)
 
 	as_policy_write write_policy;
 	as_policy_write_init(&write_policy);
-	write_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		write_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	asql_policy_base_init(c, &write_policy.base);
 	write_policy.durable_delete = c->durable_delete;
+	write_policy.exists = (as_policy_exists)c->record_exists;
 
 	if (p->key.vt == ASQL_VALUE_TYPE_EDIGEST
 		   || p->key.vt == ASQL_VALUE_TYPE_DIGEST) {
@@ -455,6 +1106,345 @@ key_write(asql_config* c, pk_config* p)
 	return 0;
 }
 
+// Apply all assignments to the record in a single operate round trip.
+static int
+key_update(asql_config* c, pk_config* p)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_operations ops;
+	as_operations_inita(&ops, p->up.ops->size);
+	ops.ttl = p->up.has_ttl ? p->up.ttl : c->record_ttl_sec;
+
+	if (asql_update_ops_init(&err, p->up.ops, &ops) != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		as_operations_destroy(&ops);
+		return 1;
+	}
+
+	if (p->keys) {
+		int rv = key_update_batch(c, p, &ops);
+		as_operations_destroy(&ops);
+		return rv;
+	}
+
+	as_policy_operate operate_policy;
+	as_policy_operate_init(&operate_policy);
+	asql_policy_base_init(c, &operate_policy.base);
+	operate_policy.durable_delete = c->durable_delete;
+
+	if (p->key.vt == ASQL_VALUE_TYPE_EDIGEST
+		   || p->key.vt == ASQL_VALUE_TYPE_DIGEST) {
+		operate_policy.key = AS_POLICY_KEY_DIGEST;
+	}
+	else if (c->key_send) {
+		operate_policy.key = AS_POLICY_KEY_SEND;
+	}
+
+	as_key key;
+
+	if (key_init(&err, &key, p->ns, p->set, &p->key) != 0) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		as_operations_destroy(&ops);
+		return 1;
+	}
+
+	as_record* rec = NULL;
+	aerospike_key_operate(g_aerospike, &err, &operate_policy, &key, &ops, &rec);
+
+	if (err.code == AEROSPIKE_OK) {
+		g_renderer->render_ok("1 record affected.", NULL);
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_record_destroy(rec);
+	as_operations_destroy(&ops);
+
+	return 0;
+}
+
+// Apply the same operations to every key of "PK IN (...)" in one batch.
+static int
+key_update_batch(asql_config* c, pk_config* p, as_operations* ops)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_batch batch_policy;
+	as_policy_batch_copy(&g_aerospike->config.policies.batch, &batch_policy);
+	asql_policy_base_init(c, &batch_policy.base);
+	batch_policy.concurrent = c->concurrent;
+
+	as_policy_batch_write write_policy;
+	as_policy_batch_write_init(&write_policy);
+	write_policy.durable_delete = c->durable_delete;
+
+	if (c->key_send) {
+		write_policy.key = AS_POLICY_KEY_SEND;
+	}
+
+	as_batch batch;
+	as_batch_init(&batch, p->keys->size);
+
+	for (uint32_t i = 0; i < p->keys->size; i++) {
+		asql_value* in_key = as_vector_get(p->keys, i);
+
+		if (key_init(&err, as_batch_keyat(&batch, i), p->ns, p->set,
+				in_key) != 0) {
+			g_renderer->render_error(err.code, err.message, NULL);
+			as_batch_destroy(&batch);
+			return 1;
+		}
+	}
+
+	uint32_t n_updated = 0;
+	aerospike_batch_operate(g_aerospike, &err, &batch_policy, &write_policy,
+			&batch, ops, batch_update_cb, &n_updated);
+
+	// Individual key failures surface as AEROSPIKE_BATCH_FAILED.
+	if (err.code == AEROSPIKE_OK || err.code == AEROSPIKE_BATCH_FAILED) {
+		char ok_msg[128];
+		snprintf(ok_msg, sizeof(ok_msg), "%u record%s affected.", n_updated,
+				n_updated == 1 ? "" : "s");
+		g_renderer->render_ok(ok_msg, NULL);
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_batch_destroy(&batch);
+	return 0;
+}
+
+static bool
+batch_update_cb(const as_batch_result* results, uint32_t n, void* udata)
+{
+	uint32_t* n_updated = (uint32_t*)udata;
+
+	for (uint32_t i = 0; i < n; i++) {
+		if (results[i].result == AEROSPIKE_OK) {
+			(*n_updated)++;
+		}
+		else {
+			char* key_str = results[i].key->valuep
+					? as_val_tostring(results[i].key->valuep) : NULL;
+			char msg[256];
+			snprintf(msg, sizeof(msg), "update failed for key %s",
+					key_str ? key_str : "<digest>");
+			g_renderer->render_error(results[i].result, msg, NULL);
+			free(key_str);
+		}
+	}
+	return true;
+}
+
+// Build the read expression for "<bin>[...][...]". All path elements but the
+// last become the CDT context, the last one selects what is returned.
+static as_exp*
+projection_exp(as_error* err, asql_projection* proj)
+{
+	as_vector* path = proj->path;
+	asql_cdt_step* first = as_vector_get(path, 0);
+	asql_cdt_step* last = as_vector_get(path, path->size - 1);
+
+	as_cdt_ctx ctx;
+	as_cdt_ctx_inita(&ctx, path->size);
+
+	for (uint32_t i = 0; i < path->size - 1; i++) {
+		asql_cdt_step* step = as_vector_get(path, i);
+
+		if (step->type == ASQL_CDT_STEP_KEY) {
+			as_val* key = asql_value_to_val(err, &step->key);
+			if (!key) {
+				as_cdt_ctx_destroy(&ctx);
+				return NULL;
+			}
+			// Consumes key
+			as_cdt_ctx_add_map_key(&ctx, key);
+		}
+		else {
+			as_cdt_ctx_add_list_index(&ctx, (int)step->beg);
+		}
+	}
+
+	as_cdt_ctx* pctx = path->size > 1 ? &ctx : NULL;
+
+	as_exp* bin = NULL;
+	if (first->type == ASQL_CDT_STEP_KEY) {
+		as_exp_build(b, as_exp_bin_map(proj->bname));
+		bin = b;
+	}
+	else {
+		as_exp_build(b, as_exp_bin_list(proj->bname));
+		bin = b;
+	}
+
+	as_exp* exp = NULL;
+
+	switch (last->type) {
+		case ASQL_CDT_STEP_KEY: {
+			as_exp_build(e, as_exp_map_get_by_key(pctx, AS_MAP_RETURN_VALUE,
+					AS_EXP_TYPE_AUTO, as_exp_str(last->key.u.str),
+					as_exp_expr(bin)));
+			exp = e;
+			break;
+		}
+		case ASQL_CDT_STEP_RANGE: {
+			int64_t beg = last->has_beg ? last->beg : 0;
+
+			if (!last->has_end) {
+				as_exp_build(e, as_exp_list_get_by_index_range_to_end(pctx,
+						AS_LIST_RETURN_VALUE, as_exp_int(beg), as_exp_expr(bin)));
+				exp = e;
+			}
+			else {
+				int64_t count = last->end > beg ? last->end - beg : 0;
+				as_exp_build(e, as_exp_list_get_by_index_range(pctx,
+						AS_LIST_RETURN_VALUE, as_exp_int(beg), as_exp_int(count),
+						as_exp_expr(bin)));
+				exp = e;
+			}
+			break;
+		}
+		case ASQL_CDT_STEP_INDEX:
+		default: {
+			as_exp_build(e, as_exp_list_get_by_index(pctx, AS_LIST_RETURN_VALUE,
+					AS_EXP_TYPE_AUTO, as_exp_int(last->beg), as_exp_expr(bin)));
+			exp = e;
+			break;
+		}
+	}
+
+	as_exp_destroy(bin);
+	as_cdt_ctx_destroy(&ctx);
+
+	if (!exp) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Unable to build read expression for '%s'", proj->bname);
+	}
+	return exp;
+}
+
+// Expression arithmetic needs operands of one type. Evaluate in floating
+// point when any literal is a float, integer and float bins are then both
+// converted. Otherwise bins are read as integers and '/' truncates toward
+// zero, e.g. a * 100 / b.
+static bool
+expr_has_float(asql_expr* expr)
+{
+	if (!expr) {
+		return false;
+	}
+
+	if (expr->type == ASQL_EXPR_VALUE) {
+		return expr->value.type == AS_DOUBLE;
+	}
+	return expr_has_float(expr->left) || expr_has_float(expr->right);
+}
+
+static as_exp*
+computed_exp(as_error* err, asql_expr* expr, bool is_float)
+{
+	switch (expr->type) {
+		case ASQL_EXPR_BIN: {
+			if (is_float) {
+				as_exp_build(e, as_exp_cond(
+						as_exp_cmp_eq(as_exp_bin_type(expr->bname),
+								as_exp_int(AS_BYTES_DOUBLE)),
+						as_exp_bin_float(expr->bname),
+						as_exp_to_float(as_exp_bin_int(expr->bname))));
+				return e;
+			}
+			as_exp_build(e, as_exp_bin_int(expr->bname));
+			return e;
+		}
+		case ASQL_EXPR_VALUE: {
+			if (expr->value.type == AS_DOUBLE) {
+				as_exp_build(e, as_exp_float(expr->value.u.dbl));
+				return e;
+			}
+			if (is_float) {
+				as_exp_build(e, as_exp_float((double)expr->value.u.i64));
+				return e;
+			}
+			as_exp_build(e, as_exp_int(expr->value.u.i64));
+			return e;
+		}
+		case ASQL_EXPR_LIST_SIZE:
+		case ASQL_EXPR_MAP_SIZE: {
+			as_exp* size = NULL;
+
+			if (expr->type == ASQL_EXPR_LIST_SIZE) {
+				as_exp_build(e, as_exp_list_size(NULL,
+						as_exp_bin_list(expr->bname)));
+				size = e;
+			}
+			else {
+				as_exp_build(e, as_exp_map_size(NULL,
+						as_exp_bin_map(expr->bname)));
+				size = e;
+			}
+
+			if (!is_float) {
+				return size;
+			}
+
+			as_exp_build(e, as_exp_to_float(as_exp_expr(size)));
+			as_exp_destroy(size);
+			return e;
+		}
+		default:
+			break;
+	}
+
+	as_exp* left = computed_exp(err, expr->left, is_float);
+	if (!left) {
+		return NULL;
+	}
+
+	as_exp* right = computed_exp(err, expr->right, is_float);
+	if (!right) {
+		as_exp_destroy(left);
+		return NULL;
+	}
+
+	as_exp* exp = NULL;
+
+	switch (expr->type) {
+		case ASQL_EXPR_ADD: {
+			as_exp_build(e, as_exp_add(as_exp_expr(left), as_exp_expr(right)));
+			exp = e;
+			break;
+		}
+		case ASQL_EXPR_SUB: {
+			as_exp_build(e, as_exp_sub(as_exp_expr(left), as_exp_expr(right)));
+			exp = e;
+			break;
+		}
+		case ASQL_EXPR_MUL: {
+			as_exp_build(e, as_exp_mul(as_exp_expr(left), as_exp_expr(right)));
+			exp = e;
+			break;
+		}
+		case ASQL_EXPR_DIV: {
+			as_exp_build(e, as_exp_div(as_exp_expr(left), as_exp_expr(right)));
+			exp = e;
+			break;
+		}
+		default:
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Unsupported expression type: %d", expr->type);
+			break;
+	}
+
+	as_exp_destroy(left);
+	as_exp_destroy(right);
+	return exp;
+}
+
 static void
 record_set_string(as_record* rec, as_error* err, as_hashmap *m, char* name,
 		asql_value* value)
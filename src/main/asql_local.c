@@ -0,0 +1,758 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <inttypes.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_key.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_aerospike.h>
+#include <aerospike/as_arraylist.h>
+#include <aerospike/as_buffer.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_map.h>
+#include <aerospike/as_module.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_result.h>
+#include <aerospike/as_scan.h>
+#include <aerospike/as_stream.h>
+#include <aerospike/as_string.h>
+#include <aerospike/mod_lua.h>
+#include <aerospike/mod_lua_config.h>
+
+#include <renderer.h>
+#include <asql.h>
+#include <asql_local.h>
+#include <asql_scan.h>
+#include <asql_value.h>
+#include <json.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+// Cost of one UDF call. heap is the growth of the process heap across the
+// call, what the call left allocated, -1 if the allocator can't tell.
+typedef struct {
+	uint64_t cpu_ns;
+	int64_t heap;
+	uint32_t out_bytes;
+	uint32_t n_out;
+} local_cost;
+
+// Writes the UDF would have made, the sandbox never applies them.
+typedef struct {
+	uint32_t writes;
+	uint32_t removes;
+} local_sandbox;
+
+typedef struct {
+	pthread_mutex_t lock;
+	as_vector* recs;
+	uint32_t max;
+} local_sample_udata;
+
+// Source and sink of AGGREGATE LOCAL.
+typedef struct {
+	as_vector* recs;
+	uint32_t next;
+	as_vector* out;
+	as_serializer ser;
+	uint32_t out_bytes;
+} local_stream_data;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+extern int key_init(as_error* err, as_key* key, char* ns, char* set,
+		asql_value* in_key);
+extern void strncpy_and_strip_quotes(char* to, const char* from, size_t size);
+
+static as_status load_keys(asql_config* c, as_error* err, local_config* l,
+		as_vector* recs);
+static as_status load_sample(asql_config* c, as_error* err, local_config* l,
+		as_vector* recs);
+static as_status load_file(as_error* err, const char* path, as_vector* recs);
+static int local_execute(local_config* l, as_vector* recs, as_list* args,
+		local_sandbox* sb, local_cost* total, uint64_t* max_ns);
+static int local_aggregate(local_config* l, as_vector* recs, as_list* args,
+		local_sandbox* sb, local_cost* total);
+static void lua_server_mode(bool server_mode);
+static as_record* record_copy(const as_record* src, as_serializer* ser);
+static uint64_t thread_cpu_ns();
+static int64_t heap_in_use();
+
+static int sandbox_rec_write(const as_aerospike* as, const as_rec* r);
+static int sandbox_rec_remove(const as_aerospike* as, const as_rec* r);
+static int sandbox_rec_exists(const as_aerospike* as, const as_rec* r);
+static int sandbox_log(const as_aerospike* as, const char* file,
+		const int line, const int level, const char* msg);
+
+static as_val* stream_read(const as_stream* s);
+static as_stream_status stream_write(const as_stream* s, as_val* v);
+
+static const as_aerospike_hooks sandbox_hooks = {
+	.rec_create = sandbox_rec_write,
+	.rec_update = sandbox_rec_write,
+	.rec_remove = sandbox_rec_remove,
+	.rec_exists = sandbox_rec_exists,
+	.log = sandbox_log,
+};
+
+static const as_stream_hooks istream_hooks = {
+	.read = stream_read,
+};
+
+static const as_stream_hooks ostream_hooks = {
+	.write = stream_write,
+};
+
+
+//=========================================================
+// Public API.
+//
+
+int
+asql_local(asql_config* c, aconfig* ac)
+{
+	local_config* l = (local_config*)ac;
+
+	as_error err;
+	as_error_init(&err);
+
+	as_vector recs;
+	as_vector_init(&recs, sizeof(as_record*), 16);
+
+	int rv = 1;
+	as_status status;
+
+	if (l->file) {
+		status = load_file(&err, l->file, &recs);
+	}
+	else if (l->keys) {
+		status = load_keys(c, &err, l, &recs);
+	}
+	else {
+		status = load_sample(c, &err, l, &recs);
+	}
+
+	if (status != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		goto CLEANUP;
+	}
+
+	if (recs.size == 0) {
+		g_renderer->render_error(AEROSPIKE_ERR_RECORD_NOT_FOUND,
+				"No records to run the UDF against", NULL);
+		goto CLEANUP;
+	}
+
+	as_arraylist arglist;
+	as_arraylist_inita(&arglist, l->u.params->size);
+	asql_set_args(&err, l->u.params, &arglist);
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		as_arraylist_destroy(&arglist);
+		goto CLEANUP;
+	}
+
+	local_sandbox sb = { 0 };
+	local_cost total = { .heap = heap_in_use() < 0 ? -1 : 0 };
+	uint64_t max_ns = 0;
+	uint32_t n_calls;
+
+	if (l->optype == ASQL_OP_AGGREGATE) {
+		rv = local_aggregate(l, &recs, (as_list*)&arglist, &sb, &total);
+		n_calls = 1;
+		max_ns = total.cpu_ns;
+	}
+	else {
+		rv = local_execute(l, &recs, (as_list*)&arglist, &sb, &total,
+				&max_ns);
+		n_calls = recs.size;
+	}
+
+	as_arraylist_destroy(&arglist);
+
+	if (rv != 0) {
+		goto CLEANUP;
+	}
+
+	// Per record, so a stream and a record UDF compare on the same terms.
+	double avg_us = (double)total.cpu_ns / recs.size / 1000;
+	char msg[512];
+	int len = snprintf(msg, sizeof(msg),
+			"%u record(s), %u call(s), CPU avg %.1f us/record, max %.1f us/call, output %u bytes",
+			recs.size, n_calls, avg_us, (double)max_ns / 1000,
+			total.out_bytes);
+
+	uint64_t objects = 0;
+
+	if (l->ns && asql_set_object_count(c, l->ns, l->set, &objects, &err)
+			== AEROSPIKE_OK && objects > 0) {
+		len += snprintf(msg + len, sizeof(msg) - len,
+				", est. %.1f s CPU for %" PRIu64 " records in %s%s%s",
+				avg_us * objects / 1000000, objects, l->ns,
+				l->set ? "." : "", l->set ? l->set : "");
+	}
+
+	if (total.heap >= 0) {
+		len += snprintf(msg + len, sizeof(msg) - len,
+				", heap retained %" PRId64 " bytes", total.heap);
+	}
+
+	if (sb.writes || sb.removes) {
+		snprintf(msg + len, sizeof(msg) - len,
+				", %u write(s) and %u remove(s) not applied", sb.writes,
+				sb.removes);
+	}
+
+	g_renderer->render_ok(msg, NULL);
+
+CLEANUP:
+	for (uint32_t i = 0; i < recs.size; i++) {
+		as_record_destroy(as_vector_get_ptr(&recs, i));
+	}
+	as_vector_destroy(&recs);
+	return rv;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+static as_status
+load_keys(asql_config* c, as_error* err, local_config* l, as_vector* recs)
+{
+	as_policy_read read_policy;
+	as_policy_read_copy(&g_aerospike->config.policies.read, &read_policy);
+	asql_policy_base_init(c, &read_policy.base);
+
+	for (uint32_t i = 0; i < l->keys->size; i++) {
+		as_key key;
+		if (key_init(err, &key, l->ns, l->set, as_vector_get(l->keys, i))) {
+			return err->code;
+		}
+
+		as_record* rec = NULL;
+		as_status status = aerospike_key_get(g_aerospike, err, &read_policy,
+				&key, &rec);
+		as_key_destroy(&key);
+
+		if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+			as_error_reset(err);
+			continue;
+		}
+
+		if (status != AEROSPIKE_OK) {
+			return status;
+		}
+		as_vector_append(recs, &rec);
+	}
+	return AEROSPIKE_OK;
+}
+
+static bool
+sample_cb(const as_val* val, void* udata)
+{
+	if (!val) {
+		return true;
+	}
+
+	local_sample_udata* su = (local_sample_udata*)udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (!rec) {
+		return true;
+	}
+
+	pthread_mutex_lock(&su->lock);
+
+	if (su->recs->size < su->max) {
+		// The record and its bins live in the client's parse buffer, gone
+		// once the callback returns.
+		as_serializer ser;
+		as_msgpack_init(&ser);
+
+		as_record* copy = record_copy(rec, &ser);
+		as_vector_append(su->recs, &copy);
+		as_serializer_destroy(&ser);
+	}
+
+	bool more = su->recs->size < su->max;
+	pthread_mutex_unlock(&su->lock);
+
+	return more && !g_interrupted;
+}
+
+static as_status
+load_sample(asql_config* c, as_error* err, local_config* l, as_vector* recs)
+{
+	if (strlen(l->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Namespace name is too long: '%s'", l->ns);
+	}
+
+	if (l->set && strlen(l->set) >= AS_SET_MAX_SIZE) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Set name is too long: '%s'", l->set);
+	}
+
+	as_policy_scan scan_policy;
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
+	scan_policy.max_records = l->sample;
+
+	as_scan scan;
+	as_scan_init(&scan, l->ns, l->set);
+
+	local_sample_udata su = { .recs = recs, .max = l->sample };
+	pthread_mutex_init(&su.lock, NULL);
+
+	as_status status = aerospike_scan_foreach(g_aerospike, err, &scan_policy,
+			&scan, sample_cb, &su);
+
+	// The callback stops the scan once the sample is full.
+	if (status == AEROSPIKE_ERR_CLIENT_ABORT) {
+		as_error_reset(err);
+		status = AEROSPIKE_OK;
+	}
+
+	pthread_mutex_destroy(&su.lock);
+	as_scan_destroy(&scan);
+	return status;
+}
+
+static bool
+map_to_record_cb(const as_val* k, const as_val* v, void* udata)
+{
+	as_record* rec = (as_record*)udata;
+	as_string* name = as_string_fromval(k);
+
+	if (!name || as_string_len(name) >= AS_BIN_NAME_MAX_SIZE) {
+		return false;
+	}
+
+	as_val_reserve(v);
+
+	if (!as_record_set(rec, as_string_get(name), (as_bin_value*)v)) {
+		as_val_destroy(v);
+		return false;
+	}
+	return true;
+}
+
+static as_status
+load_file(as_error* err, const char* path, as_vector* recs)
+{
+	FILE* fp = fopen(path, "r");
+
+	if (!fp) {
+		return as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Unable to open file: '%s'", path);
+	}
+
+	char* line = NULL;
+	size_t cap = 0;
+	ssize_t len;
+	uint32_t line_no = 0;
+
+	while ((len = getline(&line, &cap, fp)) != -1) {
+		line_no++;
+
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+			line[--len] = '\0';
+		}
+
+		if (len == 0) {
+			continue;
+		}
+
+		as_val* val = as_json_arg(line, ASQL_VALUE_TYPE_MAP);
+		as_map* map = as_map_fromval(val);
+
+		if (!map) {
+			as_val_destroy(val);
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"%s:%u: expected one JSON object of bins per line", path,
+					line_no);
+			break;
+		}
+
+		as_record* rec = as_record_new((uint16_t)as_map_size(map));
+		bool ok = as_map_foreach(map, map_to_record_cb, rec);
+		as_map_destroy(map);
+
+		if (!ok) {
+			as_record_destroy(rec);
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"%s:%u: bin names must be strings shorter than %d characters",
+					path, line_no, AS_BIN_NAME_MAX_SIZE);
+			break;
+		}
+		as_vector_append(recs, &rec);
+	}
+
+	free(line);
+	fclose(fp);
+	return err->code;
+}
+
+// One call per record, one row per call.
+static int
+local_execute(local_config* l, as_vector* recs, as_list* args,
+		local_sandbox* sb, local_cost* total, uint64_t* max_ns)
+{
+	as_aerospike as;
+	as_aerospike_init(&as, sb, &sandbox_hooks);
+	as_udf_context ctx = { .as = &as, .timer = NULL, .memtracker = NULL };
+
+	as_serializer ser;
+	as_msgpack_init(&ser);
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), 6);
+	const char* names[] = { "record", "cpu_us", "heap_bytes", "output_bytes",
+			"result" };
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		as_vector_append(&cols, &names[i]);
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	int rv = 0;
+
+	for (uint32_t i = 0; i < recs->size && !g_interrupted; i++) {
+		as_record* rec = as_vector_get_ptr(recs, i);
+
+		as_result res;
+		as_result_init(&res);
+
+		int64_t heap = heap_in_use();
+		uint64_t start = thread_cpu_ns();
+		int ret = as_module_apply_record(&mod_lua, &ctx, l->u.udfpkg,
+				l->u.udfname, (as_rec*)rec, args, &res);
+		uint64_t cpu_ns = thread_cpu_ns() - start;
+
+		if (heap >= 0) {
+			heap = heap_in_use() - heap;
+		}
+
+		if (ret != 0 || !res.is_success) {
+			char msg[512];
+			as_string* s = res.value ? as_string_fromval(res.value) : NULL;
+
+			snprintf(msg, sizeof(msg),
+					"%s.%s failed in the local Lua runtime on record %u: %s",
+					l->u.udfpkg, l->u.udfname, i + 1,
+					s ? as_string_get(s) : "unknown error");
+			g_renderer->render_error(AEROSPIKE_ERR_UDF, msg, rview);
+			as_result_destroy(&res);
+			rv = 1;
+			break;
+		}
+
+		uint32_t out_bytes = res.value ?
+				as_serializer_serialize_getsize(&ser, res.value) : 0;
+
+		total->cpu_ns += cpu_ns;
+		total->out_bytes += out_bytes;
+
+		if (total->heap >= 0 && heap > 0) {
+			total->heap += heap;
+		}
+		total->n_out++;
+
+		if (cpu_ns > *max_ns) {
+			*max_ns = cpu_ns;
+		}
+
+		as_hashmap m;
+		as_hashmap_init(&m, 8);
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("record"),
+				(as_val*)as_integer_new(i + 1));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("cpu_us"),
+				(as_val*)as_integer_new((int64_t)(cpu_ns / 1000)));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("heap_bytes"),
+				heap >= 0 ? (as_val*)as_integer_new(heap) :
+						(as_val*)as_string_new_strdup("n/a"));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("output_bytes"),
+				(as_val*)as_integer_new(out_bytes));
+
+		if (res.value) {
+			as_val_reserve(res.value);
+			as_hashmap_set(&m, (as_val*)as_string_new_strdup("result"),
+					res.value);
+		}
+
+		g_renderer->render((as_val*)&m, rview);
+		as_hashmap_destroy(&m);
+		as_result_destroy(&res);
+	}
+
+	if (rv == 0) {
+		g_renderer->render(NULL, rview);
+	}
+
+	g_renderer->view_destroy(rview);
+	as_vector_destroy(&cols);
+	as_serializer_destroy(&ser);
+	as_aerospike_destroy(&as);
+	return rv;
+}
+
+// The whole sample goes through the stream in one call, as it would on one
+// node, outputs render as AGGREGATE results do.
+static int
+local_aggregate(local_config* l, as_vector* recs, as_list* args,
+		local_sandbox* sb, local_cost* total)
+{
+	as_aerospike as;
+	as_aerospike_init(&as, sb, &sandbox_hooks);
+	as_udf_context ctx = { .as = &as, .timer = NULL, .memtracker = NULL };
+
+	as_vector out;
+	as_vector_init(&out, sizeof(as_val*), 16);
+
+	local_stream_data data = { .recs = recs, .next = 0, .out = &out };
+	as_msgpack_init(&data.ser);
+
+	as_stream istream;
+	as_stream_init(&istream, &data, &istream_hooks);
+
+	as_stream ostream;
+	as_stream_init(&ostream, &data, &ostream_hooks);
+
+	as_result res;
+	as_result_init(&res);
+
+	// On a server, records enter the stream in server scope. The client
+	// scope only runs the final reduce over the nodes' partial results.
+	lua_server_mode(true);
+
+	int64_t heap = heap_in_use();
+	uint64_t start = thread_cpu_ns();
+	int ret = as_module_apply_stream(&mod_lua, &ctx, l->u.udfpkg,
+			l->u.udfname, &istream, args, &ostream, &res);
+	total->cpu_ns = thread_cpu_ns() - start;
+
+	if (heap >= 0) {
+		heap = heap_in_use() - heap;
+	}
+
+	lua_server_mode(false);
+
+	int rv = 0;
+
+	if (ret != 0) {
+		char msg[512];
+		as_string* s = res.value ? as_string_fromval(res.value) : NULL;
+
+		snprintf(msg, sizeof(msg), "%s.%s failed in the local Lua runtime: %s",
+				l->u.udfpkg, l->u.udfname,
+				s ? as_string_get(s) : "unknown error");
+		g_renderer->render_error(AEROSPIKE_ERR_UDF, msg, NULL);
+		rv = 1;
+	}
+	else {
+		total->out_bytes = data.out_bytes;
+		total->n_out = out.size;
+
+		void* rview = g_renderer->view_new(CLUSTER);
+
+		if (out.size > 0) {
+			g_renderer->render_values(l->u.udfname, (as_val**)out.list,
+					out.size, rview);
+		}
+		g_renderer->render(NULL, rview);
+		g_renderer->view_destroy(rview);
+
+		if (heap >= 0) {
+			total->heap = heap;
+		}
+	}
+
+	for (uint32_t i = 0; i < out.size; i++) {
+		as_val_destroy(as_vector_get_ptr(&out, i));
+	}
+
+	as_vector_destroy(&out);
+	as_result_destroy(&res);
+	as_serializer_destroy(&data.ser);
+	as_stream_destroy(&istream);
+	as_stream_destroy(&ostream);
+	as_aerospike_destroy(&as);
+	return rv;
+}
+
+static void
+lua_server_mode(bool server_mode)
+{
+	mod_lua_config config = {
+		.server_mode = server_mode,
+		.cache_enabled = false,
+		.user_path = { 0 }
+	};
+
+	if (g_config->base.lua_userpath) {
+		strncpy_and_strip_quotes(config.user_path, g_config->base.lua_userpath,
+				sizeof(config.user_path));
+	}
+	as_module_configure(&mod_lua, &config);
+}
+
+// Bins are copied through msgpack, which also copies nested lists and maps.
+static as_record*
+record_copy(const as_record* src, as_serializer* ser)
+{
+	as_record* rec = as_record_new(src->bins.size);
+	rec->gen = src->gen;
+	rec->ttl = src->ttl;
+
+	// Only the digest, the user key value may point into the source.
+	rec->key = src->key;
+	rec->key.valuep = NULL;
+	rec->key._free = false;
+
+	for (uint16_t i = 0; i < src->bins.size; i++) {
+		as_bin* bin = &src->bins.entries[i];
+		as_val* val = NULL;
+
+		as_buffer buf;
+		as_buffer_init(&buf);
+
+		if (as_serializer_serialize(ser, (as_val*)bin->valuep, &buf) == 0) {
+			as_serializer_deserialize(ser, &buf, &val);
+		}
+		as_buffer_destroy(&buf);
+
+		as_record_set(rec, bin->name,
+				val ? (as_bin_value*)val : (as_bin_value*)&as_nil);
+	}
+	return rec;
+}
+
+static uint64_t
+thread_cpu_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+// Bytes in use on the process heap. Lua allocates through realloc(), so the
+// difference across a call is what the call kept.
+static int64_t
+heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 mi = mallinfo2();
+	return (int64_t)(mi.uordblks + mi.hblkhd);
+#else
+	return -1;
+#endif
+}
+
+static int
+sandbox_rec_write(const as_aerospike* as, const as_rec* r)
+{
+	((local_sandbox*)as->source)->writes++;
+	return 0;
+}
+
+static int
+sandbox_rec_remove(const as_aerospike* as, const as_rec* r)
+{
+	((local_sandbox*)as->source)->removes++;
+	return 0;
+}
+
+static int
+sandbox_rec_exists(const as_aerospike* as, const as_rec* r)
+{
+	return 1;
+}
+
+static int
+sandbox_log(const as_aerospike* as, const char* file, const int line,
+		const int level, const char* msg)
+{
+	// UDF output follows the aql log level, as on a server it follows the
+	// server's.
+	switch (level) {
+		case AS_LOG_LEVEL_ERROR:
+			as_log_error("%s:%d %s", file, line, msg);
+			break;
+		case AS_LOG_LEVEL_WARN:
+			as_log_warn("%s:%d %s", file, line, msg);
+			break;
+		case AS_LOG_LEVEL_INFO:
+			as_log_info("%s:%d %s", file, line, msg);
+			break;
+		default:
+			as_log_debug("%s:%d %s", file, line, msg);
+			break;
+	}
+	return 0;
+}
+
+static as_val*
+stream_read(const as_stream* s)
+{
+	local_stream_data* data = (local_stream_data*)as_stream_source(s);
+
+	if (data->next >= data->recs->size || g_interrupted) {
+		return NULL;
+	}
+
+	// The stream owns what it reads.
+	as_record* rec = as_vector_get_ptr(data->recs, data->next++);
+	as_val_reserve(rec);
+	return (as_val*)rec;
+}
+
+static as_stream_status
+stream_write(const as_stream* s, as_val* v)
+{
+	if (!v) {
+		return AS_STREAM_OK;
+	}
+
+	local_stream_data* data = (local_stream_data*)as_stream_source(s);
+	data->out_bytes += as_serializer_serialize_getsize(&data->ser, v);
+	as_vector_append(data->out, &v);
+	return AS_STREAM_OK;
+}
@@ -19,6 +19,7 @@
 // Includes.
 //
 
+#include <ctype.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -26,10 +27,12 @@
 #include <aerospike/as_string_builder.h>
 
 #include <asql.h>
+#include <asql_arena.h>
 #include <asql_tokenizer.h>
 #include <asql_conf.h>
 #include <asql_info.h>
 #include <asql_key.h>
+#include <asql_local.h>
 #include <asql_print.h>
 #include <asql_query.h>
 #include <asql_scan.h>
@@ -46,6 +49,9 @@
 
 extern void destroy_vector(as_vector* list, bool is_name);
 extern int destroy_aconfig(aconfig* ac);
+extern void destroy_projections(as_vector* projs);
+extern void destroy_cdt_path(as_vector* path);
+extern void destroy_expr(asql_expr* expr);
 
 void strncpy_and_strip_quotes(char* to, const char* from, size_t size);
 static bool is_quoted_literal(char* s);
@@ -59,9 +65,24 @@ static bool parse_value_list(tokenizer* tknzr, as_vector* v);
 static bool parse_ns_and_set(tokenizer* tknzr, char** ns, char** set);
 static bool parse_name_list(tokenizer* tknzr, as_vector* v, bool allow_empty);
 static bool parse_pkey(tokenizer* tknzr, asql_value* value);
-static bool parse_naked_name_list(tokenizer* tknzr, as_vector* v);
+static bool parse_pkey_list(tokenizer* tknzr, as_vector* keys);
+static bool parse_update_list(tokenizer* tknzr, as_vector* uops);
+static void free_update_ops(as_vector* uops);
+static aconfig* parse_update_target(tokenizer* tknzr, asql_optype optype,
+		asql_name ns, asql_name set, update_param* up);
+static aconfig* parse_insert_select(tokenizer* tknzr, asql_name ns,
+		asql_name set);
+static bool parse_select_list(tokenizer* tknzr, select_param* s);
+static bool parse_meta_list(tokenizer* tknzr, as_vector* bnames);
+static asql_expr* parse_select_expr(tokenizer* tknzr);
+static asql_expr* parse_select_term(tokenizer* tknzr);
+static asql_expr* parse_select_factor(tokenizer* tknzr);
+static bool parse_cdt_step(tokenizer* tknzr, asql_cdt_step* step);
+static bool parse_slice_bound(const char* s, int64_t* bound, bool* has);
 static bool parse_skey(tokenizer* tknzr, asql_where* where, asql_where **where2);
 static bool parse_in(tokenizer* tknzr, asql_name* itype);
+static bool parse_timestamp(const char* tok, int64_t* ns);
+static bool parse_interval(const char* tok, uint32_t* ms);
 static char* parse_module(tokenizer* tknzr, bool filename_only);
 static char* parse_module_pathname(tokenizer* tknzr);
 static char* parse_module_filename(tokenizer* tknzr);
@@ -69,6 +90,8 @@ static int parse_cast_expression(tokenizer* tknzr, asql_value* value);
 static int parse_type_expression(tokenizer* tknzr, asql_value* value, asql_value_type_t vtype);
 
 static aconfig* parse_query(tokenizer* tknzr, int type);
+static aconfig* parse_local(tokenizer* tknzr, int type, asql_name udfpkg,
+		asql_name udfname, as_vector* params);
 static aconfig* parse_show_info(tokenizer* tknzr);
 
 //=========================================================
@@ -126,6 +149,11 @@ aql_parse_insert(tokenizer* tknzr)
 		goto ERROR;
 	}
 
+	if (!strcasecmp(tknzr->tok, "SELECT")) {
+		// Takes ownership of ns and set.
+		return parse_insert_select(tknzr, ns, set);
+	}
+
 	bnames = as_vector_create(sizeof(asql_name), 5);
 	if (!parse_name_list(tknzr, bnames, true)) {
 		goto ERROR;
@@ -174,7 +202,7 @@ aql_parse_insert(tokenizer* tknzr)
 	// first value is PK
 	memcpy(&p->key, as_vector_get(values, 0), sizeof(asql_value));
 	as_vector_remove(values, 0);
-	free(as_vector_get_ptr(bnames, 0));
+	asql_stmt_free(as_vector_get_ptr(bnames, 0));
 	as_vector_remove(bnames, 0);
 
 
@@ -191,8 +219,8 @@ aql_parse_insert(tokenizer* tknzr)
 
 ERROR:
 	predicting_parse_error(tknzr);
-	if (ns) free(ns);
-	if (set) free(set);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
 
 	if (bnames) {
 		destroy_vector(bnames, true);
@@ -252,8 +280,8 @@ aql_parse_delete(tokenizer* tknzr)
 
 ERROR:
 	predicting_parse_error(tknzr);
-	if (ns) free(ns);
-	if (set) free(set);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
 	return NULL;
 }
 
@@ -263,6 +291,291 @@ aql_parse_execute(tokenizer* tknzr)
 	return parse_query(tknzr, ASQL_OP_EXECUTE);
 }
 
+aconfig*
+aql_parse_update(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+	update_param up = { .ops = NULL };
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
+	else if (!tknzr->tok) {
+		goto ERROR;
+	}
+
+	if (strcasecmp(tknzr->tok, "SET")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	up.ops = as_vector_create(sizeof(asql_update_op), 4);
+	// consumes one extra token.
+	if (!parse_update_list(tknzr, up.ops)) {
+		goto ERROR;
+	}
+
+	// Takes ownership of ns, set and up.
+	return parse_update_target(tknzr, ASQL_OP_UPDATE, ns, set, &up);
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	free_update_ops(up.ops);
+	return NULL;
+}
+
+aconfig*
+aql_parse_touch(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+	update_param up = { .ops = NULL };
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
+	else if (!tknzr->tok) {
+		goto ERROR;
+	}
+
+	// TTL <seconds>
+	if (strcasecmp(tknzr->tok, "TTL")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	asql_value ttl;
+	if (parse_value(tknzr->tok, &ttl) != 0) {
+		goto ERROR;
+	}
+
+	if (ttl.type != AS_INTEGER || ttl.u.i64 < -2 || ttl.u.i64 > UINT32_MAX) {
+		asql_free_value(&ttl);
+		goto ERROR;
+	}
+
+	// -1 never expires, -2 leaves the record's TTL unchanged.
+	up.has_ttl = true;
+	up.ttl = (uint32_t)ttl.u.i64;
+
+	asql_update_op op;
+	bzero(&op, sizeof(asql_update_op));
+	op.type = ASQL_UPDATE_OP_TOUCH;
+	up.ops = as_vector_create(sizeof(asql_update_op), 1);
+	as_vector_append(up.ops, &op);
+
+	get_next_token(tknzr);
+
+	// Takes ownership of ns, set and up.
+	return parse_update_target(tknzr, ASQL_OP_TOUCH, ns, set, &up);
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	free_update_ops(up.ops);
+	return NULL;
+}
+
+aconfig*
+aql_parse_truncate(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+	int64_t before = 0;
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		get_next_token(tknzr);
+	}
+
+	// BEFORE '<timestamp>', only records last updated before it.
+	if (tknzr->tok) {
+		if (strcasecmp(tknzr->tok, "BEFORE")) {
+			goto ERROR;
+		}
+
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (!parse_timestamp(tknzr->tok, &before)) {
+			g_renderer->render_error(-1,
+					"BEFORE expects 'YYYY-MM-DDThh:mm:ssZ' (UTC) or seconds since epoch",
+					NULL);
+			goto ERROR;
+		}
+
+		get_next_token(tknzr);
+		if (tknzr->tok) {
+			goto ERROR;
+		}
+	}
+
+	scan_config* s = malloc(sizeof(scan_config));
+	bzero(s, sizeof(scan_config));
+	s->optype = ASQL_OP_TRUNCATE;
+	s->type = SCAN_OP;
+	s->ns = ns;
+	s->set = set;
+	s->before = before;
+	return (aconfig*)s;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	return NULL;
+}
+
+// COMPARE <ns>[.<set>] WITH HOST '<host>[:<port>]'
+aconfig*
+aql_parse_compare(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
+	else if (!tknzr->tok) {
+		goto ERROR;
+	}
+
+	if (strcasecmp(tknzr->tok, "WITH")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (strcasecmp(tknzr->tok, "HOST")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!is_quoted_literal(tknzr->tok)) {
+		goto ERROR;
+	}
+
+	size_t len = strlen(tknzr->tok) + 1;
+	char* host = malloc(len);
+	strncpy_and_strip_quotes(host, tknzr->tok, len);
+
+	get_next_token(tknzr);
+	if (tknzr->tok) {
+		free(host);
+		goto ERROR;
+	}
+
+	scan_config* s = malloc(sizeof(scan_config));
+	bzero(s, sizeof(scan_config));
+	s->optype = ASQL_OP_COMPARE;
+	s->type = SCAN_OP;
+	s->ns = ns;
+	s->set = set;
+	s->host = host;
+	return (aconfig*)s;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	return NULL;
+}
+
+// SCAN NODES <ns>[.<set>]
+aconfig*
+aql_parse_scan(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (strcasecmp(tknzr->tok, "NODES")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		get_next_token(tknzr);
+	}
+
+	if (tknzr->tok) {
+		goto ERROR;
+	}
+
+	scan_config* s = malloc(sizeof(scan_config));
+	bzero(s, sizeof(scan_config));
+	s->optype = ASQL_OP_SCAN;
+	s->type = SCAN_OP;
+	s->ns = ns;
+	s->set = set;
+	return (aconfig*)s;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	return NULL;
+}
+
+// PROFILE <ns>[.<set>]
+aconfig*
+aql_parse_profile(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		get_next_token(tknzr);
+	}
+
+	if (tknzr->tok) {
+		goto ERROR;
+	}
+
+	scan_config* s = malloc(sizeof(scan_config));
+	bzero(s, sizeof(scan_config));
+	s->optype = ASQL_OP_PROFILE;
+	s->type = SCAN_OP;
+	s->ns = ns;
+	s->set = set;
+	return (aconfig*)s;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	return NULL;
+}
+
 aconfig*
 aql_parse_select(tokenizer* tknzr)
 {
@@ -311,6 +624,55 @@ aql_parse_aggregate(tokenizer* tknzr)
 	return parse_query(tknzr, ASQL_OP_AGGREGATE);
 }
 
+aconfig*
+aql_parse_tail(tokenizer* tknzr)
+{
+	asql_name ns = NULL;
+	asql_name set = NULL;
+	uint32_t interval_ms = 5000;
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ns, &set)) {
+		goto ERROR;
+	}
+
+	if (set) {
+		get_next_token(tknzr);
+	}
+
+	// INTERVAL <n>[ms|s|m]
+	if (tknzr->tok) {
+		if (strcasecmp(tknzr->tok, "INTERVAL")) {
+			goto ERROR;
+		}
+
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (!parse_interval(tknzr->tok, &interval_ms)) {
+			goto ERROR;
+		}
+
+		get_next_token(tknzr);
+		if (tknzr->tok) {
+			goto ERROR;
+		}
+	}
+
+	scan_config* s = malloc(sizeof(scan_config));
+	bzero(s, sizeof(scan_config));
+	s->optype = ASQL_OP_TAIL;
+	s->type = SCAN_OP;
+	s->ns = ns;
+	s->set = set;
+	s->interval_ms = interval_ms;
+	return (aconfig*)s;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	return NULL;
+}
+
 aconfig*
 aql_parse_desc(tokenizer* tknzr)
 {
@@ -358,29 +720,211 @@ aql_parse_removeudf(tokenizer* tknzr)
 	return (aconfig*)i;
 }
 
+// CREATE [LIST|MAPKEYS|MAPVALUES] INDEX <name> ON <ns>[.<set>] (<bin>)
+//     NUMERIC|STRING|GEO2DSPHERE|BLOB [CTX <path>] [WAIT]
 aconfig*
-aql_parse_run(tokenizer* tknzr)
+aql_parse_create(tokenizer* tknzr)
 {
-	asql_name fname = NULL;
-	GET_NEXT_TOKEN_OR_GOTO(ERROR);
+	index_param* ip = malloc(sizeof(index_param));
+	bzero(ip, sizeof(index_param));
+	ip->itype = AS_INDEX_TYPE_DEFAULT;
 
-	if (!parse_name(tknzr->tok, &fname, false)) {
-		goto ERROR;
-	}
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
 
-	runfile_config* r = malloc(sizeof(runfile_config));
-	r->optype = ASQL_OP_RUN;
-	r->type = RUNFILE_OP;
-	r->fname = fname;
-	return (aconfig*)r;
+	if (!strcasecmp(tknzr->tok, "LIST")) {
+		ip->itype = AS_INDEX_TYPE_LIST;
+	}
+	else if (!strcasecmp(tknzr->tok, "MAPKEYS")) {
+		ip->itype = AS_INDEX_TYPE_MAPKEYS;
+	}
+	else if (!strcasecmp(tknzr->tok, "MAPVALUES")) {
+		ip->itype = AS_INDEX_TYPE_MAPVALUES;
+	}
 
-ERROR:
-	predicting_parse_error(tknzr);
+	if (ip->itype != AS_INDEX_TYPE_DEFAULT) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
 
-	if (fname) free(fname);
+	if (strcasecmp(tknzr->tok, "INDEX")) {
+		goto ERROR;
+	}
 
-	return NULL;
-}
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_name(tknzr->tok, &ip->iname, false)) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (strcasecmp(tknzr->tok, "ON")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ip->ns, &ip->set)) {
+		goto ERROR;
+	}
+
+	if (ip->set) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
+
+	if (!tknzr->tok || strcmp(tknzr->tok, "(")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_name(tknzr->tok, &ip->bname, false)) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (strcmp(tknzr->tok, ")")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!strcasecmp(tknzr->tok, "NUMERIC")) {
+		ip->dtype = AS_INDEX_NUMERIC;
+	}
+	else if (!strcasecmp(tknzr->tok, "STRING")) {
+		ip->dtype = AS_INDEX_STRING;
+	}
+	else if (!strcasecmp(tknzr->tok, "GEO2DSPHERE")) {
+		ip->dtype = AS_INDEX_GEO2DSPHERE;
+	}
+	else if (!strcasecmp(tknzr->tok, "BLOB")) {
+		ip->dtype = AS_INDEX_BLOB;
+	}
+	else {
+		goto ERROR;
+	}
+
+	get_next_token(tknzr);
+
+	// CTX ['key'][0]..., the path inside the bin that is indexed.
+	if (tknzr->tok && !strcasecmp(tknzr->tok, "CTX")) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+
+		ip->ctx = as_vector_create(sizeof(asql_cdt_step), 2);
+
+		while (tknzr->tok && !strcmp(tknzr->tok, "[")) {
+			asql_cdt_step step;
+			bzero(&step, sizeof(asql_cdt_step));
+
+			if (!parse_cdt_step(tknzr, &step)
+					|| step.type == ASQL_CDT_STEP_RANGE) {
+				asql_free_value(&step.key);
+				goto ERROR;
+			}
+
+			as_vector_append(ip->ctx, &step);
+			get_next_token(tknzr);
+		}
+
+		if (ip->ctx->size == 0) {
+			goto ERROR;
+		}
+	}
+
+	if (tknzr->tok && !strcasecmp(tknzr->tok, "WAIT")) {
+		ip->wait = true;
+		get_next_token(tknzr);
+	}
+
+	if (tknzr->tok) {
+		goto ERROR;
+	}
+
+	info_config* i = asql_info_config_create(ASQL_OP_CREATE,
+			strdup("sindex-create"), NULL, true);
+	i->index = ip;
+	return (aconfig*)i;
+
+ERROR:
+	predicting_parse_error(tknzr);
+
+	if (ip->ns) asql_stmt_free(ip->ns);
+	if (ip->set) asql_stmt_free(ip->set);
+	if (ip->iname) asql_stmt_free(ip->iname);
+	if (ip->bname) asql_stmt_free(ip->bname);
+	destroy_cdt_path(ip->ctx);
+	free(ip);
+
+	return NULL;
+}
+
+// DROP INDEX <ns>[.<set>] <name>
+aconfig*
+aql_parse_drop(tokenizer* tknzr)
+{
+	index_param* ip = malloc(sizeof(index_param));
+	bzero(ip, sizeof(index_param));
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (strcasecmp(tknzr->tok, "INDEX")) {
+		goto ERROR;
+	}
+
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	if (!parse_ns_and_set(tknzr, &ip->ns, &ip->set)) {
+		goto ERROR;
+	}
+
+	if (ip->set) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+	}
+	else if (!tknzr->tok) {
+		goto ERROR;
+	}
+
+	if (!parse_name(tknzr->tok, &ip->iname, false)) {
+		goto ERROR;
+	}
+
+	get_next_token(tknzr);
+	if (tknzr->tok) {
+		goto ERROR;
+	}
+
+	info_config* i = asql_info_config_create(ASQL_OP_DROP,
+			strdup("sindex-delete"), NULL, true);
+	i->index = ip;
+	return (aconfig*)i;
+
+ERROR:
+	predicting_parse_error(tknzr);
+
+	if (ip->ns) asql_stmt_free(ip->ns);
+	if (ip->set) asql_stmt_free(ip->set);
+	if (ip->iname) asql_stmt_free(ip->iname);
+	free(ip);
+
+	return NULL;
+}
+
+aconfig*
+aql_parse_run(tokenizer* tknzr)
+{
+	asql_name fname = NULL;
+	GET_NEXT_TOKEN_OR_GOTO(ERROR);
+
+	if (!parse_name(tknzr->tok, &fname, false)) {
+		goto ERROR;
+	}
+
+	runfile_config* r = malloc(sizeof(runfile_config));
+	r->optype = ASQL_OP_RUN;
+	r->type = RUNFILE_OP;
+	r->fname = fname;
+	return (aconfig*)r;
+
+ERROR:
+	predicting_parse_error(tknzr);
+
+	if (fname) asql_stmt_free(fname);
+
+	return NULL;
+}
 
 aconfig*
 aql_parserun_set(tokenizer* tknzr)
@@ -531,7 +1075,7 @@ parse_name(char* s, asql_name* name, bool allow_empty)
 
 	if (len < 2)
 	{
-		*name = strdup(s);
+		*name = asql_stmt_strdup(s);
 		return true;
 	}
 
@@ -541,7 +1085,7 @@ parse_name(char* s, asql_name* name, bool allow_empty)
 		// Empty string
 		if (len == 2) {
 			if (allow_empty) {
-				*name = strdup("");
+				*name = asql_stmt_strdup("");
 				return true;
 			} else {
 				return false;
@@ -549,14 +1093,14 @@ parse_name(char* s, asql_name* name, bool allow_empty)
 		}
 
 		// trim quotes
-		char* str = malloc(len - 1);
+		char* str = asql_stmt_malloc(len - 1);
 		memcpy(str, s + 1, len - 2);
 		str[len - 2] = 0;
 		*name = str;
 		return true;
 	}
 
-	*name = strdup(s);
+	*name = asql_stmt_strdup(s);
 	return true;
 }
 
@@ -601,7 +1145,7 @@ parse_value(char* s, asql_value* value)
 	        && ((*s == '\'' && s[len - 1] == '\'')
 	                || (*s == '\"' && s[len - 1] == '\"'))) {
 		value->type = AS_STRING;
-		char* str = malloc(len - 1);
+		char* str = asql_stmt_malloc(len - 1);
 		memcpy(str, s + 1, len - 2);
 		str[len - 2] = 0;
 		value->u.str = str;
@@ -613,7 +1157,7 @@ parse_value(char* s, asql_value* value)
 	        && ((*s == '\'' && s[len - 1] == '\'')
 	                || (*s == '\"' && s[len - 1] == '\"'))) {
 		value->type = AS_STRING;
-		value->u.str = strdup("");
+		value->u.str = asql_stmt_strdup("");
 		return 0;
 	}
 
@@ -758,57 +1302,823 @@ parse_name_list(tokenizer* tknzr, as_vector* v, bool allow_empty)
 	}
 }
 
+// Parse "INSERT INTO <ns>[.<set>] SELECT ..." starting at SELECT. The source
+// is parsed as a regular SELECT, which must be a scan or a query.
+static aconfig*
+parse_insert_select(tokenizer* tknzr, asql_name ns, asql_name set)
+{
+	aconfig* ac = parse_query(tknzr, ASQL_OP_SELECT);
+
+	if (!ac) {
+		asql_stmt_free(ns);
+		asql_stmt_free(set);
+		return NULL;
+	}
+
+	select_param* sel = NULL;
+	copy_param* into = NULL;
+
+	if (ac->type == SCAN_OP) {
+		sel = &((scan_config*)ac)->s;
+		into = &((scan_config*)ac)->into;
+	}
+	else if (ac->type == SECONDARY_INDEX_OP) {
+		sel = &((sk_config*)ac)->s;
+		into = &((sk_config*)ac)->into;
+	}
+
+	if (!into || sel->count || sel->exists || sel->header) {
+		g_renderer->render_error(-1,
+				"INSERT ... SELECT copies bins from a scan or a secondary index query",
+				NULL);
+		destroy_aconfig(ac);
+		asql_stmt_free(ns);
+		asql_stmt_free(set);
+		return NULL;
+	}
+
+	ac->optype = ASQL_OP_INSERT;
+	into->ns = ns;
+	into->set = set;
+	return ac;
+}
+
+// Parse a SELECT list. Each column is a bin, a CDT path into a bin or a
+// computed expression:
+//   <bin>[<index>], <bin>[<beg>:<end>], <bin>['<key>'] ... [AS <name>]
+//   <expr> AS <name>
+// Column names go to s->bnames. s->projs is only created when a path or an
+// expression is used, so plain bin lists keep the existing select code path.
+// Consumes one extra token.
 static bool
-parse_naked_name_list(tokenizer* tknzr, as_vector* v)
+parse_select_list(tokenizer* tknzr, select_param* s)
 {
+	as_vector* projs = as_vector_create(sizeof(asql_projection), 8);
+	bool has_projs = false;
+
 	while (1) {
+		asql_expr* node = parse_select_expr(tknzr);
+
+		if (!node || !tknzr->tok) {
+			destroy_expr(node);
+			goto ERROR;
+		}
+
+		asql_projection proj = { .bname = NULL, .path = NULL, .expr = NULL };
+
+		if (node->type == ASQL_EXPR_BIN) {
+			proj.bname = node->bname;
+			proj.path = node->path;
+			node->bname = NULL;
+			node->path = NULL;
+			destroy_expr(node);
+		}
+		else {
+			proj.expr = node;
+		}
+
+		as_vector_append(projs, &proj);
 		asql_name name = NULL;
 
-		if (!parse_name(tknzr->tok, &name, true)) {
-			return false;
+		if (!strcasecmp(tknzr->tok, "AS")) {
+			if (!proj.path && !proj.expr) {
+				g_renderer->render_error(-1,
+						"AS is only supported on CDT paths and expressions",
+						NULL);
+				goto ERROR;
+			}
+
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			if (!parse_name(tknzr->tok, &name, false)) {
+				goto ERROR;
+			}
+
+			GET_NEXT_TOKEN_OR_GOTO(NAME_ERROR)
+		}
+		else if (proj.expr) {
+			g_renderer->render_error(-1,
+					"Computed columns must be named with AS <name>", NULL);
+			goto ERROR;
+		}
+		else {
+			name = strdup(proj.bname);
+		}
+
+		if (proj.path || proj.expr) {
+			has_projs = true;
+		}
+
+		for (uint32_t i = 0; i < s->bnames->size; i++) {
+			if (!strcmp(as_vector_get_ptr(s->bnames, i), name)) {
+				char err_msg[1024];
+				snprintf(err_msg, sizeof(err_msg),
+						"Duplicate column '%s', use AS <name> to rename it",
+						name);
+				g_renderer->render_error(-1, err_msg, NULL);
+				goto NAME_ERROR;
+			}
+		}
+
+		as_vector_append(s->bnames, &name);
+
+		if (strcmp(tknzr->tok, ",")) {
+			break;
+		}
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		continue;
+
+NAME_ERROR:
+		asql_stmt_free(name);
+		goto ERROR;
+	}
+
+	if (has_projs) {
+		s->projs = projs;
+	}
+	else {
+		destroy_projections(projs);
+	}
+	return true;
+
+ERROR:
+	destroy_projections(projs);
+	return false;
+}
+
+// Parse a list of record metadata columns, {ttl} and {gen}. They are served
+// from the record header so no bin data is read.
+// Consumes one extra token.
+static bool
+parse_meta_list(tokenizer* tknzr, as_vector* bnames)
+{
+	while (1) {
+		const char* col = NULL;
+
+		if (!strcasecmp(tknzr->tok, COL_NAME_META_TTL_NAME)) {
+			col = COL_NAME_META_TTL_NAME;
+		}
+		else if (!strcasecmp(tknzr->tok, COL_NAME_META_GEN_NAME)) {
+			col = COL_NAME_META_GEN_NAME;
+		}
+		else {
+			g_renderer->render_error(-1,
+					"Only {ttl} and {gen} are supported as metadata columns and they cannot be mixed with bins",
+					NULL);
+			return false;
+		}
+
+		for (uint32_t i = 0; i < bnames->size; i++) {
+			if (!strcmp(as_vector_get_ptr(bnames, i), col)) {
+				g_renderer->render_error(-1, "Duplicate metadata column", NULL);
+				return false;
+			}
+		}
+
+		asql_name name = strdup(col);
+		as_vector_append(bnames, &name);
+
+		GET_NEXT_TOKEN_OR_RETURN(false)
+		if (strcmp(tknzr->tok, ",")) {
+			break;
+		}
+		GET_NEXT_TOKEN_OR_RETURN(false)
+	}
+	return true;
+}
+
+static asql_expr*
+new_expr(asql_expr_type type)
+{
+	asql_expr* e = malloc(sizeof(asql_expr));
+	bzero(e, sizeof(asql_expr));
+	e->type = type;
+	return e;
+}
+
+static asql_expr*
+new_binary_expr(asql_expr_type type, asql_expr* left, asql_expr* right)
+{
+	if ((left->type == ASQL_EXPR_BIN && left->path)
+			|| (right->type == ASQL_EXPR_BIN && right->path)) {
+		g_renderer->render_error(-1,
+				"CDT paths are not supported inside expressions", NULL);
+		destroy_expr(left);
+		destroy_expr(right);
+		return NULL;
+	}
+
+	asql_expr* e = new_expr(type);
+	e->left = left;
+	e->right = right;
+	return e;
+}
+
+// <term> { (+|-) <term> }
+// Bin names may contain '-', so subtraction needs surrounding spaces. A
+// signed literal such as "+5" arrives as a single token and is added.
+// Consumes one extra token.
+static asql_expr*
+parse_select_expr(tokenizer* tknzr)
+{
+	asql_expr* left = parse_select_term(tknzr);
+
+	while (left && tknzr->tok) {
+		char* tok = tknzr->tok;
+		asql_expr_type type;
+
+		if (!strcmp(tok, "+") || !strcmp(tok, "-")) {
+			type = (tok[0] == '+') ? ASQL_EXPR_ADD : ASQL_EXPR_SUB;
+			get_next_token(tknzr);
+		}
+		else if ((tok[0] == '+' || tok[0] == '-') && tok[1]) {
+			// Signed literal, parsed with its sign as the next term.
+			type = ASQL_EXPR_ADD;
+		}
+		else {
+			break;
+		}
+
+		if (!tknzr->tok) {
+			destroy_expr(left);
+			return NULL;
+		}
+
+		asql_expr* right = parse_select_term(tknzr);
+		if (!right) {
+			destroy_expr(left);
+			return NULL;
+		}
+		left = new_binary_expr(type, left, right);
+	}
+	return left;
+}
+
+// <factor> { (*|/) <factor> }
+// Consumes one extra token.
+static asql_expr*
+parse_select_term(tokenizer* tknzr)
+{
+	asql_expr* left = parse_select_factor(tknzr);
+
+	while (left && tknzr->tok
+			&& (!strcmp(tknzr->tok, "*") || !strcmp(tknzr->tok, "/"))) {
+		asql_expr_type type = !strcmp(tknzr->tok, "*")
+				? ASQL_EXPR_MUL : ASQL_EXPR_DIV;
+
+		get_next_token(tknzr);
+		if (!tknzr->tok) {
+			destroy_expr(left);
+			return NULL;
+		}
+
+		asql_expr* right = parse_select_factor(tknzr);
+		if (!right) {
+			destroy_expr(left);
+			return NULL;
+		}
+		left = new_binary_expr(type, left, right);
+	}
+	return left;
+}
+
+// <number> | ( <expr> ) | LIST_SIZE(<bin>) | MAP_SIZE(<bin>) | <bin>[path]
+// Consumes one extra token.
+static asql_expr*
+parse_select_factor(tokenizer* tknzr)
+{
+	asql_expr* e = NULL;
+	char* tok = tknzr->tok;
+
+	if (!strcmp(tok, "(")) {
+		get_next_token(tknzr);
+		if (!tknzr->tok) {
+			return NULL;
+		}
+
+		e = parse_select_expr(tknzr);
+		if (!e) {
+			return NULL;
+		}
+
+		if (!tknzr->tok || strcmp(tknzr->tok, ")")) {
+			destroy_expr(e);
+			return NULL;
+		}
+		get_next_token(tknzr);
+		return e;
+	}
+
+	char* peek = peek_next_token(tknzr);
+	bool is_call = peek && !strcmp(peek, "(");
+	free(peek);
+
+	// The peek moved the current token to a copy.
+	tok = tknzr->tok;
+
+	if (is_call) {
+		if (!strcasecmp(tok, "LIST_SIZE")) {
+			e = new_expr(ASQL_EXPR_LIST_SIZE);
+		}
+		else if (!strcasecmp(tok, "MAP_SIZE")) {
+			e = new_expr(ASQL_EXPR_MAP_SIZE);
+		}
+		else {
+			return NULL;
+		}
+
+		get_next_token(tknzr); // (
+		get_next_token(tknzr);
+		if (!tknzr->tok || !parse_name(tknzr->tok, &e->bname, false)) {
+			destroy_expr(e);
+			return NULL;
+		}
+
+		get_next_token(tknzr);
+		if (!tknzr->tok || strcmp(tknzr->tok, ")")) {
+			destroy_expr(e);
+			return NULL;
+		}
+		get_next_token(tknzr);
+		return e;
+	}
+
+	if (isdigit(tok[0]) || tok[0] == '.'
+			|| ((tok[0] == '+' || tok[0] == '-') && tok[1])) {
+		asql_value value;
+		bzero(&value, sizeof(asql_value));
+
+		if (parse_value(tok, &value) == 0
+				&& (value.type == AS_INTEGER || value.type == AS_DOUBLE)) {
+			e = new_expr(ASQL_EXPR_VALUE);
+			e->value = value;
+			get_next_token(tknzr);
+			return e;
+		}
+		asql_free_value(&value);
+		// Not a number, may still be a bin name.
+	}
+
+	e = new_expr(ASQL_EXPR_BIN);
+
+	if (!parse_name(tok, &e->bname, true)) {
+		destroy_expr(e);
+		return NULL;
+	}
+
+	get_next_token(tknzr);
+
+	while (tknzr->tok && !strcmp(tknzr->tok, "[")) {
+		if (!e->path) {
+			e->path = as_vector_create(sizeof(asql_cdt_step), 2);
+		}
+
+		asql_cdt_step step;
+		bzero(&step, sizeof(asql_cdt_step));
+
+		if (!parse_cdt_step(tknzr, &step)) {
+			asql_free_value(&step.key);
+			destroy_expr(e);
+			return NULL;
+		}
+
+		// A slice yields a list, nothing can be addressed below it.
+		if (e->path->size
+				&& ((asql_cdt_step*)as_vector_get(e->path,
+						e->path->size - 1))->type == ASQL_CDT_STEP_RANGE) {
+			asql_free_value(&step.key);
+			destroy_expr(e);
+			return NULL;
+		}
+
+		as_vector_append(e->path, &step);
+		get_next_token(tknzr);
+	}
+	return e;
+}
+
+// Parse one "[...]" CDT path element. The lexer may split or merge slice
+// bounds and ':' (e.g. "1:-1" is a single token), so the tokens up to the
+// closing bracket are joined and split on ':' here.
+static bool
+parse_cdt_step(tokenizer* tknzr, asql_cdt_step* step)
+{
+	char buf[256];
+	buf[0] = '\0';
+
+	GET_NEXT_TOKEN_OR_RETURN(false)
+
+	if (is_quoted_literal(tknzr->tok)) {
+		if (parse_value(tknzr->tok, &step->key) != 0) {
+			return false;
+		}
+		step->type = ASQL_CDT_STEP_KEY;
+
+		GET_NEXT_TOKEN_OR_RETURN(false)
+		return !strcmp(tknzr->tok, "]");
+	}
+
+	while (strcmp(tknzr->tok, "]")) {
+		if (strlen(buf) + strlen(tknzr->tok) >= sizeof(buf)) {
+			return false;
+		}
+		strcat(buf, tknzr->tok);
+		GET_NEXT_TOKEN_OR_RETURN(false)
+	}
+
+	char* colon = strchr(buf, ':');
+
+	if (!colon) {
+		step->type = ASQL_CDT_STEP_INDEX;
+		return parse_slice_bound(buf, &step->beg, &step->has_beg)
+				&& step->has_beg;
+	}
+
+	*colon = '\0';
+	step->type = ASQL_CDT_STEP_RANGE;
+
+	if (!parse_slice_bound(buf, &step->beg, &step->has_beg)
+			|| !parse_slice_bound(colon + 1, &step->end, &step->has_end)) {
+		return false;
+	}
+
+	// The count of a [beg:end] slice is only known up front when both bounds
+	// count from the same end of the list.
+	if (step->has_beg && step->has_end
+			&& ((step->beg < 0) != (step->end < 0))) {
+		g_renderer->render_error(-1,
+				"Slice bounds must both be non-negative or both be negative",
+				NULL);
+		return false;
+	}
+	return true;
+}
+
+static bool
+parse_slice_bound(const char* s, int64_t* bound, bool* has)
+{
+	if (!*s) {
+		*has = false;
+		return true;
+	}
+
+	char* endptr = NULL;
+	*bound = strtoll(s, &endptr, 10);
+	*has = true;
+	return *endptr == '\0';
+}
+
+static bool
+parse_pkey(tokenizer* tknzr, asql_value* value)
+{
+	asql_value_type_t vt = ASQL_VALUE_TYPE_NONE;
+	if (!strcasecmp(tknzr->tok, "DIGEST")) {
+		vt = ASQL_VALUE_TYPE_DIGEST;
+	}
+	else if (!strcasecmp(tknzr->tok, "EDIGEST")) {
+		vt = ASQL_VALUE_TYPE_EDIGEST;
+	}
+	else if (!strcasecmp(tknzr->tok, "PK")) {
+		vt = ASQL_VALUE_TYPE_NONE;
+	}
+	else {
+		return false;
+	}
+
+	GET_NEXT_TOKEN_OR_RETURN(false)
+	if (strcmp(tknzr->tok, "=")) {
+		return false;
+	}
+
+	GET_NEXT_TOKEN_OR_RETURN(false)
+	if (parse_value(tknzr->tok, value) != 0) {
+		return false;
+	}
+
+	if (vt != ASQL_VALUE_TYPE_NONE) {
+		value->vt = vt;
+	}
+	return true;
+}
+
+// Parse "PK IN (<key>, <key>, ...)"
+static bool
+parse_pkey_list(tokenizer* tknzr, as_vector* keys)
+{
+	if (strcasecmp(tknzr->tok, "PK")) {
+		return false;
+	}
+
+	GET_NEXT_TOKEN_OR_RETURN(false)
+	if (strcasecmp(tknzr->tok, "IN")) {
+		return false;
+	}
+
+	GET_NEXT_TOKEN_OR_RETURN(false)
+	if (!parse_value_list(tknzr, keys) || keys->size == 0) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < keys->size; i++) {
+		asql_value* key = as_vector_get(keys, i);
+
+		if (key->type != AS_STRING && key->type != AS_INTEGER) {
+			return false;
+		}
+
+		if (key->type == AS_STRING && !key->u.str) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Parse the assignment list of an UPDATE statement:
+//   <bin> = <value>
+//   <bin> = <bin> (+|-) <number>
+//   <bin> = CONCAT(<bin>, <string>)
+//   <bin> = APPEND(<bin>, <value>)
+//   <bin> = MAP_PUT(<bin>, <key>, <value>)
+// Consumes one extra token.
+static bool
+parse_update_list(tokenizer* tknzr, as_vector* uops)
+{
+	while (1) {
+		asql_update_op op;
+		bzero(&op, sizeof(asql_update_op));
+
+		if (!parse_name(tknzr->tok, &op.bname, false)) {
+			return false;
+		}
+
+		// Append first so the caller frees the name on error.
+		as_vector_append(uops, &op);
+		asql_update_op* uop = as_vector_get(uops, uops->size - 1);
+
+		GET_NEXT_TOKEN_OR_RETURN(false)
+		if (strcmp(tknzr->tok, "=")) {
+			return false;
+		}
+
+		GET_NEXT_TOKEN_OR_RETURN(false)
+
+		char* peek = peek_next_token(tknzr);
+		bool is_call = peek && !strcmp(peek, "(");
+		bool is_self = peek && !is_call && !strcmp(tknzr->tok, uop->bname);
+		free(peek);
+
+		// Bin names may contain '-', so "a-1" lexes as one identifier. Read
+		// it as a decrement when it is the assigned bin followed by -<int>.
+		size_t blen = strlen(uop->bname);
+		bool is_decr = !is_call && !is_self
+				&& !strncmp(tknzr->tok, uop->bname, blen)
+				&& tknzr->tok[blen] == '-' && tknzr->tok[blen + 1]
+				&& strspn(tknzr->tok + blen + 1, "0123456789")
+						== strlen(tknzr->tok + blen + 1);
+
+		if (is_call) {
+			if (!strcasecmp(tknzr->tok, "CONCAT")) {
+				uop->type = ASQL_UPDATE_OP_CONCAT;
+			}
+			else if (!strcasecmp(tknzr->tok, "APPEND")) {
+				uop->type = ASQL_UPDATE_OP_LIST_APPEND;
+			}
+			else if (!strcasecmp(tknzr->tok, "MAP_PUT")) {
+				uop->type = ASQL_UPDATE_OP_MAP_PUT;
+			}
+			else {
+				// Type cast expression.
+				if (parse_expression(tknzr, &uop->value) != 0) {
+					return false;
+				}
+				uop->type = ASQL_UPDATE_OP_WRITE;
+				goto NEXT;
+			}
+
+			GET_NEXT_TOKEN_OR_RETURN(false) // (
+			GET_NEXT_TOKEN_OR_RETURN(false)
+
+			// The function target must be the assigned bin.
+			asql_name target = NULL;
+			if (!parse_name(tknzr->tok, &target, false)) {
+				return false;
+			}
+
+			bool match = !strcmp(target, uop->bname);
+			asql_stmt_free(target);
+
+			if (!match) {
+				g_renderer->render_error(-1,
+						"Update function must operate on the assigned bin", NULL);
+				return false;
+			}
+
+			GET_NEXT_TOKEN_OR_RETURN(false)
+			if (strcmp(tknzr->tok, ",")) {
+				return false;
+			}
+
+			if (uop->type == ASQL_UPDATE_OP_MAP_PUT) {
+				GET_NEXT_TOKEN_OR_RETURN(false)
+				if (parse_expression(tknzr, &uop->key) != 0) {
+					return false;
+				}
+
+				GET_NEXT_TOKEN_OR_RETURN(false)
+				if (strcmp(tknzr->tok, ",")) {
+					return false;
+				}
+			}
+
+			GET_NEXT_TOKEN_OR_RETURN(false)
+			if (parse_expression(tknzr, &uop->value) != 0) {
+				return false;
+			}
+
+			if (uop->type == ASQL_UPDATE_OP_CONCAT
+					&& (uop->value.type != AS_STRING || !uop->value.u.str)) {
+				return false;
+			}
+
+			GET_NEXT_TOKEN_OR_RETURN(false)
+			if (strcmp(tknzr->tok, ")")) {
+				return false;
+			}
+		}
+		else if (is_decr) {
+			if (parse_value(tknzr->tok + blen, &uop->value) != 0
+					|| uop->value.type != AS_INTEGER) {
+				return false;
+			}
+			uop->type = ASQL_UPDATE_OP_INCR;
+		}
+		else if (is_self) {
+			// <bin> = <bin> + <number>
+			GET_NEXT_TOKEN_OR_RETURN(false)
+
+			bool negate = false;
+			if (!strcmp(tknzr->tok, "+") || !strcmp(tknzr->tok, "-")) {
+				negate = !strcmp(tknzr->tok, "-");
+				GET_NEXT_TOKEN_OR_RETURN(false)
+			}
+			else if (tknzr->tok[0] != '+' && tknzr->tok[0] != '-') {
+				return false;
+			}
+
+			if (parse_value(tknzr->tok, &uop->value) != 0) {
+				return false;
+			}
+
+			if (uop->value.type == AS_INTEGER) {
+				uop->value.u.i64 = negate ? -uop->value.u.i64 : uop->value.u.i64;
+			}
+			else if (uop->value.type == AS_DOUBLE) {
+				uop->value.u.dbl = negate ? -uop->value.u.dbl : uop->value.u.dbl;
+			}
+			else {
+				asql_free_value(&uop->value);
+				bzero(&uop->value, sizeof(asql_value));
+				return false;
+			}
+			uop->type = ASQL_UPDATE_OP_INCR;
+		}
+		else {
+			if (!strcasecmp(tknzr->tok, "NULL")) {
+				// NULL deletes the bin.
+				uop->value.type = AS_NIL;
+			}
+			else if (parse_expression(tknzr, &uop->value) != 0) {
+				return false;
+			}
+			uop->type = ASQL_UPDATE_OP_WRITE;
 		}
 
-		as_vector_append(v, &name);
-		GET_NEXT_TOKEN_OR_RETURN(false)
+NEXT:
+		GET_NEXT_TOKEN_OR_RETURN(true)
 		if (strcmp(tknzr->tok, ",")) {
 			return true;
 		}
 		GET_NEXT_TOKEN_OR_RETURN(false)
 	}
-	return true;
 }
 
-static bool
-parse_pkey(tokenizer* tknzr, asql_value* value)
+static void
+free_update_ops(as_vector* uops)
 {
-	asql_value_type_t vt = ASQL_VALUE_TYPE_NONE;
-	if (!strcasecmp(tknzr->tok, "DIGEST")) {
-		vt = ASQL_VALUE_TYPE_DIGEST;
+	if (!uops) {
+		return;
 	}
-	else if (!strcasecmp(tknzr->tok, "EDIGEST")) {
-		vt = ASQL_VALUE_TYPE_EDIGEST;
+
+	for (uint32_t i = 0; i < uops->size; i++) {
+		asql_update_op* op = as_vector_get(uops, i);
+		asql_stmt_free(op->bname);
+		asql_free_value(&op->key);
+		asql_free_value(&op->value);
 	}
-	else if (!strcasecmp(tknzr->tok, "PK")) {
-		vt = ASQL_VALUE_TYPE_NONE;
+	as_vector_destroy(uops);
+}
+
+// Parse the optional WHERE clause of UPDATE and TOUCH. Without WHERE the
+// operations run as a set-wide background scan job, a secondary index
+// predicate turns it into a background query job and a primary key
+// predicate into a foreground operate call.
+static aconfig*
+parse_update_target(tokenizer* tknzr, asql_optype optype, asql_name ns,
+		asql_name set, update_param* up)
+{
+	asql_name itype = NULL;
+
+	if (!tknzr->tok) {
+		scan_config* s = malloc(sizeof(scan_config));
+		bzero(s, sizeof(scan_config));
+		s->optype = optype;
+		s->type = SCAN_OP;
+		s->ns = ns;
+		s->set = set;
+		s->up = *up;
+		return (aconfig*)s;
 	}
-	else {
-		return false;
+
+	if (!parse_in(tknzr, &itype)) {
+		goto ERROR;
 	}
 
-	GET_NEXT_TOKEN_OR_RETURN(false)
-	if (strcmp(tknzr->tok, "=")) {
-		return false;
+	if (strcasecmp(tknzr->tok, "WHERE")) {
+		goto ERROR;
 	}
 
-	GET_NEXT_TOKEN_OR_RETURN(false)
-	if (parse_value(tknzr->tok, value) != 0) {
-		return false;
+	GET_NEXT_TOKEN_OR_GOTO(ERROR)
+
+	if (!strcasecmp(tknzr->tok, "PK")
+			|| !strcasecmp(tknzr->tok, "EDIGEST")
+			|| !strcasecmp(tknzr->tok, "DIGEST")) {
+		if (itype) {
+			goto ERROR;
+		}
+
+		pk_config* p = malloc(sizeof(pk_config));
+		bzero(p, sizeof(pk_config));
+		p->optype = optype;
+		p->type = PRIMARY_INDEX_OP;
+		p->op = UPDATE_OP;
+		p->ns = ns;
+		p->set = set;
+		p->up = *up;
+
+		char* peek = peek_next_token(tknzr);
+		bool is_in = (peek && !strcasecmp(tknzr->tok, "PK")
+				&& !strcasecmp(peek, "IN"));
+		free(peek);
+
+		if (is_in) {
+			p->keys = as_vector_create(sizeof(asql_value), 8);
+			if (!parse_pkey_list(tknzr, p->keys)) {
+				destroy_aconfig((aconfig*)p);
+				predicting_parse_error(tknzr);
+				return NULL;
+			}
+		}
+		else if (!parse_pkey(tknzr, &p->key)) {
+			destroy_aconfig((aconfig*)p);
+			predicting_parse_error(tknzr);
+			return NULL;
+		}
+		return (aconfig*)p;
 	}
 
-	if (vt != ASQL_VALUE_TYPE_NONE) {
-		value->vt = vt;
+	sk_config* s = malloc(sizeof(sk_config));
+	bzero(s, sizeof(sk_config));
+	s->optype = optype;
+	s->type = SECONDARY_INDEX_OP;
+	s->ns = ns;
+	s->set = set;
+	s->up = *up;
+	s->itype = itype;
+
+	if (!parse_skey(tknzr, &s->where, &s->where2) || s->where2) {
+		if (s->where2) {
+			fprintf(stderr, "Unsupported command format\n");
+			fprintf(stderr, "Double where clause not supported for background jobs.\n");
+		}
+		else {
+			predicting_parse_error(tknzr);
+		}
+		destroy_aconfig((aconfig*)s);
+		return NULL;
 	}
-	return true;
+
+	GET_NEXT_TOKEN_OR_RETURN((aconfig*)s)
+
+	predicting_parse_error(tknzr);
+	destroy_aconfig((aconfig*)s);
+	return NULL;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	if (itype) asql_stmt_free(itype);
+	free_update_ops(up->ops);
+	return NULL;
 }
 
 static bool
@@ -985,7 +2295,7 @@ parse_module(tokenizer* tknzr, bool filename_only)
 		}
 
 		as_string_destroy(&string_filename);
-		free(pfile);
+		asql_stmt_free(pfile);
 
 		return filename;
 	}
@@ -1129,6 +2439,90 @@ parse_limit(tokenizer* tknzr, asql_value **value)
 	return true;
 }
 
+// Parse '<YYYY-MM-DD>[T<hh:mm:ss>][Z]' in UTC, or seconds since the Unix
+// epoch, into nanoseconds since the epoch (the unit of last-update-time).
+static bool
+parse_timestamp(const char* tok, int64_t* ns)
+{
+	char buf[64];
+	size_t len = strlen(tok);
+
+	if (len >= sizeof(buf)) {
+		return false;
+	}
+
+	if (len >= 2 && (tok[0] == '\'' || tok[0] == '"') && tok[len - 1] == tok[0]) {
+		memcpy(buf, tok + 1, len - 2);
+		buf[len - 2] = '\0';
+	}
+	else {
+		memcpy(buf, tok, len + 1);
+	}
+
+	char* end = NULL;
+	long long secs = strtoll(buf, &end, 10);
+
+	if (end != buf && *end == '\0') {
+		if (secs <= 0) {
+			return false;
+		}
+		*ns = (int64_t)secs * 1000000000L;
+		return true;
+	}
+
+	struct tm tm;
+	bzero(&tm, sizeof(struct tm));
+
+	end = strptime(buf, "%Y-%m-%d", &tm);
+	if (!end) {
+		return false;
+	}
+
+	if (*end == 'T' || *end == ' ') {
+		end = strptime(end + 1, "%H:%M:%S", &tm);
+		if (!end) {
+			return false;
+		}
+	}
+
+	if (*end == 'Z') {
+		end++;
+	}
+
+	if (*end) {
+		return false;
+	}
+
+	*ns = (int64_t)timegm(&tm) * 1000000000L;
+	return true;
+}
+
+// Parse an interval, <n>ms, <n>s, <n>m or <n> seconds.
+static bool
+parse_interval(const char* tok, uint32_t* ms)
+{
+	char* end = NULL;
+	unsigned long n = strtoul(tok, &end, 10);
+
+	if (end == tok || n == 0) {
+		return false;
+	}
+
+	if (!strcasecmp(end, "ms")) {
+		*ms = (uint32_t)n;
+	}
+	else if (!*end || !strcasecmp(end, "s")) {
+		*ms = (uint32_t)n * 1000;
+	}
+	else if (!strcasecmp(end, "m")) {
+		*ms = (uint32_t)n * 60 * 1000;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
 static aconfig* parse_query(tokenizer* tknzr, int type)
 {
 	asql_name ns = NULL;
@@ -1140,13 +2534,53 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 	as_vector* bnames = NULL;
 	as_vector* params = NULL;
 	asql_value* limit = NULL;
+	char* node = NULL;
+	select_param sel = { .bnames = NULL, .projs = NULL, .count = false,
+			.exists = false, .header = false };
 
 	if (type == ASQL_OP_SELECT) {
 		GET_NEXT_TOKEN_OR_GOTO(ERROR)
-		if (strcmp(tknzr->tok, "*")) {
-			bnames = as_vector_create(sizeof(asql_name), 5);
+
+		char* peek = peek_next_token(tknzr);
+		sel.count = peek && !strcasecmp(tknzr->tok, "COUNT")
+				&& !strcmp(peek, "(");
+		sel.exists = peek && !strcasecmp(tknzr->tok, "EXISTS")
+				&& !strcasecmp(peek, "FROM");
+		free(peek);
+
+		if (sel.count) {
+			// COUNT(*)
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			if (strcmp(tknzr->tok, "*")) {
+				goto ERROR;
+			}
+
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			if (strcmp(tknzr->tok, ")")) {
+				goto ERROR;
+			}
+
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		}
+		else if (sel.exists) {
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		}
+		else if (tknzr->tok[0] == '{') {
+			// {ttl}, {gen}
+			sel.bnames = as_vector_create(sizeof(asql_name), 2);
+			bnames = sel.bnames;
+			sel.header = true;
+			// consumes one extra token.
+			if (!parse_meta_list(tknzr, sel.bnames)) {
+				goto ERROR;
+			}
+		}
+		else if (strcmp(tknzr->tok, "*")) {
+			sel.bnames = as_vector_create(sizeof(asql_name), 5);
+			bnames = sel.bnames;
 			// consumes one extra token.
-			if (!parse_naked_name_list(tknzr, bnames)) {
+			if (!parse_select_list(tknzr, &sel)) {
 				goto ERROR;
 			}
 		}
@@ -1161,6 +2595,17 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 	}
 	else {
 		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+
+		// LOCAL <pkg>.<fn>(...), unless LOCAL is itself the package name.
+		char* peek = peek_next_token(tknzr);
+		bool local = peek && !strcasecmp(tknzr->tok, "LOCAL")
+				&& strcmp(peek, ".");
+		free(peek);
+
+		if (local) {
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		}
+
 		if (!parse_name(tknzr->tok, &udfpkg, false)) {
 			goto ERROR;
 		}
@@ -1182,8 +2627,12 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 			goto ERROR;
 		}
 
-		// ON
 		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (local) {
+			return parse_local(tknzr, type, udfpkg, udfname, params);
+		}
+
+		// ON
 		if (strcasecmp(tknzr->tok, "ON")) {
 			goto ERROR;
 		}
@@ -1196,6 +2645,40 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 	if (set)
 		get_next_token(tknzr);
 
+	// SINCE '<timestamp>', filters on last-update-time.
+	if (tknzr->tok && type == ASQL_OP_SELECT
+			&& !strcasecmp(tknzr->tok, "SINCE")) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (!parse_timestamp(tknzr->tok, &sel.since)) {
+			g_renderer->render_error(-1,
+					"SINCE expects 'YYYY-MM-DDThh:mm:ssZ' (UTC) or seconds since epoch",
+					NULL);
+			goto ERROR;
+		}
+		get_next_token(tknzr);
+	}
+
+	// ON NODE '<node-id>', scans that node only.
+	if (tknzr->tok && type == ASQL_OP_SELECT
+			&& !strcasecmp(tknzr->tok, "ON")) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (strcasecmp(tknzr->tok, "NODE")) {
+			goto ERROR;
+		}
+
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		size_t len = strlen(tknzr->tok) + 1;
+		node = malloc(len);
+		strncpy_and_strip_quotes(node, tknzr->tok, len);
+
+		if (sel.count) {
+			g_renderer->render_error(-1,
+					"COUNT(*) is not supported with ON NODE", NULL);
+			goto ERROR;
+		}
+		get_next_token(tknzr);
+	}
+
 	// SCAN Operations
 	if (tknzr->tok && !strcasecmp(tknzr->tok, "LIMIT") && !parse_limit(tknzr, &limit))
 		goto ERROR;
@@ -1203,14 +2686,22 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 		get_next_token(tknzr);
 
 	if (!tknzr->tok) {
+		if (sel.exists) {
+			g_renderer->render_error(-1,
+					"EXISTS requires WHERE PK = <key> or WHERE PK IN (<key>, ...)",
+					NULL);
+			goto ERROR;
+		}
+
 		scan_config* s = malloc(sizeof(scan_config));
 		bzero(s, sizeof(scan_config));
 		s->optype = type;
 		s->type = SCAN_OP;
 		s->ns = ns;
 		s->set = set;
+		s->node = node;
 		if (type == ASQL_OP_SELECT) {
-			s->s.bnames = bnames;
+			s->s = sel;
 		}
 		else {
 			s->u.udfpkg = udfpkg;
@@ -1221,6 +2712,13 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 		return (aconfig*)s;
 	}
 
+	// Key lookups and index queries are routed by the client.
+	if (node) {
+		g_renderer->render_error(-1, "ON NODE is only supported on scans",
+				NULL);
+		goto ERROR;
+	}
+
 	if (!parse_in(tknzr, &itype)) {
 		goto ERROR;
 	}
@@ -1242,6 +2740,12 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 			goto ERROR;
 		}
 
+		if (sel.since) {
+			g_renderer->render_error(-1,
+					"SINCE is only supported on scans and queries", NULL);
+			goto ERROR;
+		}
+
 		// Parse primary key value.
 		pk_config* p = malloc(sizeof(pk_config));
 		bzero(p, sizeof(pk_config));
@@ -1251,7 +2755,7 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 		p->ns = ns;
 		p->set = set;
 		if (type == ASQL_OP_SELECT) {
-			p->s.bnames = bnames;
+			p->s = sel;
 		}
 		else {
 			p->u.udfpkg = udfpkg;
@@ -1259,7 +2763,20 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 			p->u.params = params;
 		}
 
-		if (!parse_pkey(tknzr, &p->key)) {
+		char* peek = peek_next_token(tknzr);
+		bool is_in = (type == ASQL_OP_SELECT && peek
+				&& !strcasecmp(tknzr->tok, "PK") && !strcasecmp(peek, "IN"));
+		free(peek);
+
+		if (is_in) {
+			p->keys = as_vector_create(sizeof(asql_value), 8);
+			if (!parse_pkey_list(tknzr, p->keys)) {
+				destroy_aconfig((aconfig*)p);
+				predicting_parse_error(tknzr);
+				return NULL;
+			}
+		}
+		else if (!parse_pkey(tknzr, &p->key)) {
 			destroy_aconfig((aconfig*)p);
 			predicting_parse_error(tknzr);
 			return NULL;
@@ -1268,6 +2785,13 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 		return (aconfig*)p;
 	}
 
+	if (sel.exists) {
+		g_renderer->render_error(-1,
+				"EXISTS requires WHERE PK = <key> or WHERE PK IN (<key>, ...)",
+				NULL);
+		goto ERROR;
+	}
+
 	sk_config* s = malloc(sizeof(sk_config));
 	bzero(s, sizeof(sk_config));
 	s->optype = type;
@@ -1275,7 +2799,7 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 	s->ns = ns;
 	s->set = set;
 	if (type == ASQL_OP_SELECT) {
-		s->s.bnames = bnames;
+		s->s = sel;
 	}
 	else {
 		s->u.udfpkg = udfpkg;
@@ -1325,18 +2849,21 @@ static aconfig* parse_query(tokenizer* tknzr, int type)
 ERROR:
 	predicting_parse_error(tknzr);
 
-	if (ns) free(ns);
-	if (set) free(set);
-	if (udfpkg) free(udfpkg);
-	if (udfname) free(udfname);
-	if (ibname) free(ibname);
-	if (itype) free(itype);
+	if (ns) asql_stmt_free(ns);
+	if (set) asql_stmt_free(set);
+	if (udfpkg) asql_stmt_free(udfpkg);
+	if (udfname) asql_stmt_free(udfname);
+	if (ibname) asql_stmt_free(ibname);
+	if (itype) asql_stmt_free(itype);
+	if (node) asql_stmt_free(node);
 
 	if (bnames) {
 		destroy_vector(bnames, true);
 		as_vector_destroy(bnames);
 	}
 
+	destroy_projections(sel.projs);
+
 	if (params) {
 		destroy_vector(params, false);
 		as_vector_destroy(params);
@@ -1347,6 +2874,90 @@ ERROR:
 	return NULL;
 }
 
+// Parse the rest of EXECUTE LOCAL / AGGREGATE LOCAL, starting at the token
+// after the argument list:
+//   ON <ns>[.<set>] [WHERE PK = <key> | WHERE PK IN (<key>, ...) | SAMPLE <n>]
+//   FILE '<path>'
+// Takes ownership of the UDF name and arguments.
+static aconfig*
+parse_local(tokenizer* tknzr, int type, asql_name udfpkg, asql_name udfname,
+		as_vector* params)
+{
+	local_config* l = malloc(sizeof(local_config));
+	bzero(l, sizeof(local_config));
+	l->type = LOCAL_OP;
+	l->optype = type;
+	l->u.udfpkg = udfpkg;
+	l->u.udfname = udfname;
+	l->u.params = params;
+	l->sample = LOCAL_SAMPLE_DEFAULT;
+
+	if (!strcasecmp(tknzr->tok, "FILE")) {
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		l->file = malloc(strlen(tknzr->tok) + 1);
+		strncpy_and_strip_quotes(l->file, tknzr->tok, strlen(tknzr->tok) + 1);
+		get_next_token(tknzr);
+	}
+	else {
+		if (strcasecmp(tknzr->tok, "ON")) {
+			goto ERROR;
+		}
+
+		GET_NEXT_TOKEN_OR_GOTO(ERROR)
+		if (!parse_ns_and_set(tknzr, &l->ns, &l->set)) {
+			goto ERROR;
+		}
+		if (l->set) {
+			get_next_token(tknzr);
+		}
+
+		if (tknzr->tok && !strcasecmp(tknzr->tok, "WHERE")) {
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			l->keys = as_vector_create(sizeof(asql_value), 8);
+
+			char* peek = peek_next_token(tknzr);
+			bool is_in = peek && !strcasecmp(peek, "IN");
+			free(peek);
+
+			if (is_in) {
+				if (!parse_pkey_list(tknzr, l->keys)) {
+					goto ERROR;
+				}
+			}
+			else {
+				asql_value key;
+				bzero(&key, sizeof(asql_value));
+				if (!parse_pkey(tknzr, &key)) {
+					asql_free_value(&key);
+					goto ERROR;
+				}
+				as_vector_append(l->keys, &key);
+			}
+			get_next_token(tknzr);
+		}
+		else if (tknzr->tok && !strcasecmp(tknzr->tok, "SAMPLE")) {
+			GET_NEXT_TOKEN_OR_GOTO(ERROR)
+			char* end = NULL;
+			long n = strtol(tknzr->tok, &end, 10);
+			if (*end || n <= 0) {
+				goto ERROR;
+			}
+			l->sample = (uint32_t)n;
+			get_next_token(tknzr);
+		}
+	}
+
+	if (tknzr->tok) {
+		goto ERROR;
+	}
+	return (aconfig*)l;
+
+ERROR:
+	predicting_parse_error(tknzr);
+	destroy_aconfig((aconfig*)l);
+	return NULL;
+}
+
 static aconfig*
 parse_show_info(tokenizer* tknzr)
 {
@@ -1365,6 +2976,17 @@ parse_show_info(tokenizer* tknzr)
 	        || !strcasecmp(tknzr->tok, "MODULES")) {
 		i = asql_info_config_create(ASQL_OP_SHOW, strdup("udf-list"), NULL, false);
 	}
+	else if (!strcasecmp(tknzr->tok, "INDEX")) {
+		GET_NEXT_TOKEN_OR_GOTO(show_error)
+		if (strcasecmp(tknzr->tok, "ADVICE")) {
+			goto show_error;
+		}
+		i = asql_info_config_create(ASQL_OP_SHOW, strdup("index-advice"), NULL, false);
+	}
+	else if (!strcasecmp(tknzr->tok, "POOL")
+			|| !strcasecmp(tknzr->tok, "POOLS")) {
+		i = asql_info_config_create(ASQL_OP_SHOW, strdup("pool-stats"), NULL, false);
+	}
 	else if (!strcasecmp(tknzr->tok, "INDEXES"))
 	{
 		get_next_token(tknzr);
@@ -1383,7 +3005,7 @@ parse_show_info(tokenizer* tknzr)
 
 			i = asql_info_config_create(ASQL_OP_SHOW, strdup(infocmd), NULL, false);
 
-			if (ns) free(ns);
+			if (ns) asql_stmt_free(ns);
 		}
 	}
 	else {
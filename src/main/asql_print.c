@@ -59,10 +59,17 @@ const print_entry print_table[ASQL_OP_MAX] = {
 	{ "EXPLAIN", print_query_help },
 	{ "INSERT", print_dml_help },
 	{ "DELETE", print_dml_help },
+	{ "UPDATE", print_dml_help },
+	{ "TOUCH", print_dml_help },
+	{ "TRUNCATE", print_dml_help },
 	{ "EXECUTE", print_dml_help },
 
 	{ "SELECT", print_query_help },
 	{ "AGGREGATE", print_query_help },
+	{ "TAIL", print_query_help },
+	{ "COMPARE", print_query_help },
+	{ "PROFILE", print_query_help },
+	{ "SCAN", print_query_help },
 
 	{ "SHOW", print_admin_help },
 	{ "DESC", print_admin_help },
@@ -73,7 +80,9 @@ const print_entry print_table[ASQL_OP_MAX] = {
 	{ "RESET", print_setting_help },
 
 	{ "REGISTER", print_ddl_help },
-	{ "REMOVE", print_ddl_help }
+	{ "REMOVE", print_ddl_help },
+	{ "CREATE", print_ddl_help },
+	{ "DROP", print_ddl_help }
 };
 
 
@@ -167,6 +176,21 @@ print_ddl_help()
 	fprintf(stdout, "          REGISTER MODULE '~/test.lua' \n");
 	fprintf(stdout, "          REMOVE MODULE test.lua\n");
 	fprintf(stdout, "      \n");
+	fprintf(stdout, "  MANAGE INDEXES\n");
+	fprintf(stdout, "      CREATE [LIST|MAPKEYS|MAPVALUES] INDEX <index> ON <ns>[.<set>] (<bin>) NUMERIC|STRING|GEO2DSPHERE|BLOB [CTX <path>] [WAIT]\n");
+	fprintf(stdout, "      DROP INDEX <ns>[.<set>] <index>\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          <path> is a sequence of [<list index>] and ['<map key>'] elements inside <bin>.\n");
+	fprintf(stdout, "          WAIT blocks until the index is readable on every node, printing per node build progress.\n");
+	fprintf(stdout, "          Without WAIT, queries on <bin> from this session wait for the build to finish.\n");
+	fprintf(stdout, "          Either wait gives up after INDEX_WAIT_TIMEOUT ms.\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "      Examples:\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          CREATE INDEX idx_age ON test.demo (age) NUMERIC WAIT\n");
+	fprintf(stdout, "          CREATE MAPKEYS INDEX idx_tags ON test.demo (profile) STRING CTX ['tags']\n");
+	fprintf(stdout, "          DROP INDEX test idx_age\n");
+	fprintf(stdout, "      \n");
 	fprintf(stdout, "      \n");
 }
 
@@ -175,13 +199,34 @@ print_dml_help()
 {
 	fprintf(stdout, "  DML\n");
 	fprintf(stdout, "      INSERT INTO <ns>[.<set>] (PK, <bins>) VALUES (<key>, <values>)\n");
+	fprintf(stdout, "      INSERT INTO <ns>[.<set>] SELECT <bins> FROM <ns>[.<set>] [WHERE <bin> = <value> | <bin> BETWEEN <lower> AND <upper>]\n");
 	fprintf(stdout, "      DELETE FROM <ns>[.<set>] WHERE PK = <key>\n");
+	fprintf(stdout, "      UPDATE <ns>[.<set>] SET <assignments> WHERE PK = <key>\n");
+	fprintf(stdout, "      UPDATE <ns>[.<set>] SET <assignments> WHERE PK IN (<key>, ...)\n");
+	fprintf(stdout, "      UPDATE <ns>[.<set>] SET <assignments> [WHERE <bin> = <value> | <bin> BETWEEN <lower> AND <upper>]\n");
+	fprintf(stdout, "      TOUCH <ns>[.<set>] TTL <seconds> [WHERE PK = <key> | <bin> = <value> | <bin> BETWEEN <lower> AND <upper>]\n");
+	fprintf(stdout, "      TRUNCATE <ns>[.<set>] [BEFORE '<timestamp>']\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "          <ns> is the namespace for the record.\n");
 	fprintf(stdout, "          <set> is the set name for the record.\n");
 	fprintf(stdout, "          <key> is the record's primary key.\n");
 	fprintf(stdout, "          <bins> is a comma-separated list of bin names.\n");
 	fprintf(stdout, "          <values> is comma-separated list of bin values, which may include type cast expressions. Set to NULL (case insensitive & w/o quotes) to delete the bin.\n");
+	fprintf(stdout, "          <assignments> is a comma-separated list of:\n");
+	fprintf(stdout, "              <bin> = <value>\n");
+	fprintf(stdout, "              <bin> = <bin> + <number>  (or -)\n");
+	fprintf(stdout, "              <bin> = CONCAT(<bin>, <string>)\n");
+	fprintf(stdout, "              <bin> = APPEND(<bin>, <value>)\n");
+	fprintf(stdout, "              <bin> = MAP_PUT(<bin>, <key>, <value>)\n");
+	fprintf(stdout, "          All assignments of an UPDATE are applied atomically in a single operation.\n");
+	fprintf(stdout, "          Without a primary key predicate UPDATE and TOUCH run as background scan or query jobs.\n");
+	fprintf(stdout, "          <seconds> is the new record TTL, -1 to never expire.\n");
+	fprintf(stdout, "          TRUNCATE removes all records, or those last updated before <timestamp> ('YYYY-MM-DDThh:mm:ssZ'\n");
+	fprintf(stdout, "              in UTC or seconds since epoch). It asks for confirmation on a terminal and waits up to 60 s\n");
+	fprintf(stdout, "              for the records to be gone. TRUNCATE ... BEFORE, and TRUNCATE in --serve and libaql\n");
+	fprintf(stdout, "              sessions, return once accepted.\n");
+	fprintf(stdout, "          INSERT ... SELECT streams records from a scan or query into batch writes, keeping keys and TTLs.\n");
+	fprintf(stdout, "              Records without a stored key can only be copied to a set of the same name.\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "        Type Cast Expression Formats:\n");
 	fprintf(stdout, "      \n");
@@ -209,7 +254,13 @@ print_dml_help()
 	fprintf(stdout, "          INSERT INTO test.demo (PK, foo, bar, baz) VALUES ('key1', CAST('123' AS INT), JSON('{\"a\": 1.2, \"b\": [1, 2, 3], \"c\": true}'), BOOL(1))\n");
 	fprintf(stdout, "          INSERT INTO test.demo (PK, foo, bar) VALUES ('key1', LIST('[1, 2, 3]'), MAP('{\"a\": 1, \"b\": 2}'), CAST(0 as BOOL))\n");
 	fprintf(stdout, "          INSERT INTO test.demo (PK, gj) VALUES ('key1', GEOJSON('{\"type\": \"Point\", \"coordinates\": [123.4, -56.7]}'))\n");
+	fprintf(stdout, "          INSERT INTO test.archive SELECT * FROM test.demo WHERE foo BETWEEN 0 AND 999\n");
 	fprintf(stdout, "          DELETE FROM test.demo WHERE PK = 'key1'\n");
+	fprintf(stdout, "          UPDATE test.demo SET foo = foo + 1, bar = CONCAT(bar, 'xyz'), baz = NULL WHERE PK = 'key1'\n");
+	fprintf(stdout, "          UPDATE test.demo SET l = APPEND(l, 5), m = MAP_PUT(m, 'a', 1) WHERE PK IN ('key1', 'key2')\n");
+	fprintf(stdout, "          UPDATE test.demo SET status = 'archived' WHERE age BETWEEN 0 AND 17\n");
+	fprintf(stdout, "          TOUCH test.demo TTL 86400\n");
+	fprintf(stdout, "          TRUNCATE test.demo BEFORE '2026-01-01T00:00:00Z'\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "  INVOKING UDFS\n");
 	fprintf(stdout, "      EXECUTE <module>.<function>(<args>) ON <ns>[.<set>]\n");
@@ -233,6 +284,24 @@ print_dml_help()
 	fprintf(stdout, "          EXECUTE myudfs.udf1(2) ON test.demo\n");
 	fprintf(stdout, "          EXECUTE myudfs.udf1(2) ON test.demo WHERE PK = 'key1'\n");
 	fprintf(stdout, "      \n");
+	fprintf(stdout, "  PROFILING UDFS LOCALLY\n");
+	fprintf(stdout, "      EXECUTE LOCAL <module>.<function>(<args>) ON <ns>[.<set>] [SAMPLE <n>]\n");
+	fprintf(stdout, "      EXECUTE LOCAL <module>.<function>(<args>) ON <ns>[.<set>] WHERE PK = <key>\n");
+	fprintf(stdout, "      EXECUTE LOCAL <module>.<function>(<args>) ON <ns>[.<set>] WHERE PK IN (<key>, ...)\n");
+	fprintf(stdout, "      EXECUTE LOCAL <module>.<function>(<args>) FILE '<path>'\n");
+	fprintf(stdout, "      AGGREGATE LOCAL <module>.<function>(<args>) ON <ns>[.<set>] [SAMPLE <n>]\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          Runs the UDF in aql's Lua runtime (LUA_USERPATH) against <n> sampled\n");
+	fprintf(stdout, "          records (default 100), the given keys, or one JSON object of bins per\n");
+	fprintf(stdout, "          line of <path>. Reports CPU time, heap retained and output size per\n");
+	fprintf(stdout, "          call, and estimates the CPU time for the whole set. Record writes are\n");
+	fprintf(stdout, "          counted, never applied.\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "      Examples:\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          EXECUTE LOCAL myudfs.udf1(2) ON test.demo SAMPLE 500\n");
+	fprintf(stdout, "          AGGREGATE LOCAL myudfs.udf2(2) FILE 'records.json'\n");
+	fprintf(stdout, "      \n");
 	fprintf(stdout, "      \n");
 }
 
@@ -245,10 +314,19 @@ print_query_help()
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] WHERE <bin> = <value> [and <bin2> = <value>] [limit <max-records>]\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] WHERE <bin> BETWEEN <lower> AND <upper> [limit <max-records>]\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] WHERE PK = <key>\n");
+	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] WHERE PK IN (<key>, <key>, ...)\n");
+	fprintf(stdout, "      SELECT EXISTS FROM <ns>[.<set>] WHERE PK = <key> | PK IN (<key>, <key>, ...)\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] IN <index-type> WHERE <bin> = <value>\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] IN <index-type> WHERE <bin> BETWEEN <lower> AND <upper>\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] IN <index-type> WHERE <bin> CONTAINS <GeoJSONPoint>\n");
 	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] IN <index-type> WHERE <bin> WITHIN <GeoJSONPolygon>\n");
+	fprintf(stdout, "      SELECT COUNT(*) FROM <ns>[.<set>] [WHERE ...]\n");
+	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] SINCE '<timestamp>' [WHERE ...] [limit <max-records>]\n");
+	fprintf(stdout, "      SELECT <bins> FROM <ns>[.<set>] ON NODE '<node-id>' [limit <max-records>]\n");
+	fprintf(stdout, "      SCAN NODES <ns>[.<set>]\n");
+	fprintf(stdout, "      TAIL <ns>[.<set>] [INTERVAL <interval>]\n");
+	fprintf(stdout, "      COMPARE <ns>[.<set>] WITH HOST '<host>[:<port>]'\n");
+	fprintf(stdout, "      PROFILE <ns>[.<set>]\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "          <ns> is the namespace for the records to be queried.\n");
 	fprintf(stdout, "          <set> is the set name for the record to be queried.\n");
@@ -258,16 +336,49 @@ print_query_help()
 	fprintf(stdout, "          <value> is the value of a bin. May be a \"string\" or an int.\n");
 	fprintf(stdout, "          <index-type> is the type of a index user wants to query. (LIST/MAPKEYS/MAPVALUES)\n");
 	fprintf(stdout, "          <bins> can be either a wildcard (*) or a comma-separated list of bin names.\n");
+	fprintf(stdout, "              A list or map bin may be followed by a CDT path, evaluated on the server:\n");
+	fprintf(stdout, "              <bin>[<index>], <bin>[<begin>:<end>] (either bound optional, negative counts from the end),\n");
+	fprintf(stdout, "              <bin>['<map-key>'], nested as <bin>['<map-key>'][<index>] ... [AS <name>]\n");
+	fprintf(stdout, "              Computed columns are evaluated on the server: <expr> AS <name>, where <expr> combines\n");
+	fprintf(stdout, "              bins, numbers, LIST_SIZE(<bin>) and MAP_SIZE(<bin>) with + - * / and parentheses.\n");
+	fprintf(stdout, "              Bins are read as integers unless a float literal (e.g. 1.0) is used, then integer and float\n");
+	fprintf(stdout, "              bins are both converted. Integer '/' truncates: use a * 100.0 / b for a ratio. Put spaces around '-'.\n");
+	fprintf(stdout, "              A computed column is empty where its bins are missing or not numeric.\n");
 	fprintf(stdout, "          <lower> is the lower bound for a numeric range query.\n");
 	fprintf(stdout, "          <upper> is the lower bound for a numeric range query.\n");
 	fprintf(stdout, "          <max-records> is the total number of records to be rendered.\n");
+	fprintf(stdout, "          COUNT(*) without WHERE is read from set metadata, or counted by a scan while partitions migrate;\n");
+	fprintf(stdout, "          with WHERE only digests are streamed.\n");
+	fprintf(stdout, "          EXISTS and the metadata columns {ttl}, {gen} (used as <bins>) read only record headers.\n");
+	fprintf(stdout, "          <timestamp> is 'YYYY-MM-DDThh:mm:ssZ' in UTC or seconds since epoch. SINCE returns records\n");
+	fprintf(stdout, "              last updated at or after it.\n");
+	fprintf(stdout, "          ON NODE scans only the given node. SCAN NODES scans every node in parallel and reports\n");
+	fprintf(stdout, "              records/s and bytes/s (bins' msgpack size) per node, slowest first.\n");
+	fprintf(stdout, "          TAIL rescans every <interval> (e.g. 500ms, 5s, 1m; default 5s) and shows records updated since\n");
+	fprintf(stdout, "              the previous pass, until Ctrl-C. Client and server clocks are assumed in sync. Not available\n");
+	fprintf(stdout, "              in --serve and libaql sessions.\n");
+	fprintf(stdout, "          COMPARE scans both clusters for record headers only and hashes digests and generations per\n");
+	fprintf(stdout, "              partition. Records of differing partitions are listed (up to 256 partitions).\n");
+	fprintf(stdout, "          PROFILE shows per-node histograms of record size, TTL remaining, last-update age and\n");
+	fprintf(stdout, "              generation. Sizes come from the server's object-size histogram, the rest from\n");
+	fprintf(stdout, "              no-bin scans, one per last-update age bucket.\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "      Examples:\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "          SELECT * FROM test.demo\n");
 	fprintf(stdout, "          SELECT * FROM test.demo WHERE PK = 'key1'\n");
 	fprintf(stdout, "          SELECT foo, bar FROM test.demo WHERE PK = 'key1'\n");
+	fprintf(stdout, "          SELECT EXISTS FROM test.demo WHERE PK IN ('key1', 'key2', 'key3')\n");
+	fprintf(stdout, "          SELECT {ttl}, {gen} FROM test.demo WHERE PK IN ('key1', 'key2')\n");
+	fprintf(stdout, "          SELECT * FROM test.demo SINCE '2026-10-01T00:00:00Z'\n");
+	fprintf(stdout, "          SELECT * FROM test.demo ON NODE 'BB9020011AC4202'\n");
+	fprintf(stdout, "          SCAN NODES test.demo\n");
+	fprintf(stdout, "          TAIL test.demo INTERVAL 2s\n");
+	fprintf(stdout, "          COMPARE test.demo WITH HOST 'dr-cluster:3000'\n");
+	fprintf(stdout, "          PROFILE test.demo\n");
 	fprintf(stdout, "          SELECT foo, bar FROM test.demo WHERE foo = 123 limit 10\n");
+	fprintf(stdout, "          SELECT events[-10:], profile['country'] AS country FROM test.demo WHERE PK = 'key1'\n");
+	fprintf(stdout, "          SELECT a, b, a * 100 / b AS ratio, LIST_SIZE(l) AS n FROM test.demo\n");
 	fprintf(stdout, "          SELECT foo, bar FROM test.demo WHERE foo = 123 and bar = \"abc\" limit 10\n");
 	fprintf(stdout, "          SELECT foo, bar FROM test.demo WHERE foo BETWEEN 0 AND 999 limit 20\n");
 	fprintf(stdout, "          SELECT * FROM test.demo WHERE gj CONTAINS CAST('{\"type\": \"Point\", \"coordinates\": [0.0, 0.0]}' AS GEOJSON)\n");
@@ -292,6 +403,11 @@ print_query_help()
 	fprintf(stdout, "          AGGREGATE myudfs.udf2(2) ON test.demo WHERE foo = 123\n");
 	fprintf(stdout, "          AGGREGATE myudfs.udf2(2) ON test.demo WHERE foo BETWEEN 0 AND 999\n");
 	fprintf(stdout, "      \n");
+	fprintf(stdout, "      With SET REDUCE_THREADS <n> (n > 1) the aggregation runs as <n> queries on\n");
+	fprintf(stdout, "      disjoint partition ranges, each reduced on the client in its own thread and\n");
+	fprintf(stdout, "      Lua state, then merged by the stream's reduce(). A stream whose ops after\n");
+	fprintf(stdout, "      the first reduce() change the reduced value runs as one query instead.\n");
+	fprintf(stdout, "      \n");
 	fprintf(stdout, "  EXPLAIN\n");
 	fprintf(stdout, "      EXPLAIN SELECT * FROM <ns>[.<set>] WHERE PK = <key>\n");
 	fprintf(stdout, "      \n");
@@ -314,6 +430,19 @@ print_admin_help()
 	fprintf(stdout, "      SHOW SETS\n" );
 	fprintf(stdout, "      SHOW BINS\n" );
 	fprintf(stdout, "      SHOW INDEXES\n" );
+	fprintf(stdout, "      SHOW INDEX ADVICE\n" );
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          SHOW INDEX ADVICE lists WHERE bins of this session that had no index,\n");
+	fprintf(stdout, "          ranked by the records an index would have saved reading. Predicates are\n");
+	fprintf(stdout, "          kept in memory by this aql process only, nothing is saved: run the\n");
+	fprintf(stdout, "          statements and SHOW INDEX ADVICE in one session, one -c/-f run, or\n");
+	fprintf(stdout, "          through a --serve daemon, which collects them for all its clients.\n");
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "      SHOW POOL\n" );
+	fprintf(stdout, "      \n");
+	fprintf(stdout, "          SHOW POOL lists connections in use and idle per node. Pools are sized\n");
+	fprintf(stdout, "          with SET MIN_CONNS_PER_NODE / MAX_CONNS_PER_NODE before connecting.\n");
+	fprintf(stdout, "          It also shows the peak bytes statements were parsed into.\n");
 	fprintf(stdout, "      \n");
 	fprintf(stdout, "  MANAGE UDFS\n");
 	fprintf(stdout, "      SHOW MODULES\n");
@@ -352,6 +481,18 @@ print_setting_help()
 	fprintf(stdout, "      	\n");
 	fprintf(stdout, "          aql> RESET <setting>\n");
 	fprintf(stdout, "      	\n");
+	fprintf(stdout, "      SET PROFILE INTERACTIVE | BULK loads MAX_RETRIES, SLEEP_BETWEEN_RETRIES,\n");
+	fprintf(stdout, "      COMPRESS, CONCURRENT, SHORT_QUERY and RECORD_EXISTS together. Setting\n");
+	fprintf(stdout, "      any of them afterwards makes the profile CUSTOM.\n");
+	fprintf(stdout, "      	\n");
+	fprintf(stdout, "      A hint comment overrides settings for one statement:\n");
+	fprintf(stdout, "      	\n");
+	fprintf(stdout, "          aql> SELECT /*+ PARALLEL RPS(5000) COMPRESS */ * FROM test.demo\n");
+	fprintf(stdout, "      	\n");
+	fprintf(stdout, "      Hints: PARALLEL PARALLEL(1) RPS(n) RETRIES(n) SLEEP(ms) TIMEOUT(ms)\n");
+	fprintf(stdout, "             COMPRESS NOCOMPRESS SHORT PROFILE(name)\n");
+	fprintf(stdout, "      PARALLEL turns CONCURRENT on for the statement, PARALLEL(1) turns it off.\n");
+	fprintf(stdout, "      The client has no degree in between, PARALLEL(n) with n > 1 is an error.\n");
 	fprintf(stdout, "      	\n");
 }
 
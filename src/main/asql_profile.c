@@ -0,0 +1,520 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/aerospike_info.h>
+#include <aerospike/aerospike_scan.h>
+#include <aerospike/as_cluster.h>
+#include <aerospike/as_error.h>
+#include <aerospike/as_exp.h>
+#include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_node.h>
+#include <aerospike/as_operations.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_scan.h>
+#include <aerospike/as_string.h>
+
+#include <renderer.h>
+#include <asql.h>
+#include <asql_info_parser.h>
+#include <asql_profile.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+#define SECONDS_HOUR (60 * 60)
+#define SECONDS_DAY (24 * SECONDS_HOUR)
+
+// Age and TTL buckets, upper bounds in seconds, the last one is open.
+static const uint64_t age_bounds[] = {
+	SECONDS_HOUR, SECONDS_DAY, 7 * SECONDS_DAY, 30 * SECONDS_DAY,
+	365 * SECONDS_DAY
+};
+
+static const char* age_labels[] = {
+	"< 1h", "1h-1d", "1d-7d", "7d-30d", "30d-1y", ">= 1y"
+};
+
+#define N_AGE (sizeof(age_labels) / sizeof(age_labels[0]))
+
+static const char* ttl_labels[] = {
+	"< 1h", "1h-1d", "1d-7d", "7d-30d", "30d-1y", ">= 1y", "never"
+};
+
+// Sizes in powers of two from 256 bytes.
+static const char* size_labels[] = {
+	"< 256B", "256B-512B", "512B-1K", "1K-2K", "2K-4K", "4K-8K", "8K-16K",
+	"16K-32K", "32K-64K", "64K-128K", "128K-256K", "256K-512K", "512K-1M",
+	">= 1M"
+};
+
+#define N_SIZE (sizeof(size_labels) / sizeof(size_labels[0]))
+
+// Generations in powers of two, up to the 16 bit maximum.
+static const char* gen_labels[] = {
+	"0-1", "2-3", "4-7", "8-15", "16-31", "32-63", "64-127", "128-255",
+	"256-511", "512-1023", "1024-2047", "2048-4095", "4096-8191",
+	"8192-16383", "16384-32767", "32768-65535"
+};
+
+#define N_GEN (sizeof(gen_labels) / sizeof(gen_labels[0]))
+
+// Bin the single pass scan reads each record's since-update time into.
+#define LUT_BIN "lut_ms"
+#define LUT_FROM_RECORD UINT32_MAX
+
+typedef struct {
+	char name[AS_NODE_NAME_SIZE];
+	pthread_t thread;
+	as_error err;
+
+	const char* ns;
+	const char* set;
+	as_policy_scan policy;
+
+	bool has_size;
+	uint64_t size[N_SIZE];
+	uint64_t ttl[N_AGE + 1]; // the age buckets, then "never"
+	uint64_t lut[N_AGE];
+	uint64_t gen[N_GEN];
+	uint32_t lut_bucket; // of the scan in progress, or LUT_FROM_RECORD
+	bool no_lut;         // the server returned records without LUT_BIN
+} profile_node;
+
+typedef struct {
+	profile_node* nodes;
+	uint32_t n_nodes;
+} profile_info_udata;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static void* profile_node_run(void* udata);
+static bool profile_node_pass(profile_node* pn);
+static void profile_node_bucket_scans(profile_node* pn);
+static bool profile_scan_cb(const as_val* val, void* udata);
+static bool profile_size_cb(const as_error* err, const as_node* node,
+		const char* req, char* res, void* udata);
+static uint32_t age_bucket(uint64_t seconds);
+static uint32_t log2_bucket(uint64_t v, uint32_t shift, uint32_t n);
+static void profile_render(const char* name, const char** labels,
+		uint32_t n_labels, size_t offset, profile_node* nodes,
+		uint32_t n_nodes, void* rview);
+
+
+//=========================================================
+// Public API.
+//
+
+// PROFILE <ns>[.<set>]: record size, TTL, last-update age and generation
+// histograms per node. No bin leaves the server.
+int
+asql_profile(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_nodes* cluster_nodes = as_nodes_reserve(g_aerospike->cluster);
+	uint32_t n_nodes = cluster_nodes->size;
+	profile_node* nodes = calloc(n_nodes, sizeof(profile_node));
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		profile_node* pn = &nodes[i];
+
+		strcpy(pn->name, cluster_nodes->array[i]->name);
+		as_error_init(&pn->err);
+		pn->ns = s->ns;
+		pn->set = s->set;
+
+		as_policy_scan_copy(&g_aerospike->config.policies.scan, &pn->policy);
+		asql_policy_base_init(c, &pn->policy.base);
+		pn->policy.records_per_second = (uint32_t)c->scan_records_per_second;
+	}
+	as_nodes_release(cluster_nodes);
+
+	// Record sizes, from the server's own histogram.
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	char req[512];
+	if (s->set) {
+		snprintf(req, sizeof(req),
+				"histogram:namespace=%s;type=object-size;set=%s", s->ns,
+				s->set);
+	}
+	else {
+		snprintf(req, sizeof(req), "histogram:namespace=%s;type=object-size",
+				s->ns);
+	}
+
+	profile_info_udata iu = { .nodes = nodes, .n_nodes = n_nodes };
+	aerospike_info_foreach(g_aerospike, &err, &info_policy, req,
+			profile_size_cb, &iu);
+
+	// Older servers lack the histogram, the other columns still apply.
+	as_error_reset(&err);
+
+	// The rest, from no-bin scans of each node at once.
+	uint32_t n_started = 0;
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		if (pthread_create(&nodes[i].thread, NULL, profile_node_run,
+				&nodes[i]) != 0) {
+			as_error_update(&err, AEROSPIKE_ERR_CLIENT,
+					"Unable to start scan thread for node %s", nodes[i].name);
+			break;
+		}
+		n_started++;
+	}
+
+	for (uint32_t i = 0; i < n_started; i++) {
+		pthread_join(nodes[i].thread, NULL);
+
+		if (err.code == AEROSPIKE_OK && nodes[i].err.code != AEROSPIKE_OK) {
+			as_error_copy(&err, &nodes[i].err);
+		}
+	}
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		free(nodes);
+		return 1;
+	}
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), n_nodes + 3);
+	const char* fixed[] = { "histogram", "bucket" };
+	const char* total = "total";
+
+	for (uint32_t i = 0; i < 2; i++) {
+		as_vector_append(&cols, &fixed[i]);
+	}
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		char* name = nodes[i].name;
+		as_vector_append(&cols, &name);
+	}
+	as_vector_append(&cols, &total);
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	// The server's histogram counts every copy, the scans master records only.
+	profile_render("record_size (all replicas)", size_labels, N_SIZE,
+			offsetof(profile_node, size), nodes, n_nodes, rview);
+	profile_render("ttl", ttl_labels, N_AGE + 1,
+			offsetof(profile_node, ttl), nodes, n_nodes, rview);
+	profile_render("lut_age", age_labels, N_AGE,
+			offsetof(profile_node, lut), nodes, n_nodes, rview);
+	profile_render("generation", gen_labels, N_GEN,
+			offsetof(profile_node, gen), nodes, n_nodes, rview);
+
+	g_renderer->render(NULL, rview);
+
+	bool has_size = false;
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		has_size = has_size || nodes[i].has_size;
+	}
+
+	if (!has_size) {
+		g_renderer->render_ok(
+				"record_size unavailable, the server has no object-size histogram",
+				rview);
+	}
+	g_renderer->view_destroy(rview);
+
+	as_vector_destroy(&cols);
+	free(nodes);
+	return 0;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+// One scan per node, each record's since-update time is read by an
+// expression and bucketed here. TTL and generation come with every record
+// header. Servers which don't return expression reads on a foreground scan
+// get one no-bin scan per age bucket instead.
+static void*
+profile_node_run(void* udata)
+{
+	profile_node* pn = (profile_node*)udata;
+
+	if (!profile_node_pass(pn) && pn->err.code == AEROSPIKE_OK
+			&& !g_interrupted) {
+		memset(pn->ttl, 0, sizeof(pn->ttl));
+		memset(pn->lut, 0, sizeof(pn->lut));
+		memset(pn->gen, 0, sizeof(pn->gen));
+		profile_node_bucket_scans(pn);
+	}
+	return NULL;
+}
+
+// Returns false when the records came back without LUT_BIN.
+static bool
+profile_node_pass(profile_node* pn)
+{
+	as_scan scan;
+	as_scan_init(&scan, pn->ns, pn->set);
+
+	// Owned by the scan from here.
+	scan.ops = as_operations_new(1);
+	as_exp_build(age, as_exp_since_update());
+	as_operations_exp_read(scan.ops, LUT_BIN, age, AS_EXP_READ_DEFAULT);
+	as_exp_destroy(age);
+
+	pn->lut_bucket = LUT_FROM_RECORD;
+	pn->no_lut = false;
+
+	as_error err;
+	as_error_init(&err);
+	aerospike_scan_node(g_aerospike, &err, &pn->policy, &scan, pn->name,
+			profile_scan_cb, pn);
+	as_scan_destroy(&scan);
+
+	// A server refusing operations on a foreground scan says so as a
+	// parameter error, the bucket scans still work there.
+	if (err.code == AEROSPIKE_ERR_REQUEST_INVALID) {
+		return false;
+	}
+
+	if (err.code != AEROSPIKE_OK && !pn->no_lut) {
+		as_error_copy(&pn->err, &err);
+	}
+	return !pn->no_lut;
+}
+
+// One no-bin scan per last-update age bucket, so each record's bucket is
+// known without reading its last-update-time.
+static void
+profile_node_bucket_scans(profile_node* pn)
+{
+	as_scan scan;
+	as_scan_init(&scan, pn->ns, pn->set);
+	scan.no_bins = true;
+
+	for (uint32_t b = 0; b < N_AGE && !g_interrupted; b++) {
+		as_policy_scan policy = pn->policy;
+		int64_t lo_ms = b == 0 ? 0 : (int64_t)age_bounds[b - 1] * 1000;
+
+		if (b < N_AGE - 1) {
+			int64_t hi_ms = (int64_t)age_bounds[b] * 1000;
+			as_exp_build(filter, as_exp_and(
+					as_exp_cmp_ge(as_exp_since_update(), as_exp_int(lo_ms)),
+					as_exp_cmp_lt(as_exp_since_update(), as_exp_int(hi_ms))));
+			policy.base.filter_exp = filter;
+		}
+		else {
+			as_exp_build(filter,
+					as_exp_cmp_ge(as_exp_since_update(), as_exp_int(lo_ms)));
+			policy.base.filter_exp = filter;
+		}
+
+		pn->lut_bucket = b;
+		aerospike_scan_node(g_aerospike, &pn->err, &policy, &scan, pn->name,
+				profile_scan_cb, pn);
+		as_exp_destroy(policy.base.filter_exp);
+
+		if (pn->err.code != AEROSPIKE_OK) {
+			break;
+		}
+	}
+
+	as_scan_destroy(&scan);
+}
+
+// A node scan is a single command, records arrive on one thread.
+static bool
+profile_scan_cb(const as_val* val, void* udata)
+{
+	if (!val) {
+		return true;
+	}
+
+	profile_node* pn = (profile_node*)udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (!rec) {
+		return true;
+	}
+
+	uint32_t lut_bucket = pn->lut_bucket;
+
+	if (lut_bucket == LUT_FROM_RECORD) {
+		as_integer* ms = as_record_get_integer(rec, LUT_BIN);
+
+		if (!ms) {
+			pn->no_lut = true;
+			return false;
+		}
+		lut_bucket = age_bucket((uint64_t)as_integer_get(ms) / 1000);
+	}
+
+	pn->lut[lut_bucket]++;
+	pn->ttl[rec->ttl == AS_RECORD_NO_EXPIRE_TTL ? N_AGE :
+			age_bucket(rec->ttl)]++;
+	pn->gen[log2_bucket(rec->gen, 0, N_GEN)]++;
+
+	return !g_interrupted;
+}
+
+// Response: units=bytes:hist-width=<n>:bucket-width=<w>:buckets=<c>,<c>,...
+static bool
+profile_size_cb(const as_error* err, const as_node* node, const char* req,
+		char* res, void* udata)
+{
+	if (err->code != AEROSPIKE_OK) {
+		return true;
+	}
+
+	profile_info_udata* iu = (profile_info_udata*)udata;
+	profile_node* pn = NULL;
+
+	for (uint32_t i = 0; i < iu->n_nodes; i++) {
+		if (!strcmp(iu->nodes[i].name, node->name)) {
+			pn = &iu->nodes[i];
+			break;
+		}
+	}
+
+	char* resp = info_res_split(res);
+
+	if (!pn || !resp || !strncmp(resp, "ERROR", 5)) {
+		return true;
+	}
+
+	char* width = strstr(resp, "bucket-width=");
+	char* buckets = strstr(resp, "buckets=");
+
+	if (!width || !buckets) {
+		return true;
+	}
+
+	uint64_t w = strtoull(width + strlen("bucket-width="), NULL, 10);
+	char* p = buckets + strlen("buckets=");
+
+	for (uint64_t i = 0; *p && *p != '\n'; i++) {
+		char* end = NULL;
+		uint64_t count = strtoull(p, &end, 10);
+
+		if (end == p) {
+			break;
+		}
+
+		// Bucket i holds sizes from i * w.
+		pn->size[log2_bucket(i * w, 8, N_SIZE)] += count;
+		p = *end == ',' ? end + 1 : end;
+	}
+
+	pn->has_size = true;
+	return true;
+}
+
+static uint32_t
+age_bucket(uint64_t seconds)
+{
+	uint32_t b = 0;
+
+	while (b < N_AGE - 1 && seconds >= age_bounds[b]) {
+		b++;
+	}
+	return b;
+}
+
+// Bucket 0 below 2^shift, then one bucket per power of two, the last open.
+static uint32_t
+log2_bucket(uint64_t v, uint32_t shift, uint32_t n)
+{
+	uint32_t b = 0;
+
+	for (v >>= shift; v > 1 && b < n - 1; v >>= 1) {
+		b++;
+	}
+
+	if (v == 1 && shift > 0 && b < n - 1) {
+		b++;
+	}
+	return b;
+}
+
+// One row per bucket any node has records in.
+static void
+profile_render(const char* name, const char** labels, uint32_t n_labels,
+		size_t offset, profile_node* nodes, uint32_t n_nodes, void* rview)
+{
+	for (uint32_t b = 0; b < n_labels; b++) {
+		uint64_t total = 0;
+
+		for (uint32_t i = 0; i < n_nodes; i++) {
+			total += ((uint64_t*)((uint8_t*)&nodes[i] + offset))[b];
+		}
+
+		if (total == 0) {
+			continue;
+		}
+
+		as_hashmap m;
+		as_hashmap_init(&m, n_nodes + 3);
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("histogram"),
+				(as_val*)as_string_new_strdup(name));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("bucket"),
+				(as_val*)as_string_new_strdup(labels[b]));
+
+		for (uint32_t i = 0; i < n_nodes; i++) {
+			uint64_t count = ((uint64_t*)((uint8_t*)&nodes[i] + offset))[b];
+			as_hashmap_set(&m, (as_val*)as_string_new_strdup(nodes[i].name),
+					(as_val*)as_integer_new((int64_t)count));
+		}
+
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("total"),
+				(as_val*)as_integer_new((int64_t)total));
+
+		g_renderer->render((as_val*)&m, rview);
+		as_hashmap_destroy(&m);
+	}
+}
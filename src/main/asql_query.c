@@ -31,15 +31,30 @@
 #include <aerospike/as_exp.h>
 #include <aerospike/as_record.h>
 #include <aerospike/as_arraylist.h>
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_bytes.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_integer.h>
 #include <aerospike/as_list.h>
+#include <aerospike/as_log_macros.h>
+#include <aerospike/as_map.h>
+#include <aerospike/as_module.h>
+#include <aerospike/as_partition_filter.h>
+#include <aerospike/as_result.h>
+#include <aerospike/as_stream.h>
+#include <aerospike/as_string.h>
+#include <aerospike/mod_lua.h>
 
 #include <renderer.h>
 #include <json.h>
 #include <asql.h>
+#include <asql_advice.h>
 #include <asql_query.h>
+#include <asql_key.h>
 #include <asql_info.h>
 #include <asql_info_parser.h>
 #include <asql_log.h>
+#include <pthread.h>
 #include <stdatomic.h>
 
 
@@ -47,15 +62,43 @@
 // Typedefs & constants.
 //
 
+// Aggregation values are handed to the renderer this many at a time.
+#define AGG_BATCH_SIZE 256
+
+// REDUCE_THREADS splits the namespace's partitions into ranges.
+#define AGG_N_PARTITIONS 4096
+
 typedef struct {
 	char name[64];
 	void* rview;
 	uint64_t start;
+	as_val* batch[AGG_BATCH_SIZE]; // reserved, released once rendered
+	uint32_t n_batch;
+	bool stopped; // the renderer wants no more values
 } asql_query_data;
 
+// One partition range of a REDUCE_THREADS aggregation. The client reduces
+// the range's stream in a Lua state of its own, on the worker's thread.
+typedef struct {
+	pthread_t thread;
+	const as_query* query;
+	const as_policy_query* policy;
+	as_partition_filter pf;
+	as_vector vals; // as_val*, reserved
+	as_error err;
+} agg_worker;
+
+// Source and sink of a client scope pass over partial results.
+typedef struct {
+	as_vector* in; // as_val*, borrowed
+	uint32_t next;
+	as_vector* out; // as_val*, owned
+} agg_merge_stream;
+
 typedef struct {
 	void* rview;
 	bool limit_set;
+	bool header;
 	atomic_int record_limit;
 } query_cb_udata;
 
@@ -68,13 +111,42 @@ extern void asql_record_set_renderer(as_record* rec, as_hashmap* m, char* bin_na
 static bool epbv_callback(const as_error* err, const as_node* node, const char* req, char* res, void* udata);
 static double get_avg_rec_per_bval(as_error* err, asql_name ns, asql_name index_name);
 static bool ibname_equal(asql_name ibname, asql_name set, as_val_t type, char* bin_val, char* set_val, char* type_val);
-static int compare_avg_rec_per_bval(const asql_name ns, const asql_name set, asql_name ibname, as_val_t type, asql_name ibname2, as_val_t type2, bool* exists, as_error* err);
+static int compare_avg_rec_per_bval(const asql_name ns, const asql_name set, asql_name ibname, as_val_t type, asql_name ibname2, as_val_t type2, bool* exists, double* card, as_error* err);
 static void populate_filter_exp(as_exp **filter, asql_where* where, as_error* err);
 static int populate_where(as_query* query, as_policy_query* policy, sk_config* s, as_error* err);
+static void advise_where(sk_config* s, as_status status);
 static bool query_callback(const as_val* val, void* udata);
 static int query_select(asql_config* c, sk_config* s);
 static int query_execute(asql_config* c, sk_config* s);
+static int query_update(asql_config* c, sk_config* s);
+static int query_count(asql_config* c, sk_config* s);
+static bool count_callback(const as_val* val, void* udata);
 static bool query_agg_renderer(const as_val* val, void* udata);
+static bool query_agg_flush(asql_query_data* data);
+static void query_agg_parallel(asql_config* c, const as_query* query,
+		const as_policy_query* policy, asql_query_data* data, as_error* err);
+static void* agg_worker_run(void* udata);
+static bool agg_worker_cb(const as_val* val, void* udata);
+static bool agg_merge(const as_query* query, agg_worker* workers,
+		uint32_t n_workers, asql_query_data* data, as_error* err);
+static bool agg_is_final(const as_query* query, as_vector* vals,
+		as_error* err);
+static void agg_client_apply(const as_query* query, as_vector* in,
+		as_vector* out, as_error* err);
+static bool agg_val_equal(const as_val* a, const as_val* b);
+static bool agg_map_equal_cb(const as_val* k, const as_val* v, void* udata);
+static as_val* agg_merge_read(const as_stream* s);
+static as_stream_status agg_merge_write(const as_stream* s, as_val* v);
+
+static const as_aerospike_hooks agg_merge_hooks = { 0 };
+
+static const as_stream_hooks agg_merge_istream_hooks = {
+	.read = agg_merge_read,
+};
+
+static const as_stream_hooks agg_merge_ostream_hooks = {
+	.write = agg_merge_write,
+};
 
 
 //==========================================================
@@ -88,11 +160,11 @@ asql_query_aggregate(asql_config* c, sk_config* s)
 	as_error_init(&err);
 
 	as_policy_query query_policy;
-	as_policy_query_init(&query_policy);
-	query_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		query_policy.base.socket_timeout = c->base.socket_timeout_ms;
+	as_policy_query_copy(&g_aerospike->config.policies.query, &query_policy);
+	asql_policy_base_init(c, &query_policy.base);
+
+	if (c->short_query) {
+		query_policy.expected_duration = AS_QUERY_DURATION_SHORT;
 	}
 
 	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
@@ -138,7 +210,8 @@ asql_query_aggregate(asql_config* c, sk_config* s)
 		// destroy on arglist
 		as_query_apply(&query, s->u.udfpkg, s->u.udfname, (as_list*)&arglist);
 
-		asql_query_data data = { .name = { '\0' }, .rview = NULL };
+		asql_query_data data = { .name = { '\0' }, .rview = NULL, .n_batch = 0,
+				.stopped = false };
 
 		strncpy(data.name, s->u.udfname, AS_BIN_NAME_MAX_LEN);
 		if (strlen(s->u.udfname) > AS_BIN_NAME_MAX_LEN) {
@@ -150,10 +223,20 @@ asql_query_aggregate(asql_config* c, sk_config* s)
 		data.rview = rview;
 		data.start = cf_getms();
 
-		aerospike_query_foreach(g_aerospike, &err, &query_policy, &query,
-				query_agg_renderer, &data);
+		if (c->reduce_threads > 1) {
+			query_agg_parallel(c, &query, &query_policy, &data, &err);
+		}
+		else {
+			aerospike_query_foreach(g_aerospike, &err, &query_policy, &query,
+					query_agg_renderer, &data);
+		}
+
+		// A failed query may end without the final NULL callback.
+		query_agg_flush(&data);
 	}
 
+	advise_where(s, err.code);
+
 	if (err.code == AEROSPIKE_OK) {
 		g_renderer->render_ok("", rview);
 	} else {
@@ -166,18 +249,62 @@ asql_query_aggregate(asql_config* c, sk_config* s)
 	return 0;
 }
 
+// AND "last-update-time >= <since>" into a filter expression.
+void
+asql_filter_since(as_exp** filter, int64_t since)
+{
+	as_exp_build(lut, as_exp_cmp_ge(as_exp_last_update(), as_exp_int(since)));
+
+	if (*filter) {
+		as_exp_build(both, as_exp_and(as_exp_expr(*filter), as_exp_expr(lut)));
+		as_exp_destroy(*filter);
+		as_exp_destroy(lut);
+		*filter = both;
+	}
+	else {
+		*filter = lut;
+	}
+}
+
+// Render a single "count(*)" row.
+void
+asql_query_render_count(uint64_t count)
+{
+	as_record rec;
+	as_record_inita(&rec, 1);
+	as_record_set_int64(&rec, "count(*)", (int64_t)count);
+	print_rec(&rec, NULL);
+	as_record_destroy(&rec);
+}
+
 int
 asql_query(asql_config* c, aconfig* ac)
 {
 	sk_config* s = (sk_config*)ac;
 
+	// An index this session created without WAIT may still be building.
+	if (asql_index_wait_pending(c, s->ns, s->where.ibname) != 0
+			|| (s->where2 && asql_index_wait_pending(c, s->ns,
+					s->where2->ibname) != 0)) {
+		return 1;
+	}
+
 	switch (s->optype) {
 		case ASQL_OP_SELECT:
+			if (s->s.count) {
+				return query_count(c, s);
+			}
+			return query_select(c, s);
+		case ASQL_OP_INSERT:
+			// INSERT INTO ... SELECT
 			return query_select(c, s);
 		case ASQL_OP_AGGREGATE:
 			return asql_query_aggregate(c, s);
 		case ASQL_OP_EXECUTE:
 			return query_execute(c, s);
+		case ASQL_OP_UPDATE:
+		case ASQL_OP_TOUCH:
+			return query_update(c, s);
 		default:
 			return 0;
 	}
@@ -295,12 +422,14 @@ ibname_equal(asql_name ibname, asql_name set, as_val_t type, char* bin_val, char
 }
 
 static int
-compare_avg_rec_per_bval(const asql_name ns, asql_name set, asql_name ibname, as_val_t type, asql_name ibname2, as_val_t type2, bool* exists, as_error* err)
+compare_avg_rec_per_bval(const asql_name ns, asql_name set, asql_name ibname, as_val_t type, asql_name ibname2, as_val_t type2, bool* exists, double* card, as_error* err)
 {
 	// returns positive ibname > ibname2
 	// returns negative ibname < ibname2
+	// card is set to the records per value of the index that wins, 0 if unknown
 	int rv = 0;
 	*exists = true;
+	*card = 0;
 	char* req = malloc(strlen("sindex-list:namespace=") + strlen(ns) + 1);
 	char* res = NULL;
 	sprintf(req, "sindex-list:namespace=%s", ns);
@@ -356,12 +485,18 @@ compare_avg_rec_per_bval(const asql_name ns, asql_name set, asql_name ibname, as
 		goto cleanup;
 	}
 
+	// Only needed for index advice, a failure here must not fail the query.
+	as_error card_err;
+	as_error_init(&card_err);
+
 	if (ibname_index == NULL && ibname2_index != NULL) {
+		*card = get_avg_rec_per_bval(&card_err, ns, ibname2_index);
 		rv = 1; 
 		goto cleanup;
 	}
 	
 	if (ibname_index != NULL && ibname2_index == NULL) {
+		*card = get_avg_rec_per_bval(&card_err, ns, ibname_index);
 		rv = -1; 
 		goto cleanup;
 	}
@@ -370,15 +505,19 @@ compare_avg_rec_per_bval(const asql_name ns, asql_name set, asql_name ibname, as
 	ibname2_card = get_avg_rec_per_bval(err, ns, ibname2_index);
 	
 	if (ibname_card > ibname2_card) {
+		*card = ibname2_card;
 		rv = 1;
 		goto cleanup;
 	}
 
 	if (ibname_card < ibname2_card) {
+		*card = ibname_card;
 		rv = -1;
 		goto cleanup;
 	}
 
+	*card = ibname_card;
+
 	rv = 0;
 
 cleanup:
@@ -393,6 +532,25 @@ cleanup:
 	return rv;
 }
 
+// Single WHERE outcome for SHOW INDEX ADVICE, once the server has answered.
+// Double WHERE outcomes are recorded when populate_where picks the index.
+static void
+advise_where(sk_config* s, as_status status)
+{
+	if (s->type != SECONDARY_INDEX_OP || s->where2) {
+		return;
+	}
+
+	if (status == AEROSPIKE_OK) {
+		asql_advice_record(s->ns, s->set, &s->where, s->itype,
+				ASQL_ADVICE_INDEXED, 0);
+	}
+	else if (status == AEROSPIKE_ERR_INDEX_NOT_FOUND) {
+		asql_advice_record(s->ns, s->set, &s->where, s->itype,
+				ASQL_ADVICE_NO_INDEX, 0);
+	}
+}
+
 static void
 populate_filter_exp(as_exp **filter, asql_where* where, as_error* err) {
 	asql_name ibname = where->ibname;
@@ -427,7 +585,8 @@ populate_where(as_query* query, as_policy_query* policy, sk_config* s, as_error*
 		char* bin1 = s->where.ibname;
 		char* bin2 = s->where2->ibname;
 		bool both_exist = true;
-		int rv = compare_avg_rec_per_bval(s->ns, s->set, bin1, s->where.beg.type, bin2, s->where2->beg.type, &both_exist, err);
+		double card = 0;
+		int rv = compare_avg_rec_per_bval(s->ns, s->set, bin1, s->where.beg.type, bin2, s->where2->beg.type, &both_exist, &card, err);
 
 		if (err->code != AEROSPIKE_OK) {
 			as_error_append(err, "Unable to determine cardinality");
@@ -438,21 +597,36 @@ populate_where(as_query* query, as_policy_query* policy, sk_config* s, as_error*
 			// use bin1
 			chosen_where = &s->where;
 			populate_filter_exp(&policy->base.filter_exp, s->where2, err);
+			asql_advice_record(s->ns, s->set, s->where2, s->itype,
+					ASQL_ADVICE_FILTERED, card);
 		}
 		else if (rv > 0) {
 			// use bin2
 			chosen_where = s->where2;
 			populate_filter_exp(&policy->base.filter_exp, &s->where, err);
+			asql_advice_record(s->ns, s->set, &s->where, s->itype,
+					ASQL_ADVICE_FILTERED, card);
 		}
 		else if (rv == 0 && both_exist) {
 			// pick bin1 or bin2. we'll arbitrarily pick bin1
 			chosen_where = &s->where;
-			populate_filter_exp(&policy->base.filter_exp, &s->where, err);
+			populate_filter_exp(&policy->base.filter_exp, s->where2, err);
+			asql_advice_record(s->ns, s->set, s->where2, s->itype,
+					ASQL_ADVICE_FILTERED, card);
 		} 
 		else {
+			asql_advice_record(s->ns, s->set, &s->where, s->itype,
+					ASQL_ADVICE_NO_INDEX, 0);
+			asql_advice_record(s->ns, s->set, s->where2, s->itype,
+					ASQL_ADVICE_NO_INDEX, 0);
 			return as_error_update(err, AEROSPIKE_ERR_CLIENT,
 									   "Error: at least one bin needs a secondary index defined");
 		}
+
+		// The server is only asked about the chosen bin, sindex-list already
+		// showed it has an index.
+		asql_advice_record(s->ns, s->set, chosen_where, s->itype,
+				ASQL_ADVICE_INDEXED, 0);
 	} else {
 		chosen_where = &s->where;
 	}
@@ -545,6 +719,7 @@ populate_where(as_query* query, as_policy_query* policy, sk_config* s, as_error*
 static void 
 new_query_cb_udata(query_cb_udata* query_udata, void* rview, int64_t record_limit) {
 	query_udata->rview = rview;
+	query_udata->header = false;
 
 	if (record_limit == -1) {
 		query_udata->limit_set = false;
@@ -569,7 +744,9 @@ static bool query_callback(const as_val* val, void* udata) {
 	 * Older servers require that we set the limit on the client side.
 	 */
 	if ((query_udata->limit_set && (atomic_fetch_sub(&query_udata->record_limit, 1) < 1)) 
-		|| !g_renderer->render(val, query_udata->rview)) {
+		|| !(query_udata->header
+				? asql_render_header(val, query_udata->rview)
+				: g_renderer->render(val, query_udata->rview))) {
 		// Causes next call to query_callback where val == NULL
 		return false;
 	}
@@ -585,11 +762,11 @@ query_select(asql_config* c, sk_config* s)
 	as_error_init(&err);
 
 	as_policy_query query_policy;
-	as_policy_query_init(&query_policy);
-	query_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		query_policy.base.socket_timeout = c->base.socket_timeout_ms;
+	as_policy_query_copy(&g_aerospike->config.policies.query, &query_policy);
+	asql_policy_base_init(c, &query_policy.base);
+
+	if (c->short_query) {
+		query_policy.expected_duration = AS_QUERY_DURATION_SHORT;
 	}
 
 	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
@@ -614,6 +791,15 @@ query_select(asql_config* c, sk_config* s)
 	if (!s->s.bnames) {
 		select_all = true;
 	}
+	else if (s->s.header) {
+		// {ttl}, {gen} are in the record header
+		query.no_bins = true;
+	}
+	else if (s->s.projs) {
+		// CDT paths are evaluated on the server as read operations.
+		query.ops = as_operations_new(s->s.projs->size);
+		asql_projection_ops_init(&err, &s->s, query.ops);
+	}
 	else {
 		select_all = false;
 		as_query_select_inita(&query, s->s.bnames->size);
@@ -635,10 +821,34 @@ query_select(asql_config* c, sk_config* s)
 		populate_where(&query, &query_policy, s, &err);
 	}
 
+	if (s->s.since) {
+		asql_filter_since(&query_policy.base.filter_exp, s->s.since);
+	}
+
 	if (s->limit) {
 		query.max_records = s->limit->u.i64;
 	}
 
+	if (s->optype == ASQL_OP_INSERT) {
+		// Records go straight from the query into batch writes.
+		asql_copy* cp = err.code == AEROSPIKE_OK
+				? asql_copy_create(c, &s->into, s->set, &err) : NULL;
+
+		if (cp) {
+			aerospike_query_foreach(g_aerospike, &err, &query_policy, &query,
+					asql_copy_callback, cp);
+			advise_where(s, err.code);
+			asql_copy_finish(cp, &err);
+		}
+		else {
+			g_renderer->render_error(err.code, err.message, NULL);
+		}
+
+		as_query_destroy(&query);
+		as_exp_destroy(query_policy.base.filter_exp);
+		return 0;
+	}
+
 	// For each record obtained from the query, invoke the callback function in renderer
 	void* rview = g_renderer->view_new(CLUSTER);
 
@@ -655,10 +865,13 @@ query_select(asql_config* c, sk_config* s)
 		}
 
 		new_query_cb_udata(&query_udata, rview, max_records);
+		query_udata.header = s->s.header;
 		aerospike_query_foreach(g_aerospike, &err, &query_policy, &query,
 		                        query_callback, &query_udata);
 	}
 
+	advise_where(s, err.code);
+
 	if (err.code == AEROSPIKE_OK) {
 		g_renderer->render_ok("", rview);
 	} else if (err.code == AEROSPIKE_ERR_INDEX_NOT_FOUND) {
@@ -675,6 +888,87 @@ query_select(asql_config* c, sk_config* s)
 	return 0;
 }
 
+// COUNT(*) with a WHERE clause: stream digests only and count callbacks,
+// nothing is formatted.
+static int
+query_count(asql_config* c, sk_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_query query_policy;
+	as_policy_query_copy(&g_aerospike->config.policies.query, &query_policy);
+	asql_policy_base_init(c, &query_policy.base);
+
+	if (c->short_query) {
+		query_policy.expected_duration = AS_QUERY_DURATION_SHORT;
+	}
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_query query;
+	as_query_init(&query, s->ns, s->set);
+	query.no_bins = true;
+
+	as_query_where_inita(&query, 1);
+	populate_where(&query, &query_policy, s, &err);
+
+	if (s->s.since) {
+		asql_filter_since(&query_policy.base.filter_exp, s->s.since);
+	}
+
+	if (s->limit) {
+		query.max_records = s->limit->u.i64;
+	}
+
+	atomic_uint_fast64_t count;
+	atomic_init(&count, 0);
+
+	if (err.code == AEROSPIKE_OK) {
+		aerospike_query_foreach(g_aerospike, &err, &query_policy, &query,
+				count_callback, &count);
+	}
+
+	advise_where(s, err.code);
+
+	if (err.code == AEROSPIKE_OK) {
+		asql_query_render_count(atomic_load(&count));
+	}
+	else if (err.code == AEROSPIKE_ERR_INDEX_NOT_FOUND) {
+		as_error_append(&err, "\nMake sure a sindex is created and that strings are enclosed in quotes");
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_query_destroy(&query);
+	as_exp_destroy(query_policy.base.filter_exp); // created in populate_where
+
+	return 0;
+}
+
+static bool
+count_callback(const as_val* val, void* udata)
+{
+	if (val) {
+		atomic_fetch_add((atomic_uint_fast64_t*)udata, 1);
+	}
+	return true;
+}
+
 // Execute udf on : all records in a ns.set (or) <rec-PK> = <value>
 static int
 query_execute(asql_config* c, sk_config* s)
@@ -684,14 +978,9 @@ query_execute(asql_config* c, sk_config* s)
 
 	as_policy_write write_policy;
 	as_policy_write_init(&write_policy);
-	write_policy.base.total_timeout = c->base.timeout_ms;
+	asql_policy_base_init(c, &write_policy.base);
 	write_policy.durable_delete = c->durable_delete;
 
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		write_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
-
 	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
 		char err_msg[1024];
 		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
@@ -732,6 +1021,71 @@ query_execute(asql_config* c, sk_config* s)
 				&query_id);
 	}
 
+	advise_where(s, err.code);
+
+	if (err.code == AEROSPIKE_OK) {
+		char ok_msg[1024];
+		snprintf(ok_msg, 1023, "Query job (%"PRIu64") created.", query_id);
+		g_renderer->render_ok(ok_msg, NULL);
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_query_destroy(&query);
+
+	return 0;
+}
+
+// Apply UPDATE/TOUCH operations to every record matching the secondary index
+// predicate as a background job. No UDF is involved.
+static int
+query_update(asql_config* c, sk_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_write write_policy;
+	as_policy_write_init(&write_policy);
+	asql_policy_base_init(c, &write_policy.base);
+	write_policy.durable_delete = c->durable_delete;
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_query query;
+	as_query_init(&query, s->ns, s->set);
+	query.records_per_second = (uint32_t)c->scan_records_per_second;
+	query.ttl = s->up.has_ttl ? s->up.ttl : c->record_ttl_sec;
+
+	// NB: query object owns ops, destroyed by as_query_destroy
+	query.ops = as_operations_new(s->up.ops->size);
+	asql_update_ops_init(&err, s->up.ops, query.ops);
+
+	if (err.code == AEROSPIKE_OK) {
+		as_query_where_inita(&query, 1);
+		populate_where(&query, NULL, s, &err);
+	}
+
+	uint64_t query_id = 0;
+	if (err.code == AEROSPIKE_OK) {
+		aerospike_query_background(g_aerospike, &err, &write_policy, &query,
+				&query_id);
+	}
+
+	advise_where(s, err.code);
+
 	if (err.code == AEROSPIKE_OK) {
 		char ok_msg[1024];
 		snprintf(ok_msg, 1023, "Query job (%"PRIu64") created.", query_id);
@@ -752,23 +1106,343 @@ query_agg_renderer(const as_val* val, void* udata)
 {
 	asql_query_data* data = (asql_query_data*)udata;
 
-	if (val) {
-		as_record rec;
-		as_record_inita(&rec, 1);
-		as_hashmap m;
-		as_hashmap_init(&m, 2);
-		as_val_reserve(val);
-		// Consumes val
-		asql_record_set_renderer(&rec, &m, data->name, (as_val*)val);
+	if (data->stopped) {
+		return false;
+	}
 
-		g_renderer->render((as_val*)&rec, data->rview);
+	// Stream UDF output is delivered from the single thread running the
+	// aggregation, the batch needs no lock.
+	if (val) {
+		data->batch[data->n_batch++] = as_val_reserve(val);
 
-		as_record_destroy(&rec);
-		as_hashmap_destroy(&m);
+		if (data->n_batch == AGG_BATCH_SIZE && !query_agg_flush(data)) {
+			// End the result set here, the query is stopped.
+			data->stopped = true;
+			g_renderer->render((as_val*) NULL, data->rview);
+			return false;
+		}
 	}
 	else {
+		query_agg_flush(data);
 		g_renderer->render((as_val*) NULL, data->rview);
+		data->stopped = true;
 	}
 
 	return true;
 }
+
+// Values go straight to the renderer as one column rows, no record or map is
+// built around each of them. Returns false when the renderer wants no more.
+static bool
+query_agg_flush(asql_query_data* data)
+{
+	if (data->n_batch == 0) {
+		return true;
+	}
+
+	bool rv = g_renderer->render_values(data->name, data->batch,
+			data->n_batch, data->rview);
+
+	for (uint32_t i = 0; i < data->n_batch; i++) {
+		as_val_destroy(data->batch[i]);
+	}
+	data->n_batch = 0;
+	return rv;
+}
+
+// The client reduces all nodes' streams in one Lua state, on one thread.
+// Instead, split the aggregation into REDUCE_THREADS queries on disjoint
+// partition ranges, run them concurrently, and merge their partial results.
+static void
+query_agg_parallel(asql_config* c, const as_query* query,
+		const as_policy_query* policy, asql_query_data* data, as_error* err)
+{
+	uint32_t n_workers = (uint32_t)c->reduce_threads;
+
+	if (n_workers > AGG_N_PARTITIONS) {
+		n_workers = AGG_N_PARTITIONS;
+	}
+
+	agg_worker* workers = calloc(n_workers, sizeof(agg_worker));
+	uint32_t n_started = 0;
+
+	for (uint32_t i = 0; i < n_workers; i++) {
+		agg_worker* w = &workers[i];
+		uint32_t begin = i * AGG_N_PARTITIONS / n_workers;
+		uint32_t end = (i + 1) * AGG_N_PARTITIONS / n_workers;
+
+		w->query = query;
+		w->policy = policy;
+		as_partition_filter_set_range(&w->pf, begin, end - begin);
+		as_error_init(&w->err);
+		as_vector_init(&w->vals, sizeof(as_val*), 4);
+	}
+
+	while (n_started < n_workers && pthread_create(&workers[n_started].thread,
+			NULL, agg_worker_run, &workers[n_started]) == 0) {
+		n_started++;
+	}
+
+	if (n_started < n_workers) {
+		as_error_update(err, AEROSPIKE_ERR_CLIENT,
+				"Unable to start reduce thread %u", n_started);
+	}
+
+	for (uint32_t i = 0; i < n_started; i++) {
+		pthread_join(workers[i].thread, NULL);
+
+		if (err->code == AEROSPIKE_OK && workers[i].err.code != AEROSPIKE_OK) {
+			as_error_copy(err, &workers[i].err);
+		}
+	}
+
+	if (err->code == AEROSPIKE_OK && !agg_merge(query, workers, n_workers,
+			data, err) && err->code == AEROSPIKE_OK) {
+		as_log_info("%s.%s changes reduced values after its first reduce(), "
+				"aggregating in one query", query->apply.module,
+				query->apply.function);
+		aerospike_query_foreach(g_aerospike, err, policy, query,
+				query_agg_renderer, data);
+	}
+	else if (err->code != AEROSPIKE_OK) {
+		query_agg_flush(data);
+	}
+
+	for (uint32_t i = 0; i < n_workers; i++) {
+		agg_worker* w = &workers[i];
+
+		for (uint32_t j = 0; j < w->vals.size; j++) {
+			as_val_destroy(as_vector_get_ptr(&w->vals, j));
+		}
+		as_vector_destroy(&w->vals);
+	}
+	free(workers);
+}
+
+static void*
+agg_worker_run(void* udata)
+{
+	agg_worker* w = (agg_worker*)udata;
+
+	aerospike_query_partitions(g_aerospike, &w->err, w->policy,
+			(as_query*)w->query, &w->pf, agg_worker_cb, w);
+	return NULL;
+}
+
+// Called from the thread running the range's reduce only.
+static bool
+agg_worker_cb(const as_val* val, void* udata)
+{
+	agg_worker* w = (agg_worker*)udata;
+
+	if (val) {
+		as_val* v = as_val_reserve(val);
+		as_vector_append(&w->vals, &v);
+	}
+	return !g_interrupted;
+}
+
+// Each range's client pass already ran the stream from its first reduce()
+// on. A stream with no reduce() has no client ops, its ranges' values are
+// final and rendered as is. Otherwise each range left one reduced value and
+// the client ops run once more over those, as the client does over the
+// nodes' partial results. Returns false when that would apply the ops after
+// the first reduce() twice, the caller then aggregates in one query.
+static bool
+agg_merge(const as_query* query, agg_worker* workers, uint32_t n_workers,
+		asql_query_data* data, as_error* err)
+{
+	as_vector in;
+	as_vector_init(&in, sizeof(as_val*), n_workers);
+	bool reduced = true;
+
+	for (uint32_t i = 0; i < n_workers; i++) {
+		for (uint32_t j = 0; j < workers[i].vals.size; j++) {
+			as_val* v = as_vector_get_ptr(&workers[i].vals, j);
+			as_vector_append(&in, &v);
+		}
+		reduced = reduced && workers[i].vals.size <= 1;
+	}
+
+	as_vector out;
+	as_vector_init(&out, sizeof(as_val*), 4);
+	bool merged = true;
+
+	if (!reduced || in.size <= 1) {
+		for (uint32_t i = 0; i < in.size; i++) {
+			as_val* v = as_val_reserve(as_vector_get_ptr(&in, i));
+			as_vector_append(&out, &v);
+		}
+	}
+	else if (agg_is_final(query, &in, err)) {
+		agg_client_apply(query, &in, &out, err);
+	}
+	else {
+		merged = false;
+	}
+
+	if (merged && err->code == AEROSPIKE_OK) {
+		for (uint32_t i = 0; i < out.size; i++) {
+			if (!query_agg_renderer(as_vector_get_ptr(&out, i), data)) {
+				break;
+			}
+		}
+		query_agg_renderer(NULL, data);
+	}
+
+	for (uint32_t i = 0; i < out.size; i++) {
+		as_val_destroy(as_vector_get_ptr(&out, i));
+	}
+	as_vector_destroy(&out);
+	as_vector_destroy(&in);
+	return merged;
+}
+
+// A reduce() of one value is that value, so the client ops give a range's
+// value back unchanged unless ops after the first reduce() rewrite it.
+static bool
+agg_is_final(const as_query* query, as_vector* vals, as_error* err)
+{
+	bool final = true;
+
+	for (uint32_t i = 0; i < vals->size && final; i++) {
+		as_vector one;
+		as_vector_inita(&one, sizeof(as_val*), 1);
+		as_vector_append(&one, as_vector_get(vals, i));
+
+		as_vector out;
+		as_vector_inita(&out, sizeof(as_val*), 1);
+
+		agg_client_apply(query, &one, &out, err);
+
+		final = err->code == AEROSPIKE_OK && out.size == 1 &&
+				agg_val_equal(as_vector_get_ptr(vals, i),
+						as_vector_get_ptr(&out, 0));
+
+		for (uint32_t j = 0; j < out.size; j++) {
+			as_val_destroy(as_vector_get_ptr(&out, j));
+		}
+		as_vector_destroy(&out);
+		as_vector_destroy(&one);
+	}
+	return final;
+}
+
+// Run the stream's client scope, its first reduce() and what follows, over
+// partial results.
+static void
+agg_client_apply(const as_query* query, as_vector* in, as_vector* out,
+		as_error* err)
+{
+	agg_merge_stream ms = { .in = in, .next = 0, .out = out };
+
+	as_aerospike as;
+	as_aerospike_init(&as, NULL, &agg_merge_hooks);
+	as_udf_context ctx = { .as = &as, .timer = NULL, .memtracker = NULL };
+
+	as_stream istream;
+	as_stream_init(&istream, &ms, &agg_merge_istream_hooks);
+
+	as_stream ostream;
+	as_stream_init(&ostream, &ms, &agg_merge_ostream_hooks);
+
+	as_result res;
+	as_result_init(&res);
+
+	int ret = as_module_apply_stream(&mod_lua, &ctx, query->apply.module,
+			query->apply.function, &istream, query->apply.arglist, &ostream,
+			&res);
+
+	if (ret != 0) {
+		as_string* msg = res.value ? as_string_fromval(res.value) : NULL;
+		as_error_update(err, AEROSPIKE_ERR_UDF, "Merging reduce results failed: %s",
+				msg ? as_string_get(msg) : "unknown error");
+	}
+
+	as_result_destroy(&res);
+	as_stream_destroy(&istream);
+	as_stream_destroy(&ostream);
+	as_aerospike_destroy(&as);
+}
+
+static bool
+agg_val_equal(const as_val* a, const as_val* b)
+{
+	as_val_t type = as_val_type(a);
+
+	if (type != as_val_type(b)) {
+		return false;
+	}
+
+	switch (type) {
+		case AS_NIL:
+			return true;
+		case AS_BOOLEAN:
+			return as_boolean_get((as_boolean*)a) == as_boolean_get((as_boolean*)b);
+		case AS_INTEGER:
+			return as_integer_get((as_integer*)a) == as_integer_get((as_integer*)b);
+		case AS_DOUBLE:
+			return as_double_get((as_double*)a) == as_double_get((as_double*)b);
+		case AS_STRING:
+			return strcmp(as_string_get((as_string*)a),
+					as_string_get((as_string*)b)) == 0;
+		case AS_BYTES: {
+			as_bytes* ba = (as_bytes*)a;
+			as_bytes* bb = (as_bytes*)b;
+			return ba->size == bb->size &&
+					memcmp(ba->value, bb->value, ba->size) == 0;
+		}
+		case AS_LIST: {
+			as_list* la = (as_list*)a;
+			as_list* lb = (as_list*)b;
+			uint32_t n = as_list_size(la);
+
+			if (n != as_list_size(lb)) {
+				return false;
+			}
+
+			for (uint32_t i = 0; i < n; i++) {
+				if (!agg_val_equal(as_list_get(la, i), as_list_get(lb, i))) {
+					return false;
+				}
+			}
+			return true;
+		}
+		case AS_MAP:
+			// Lua tables come back in their own key order.
+			return as_map_size((as_map*)a) == as_map_size((as_map*)b) &&
+					as_map_foreach((as_map*)a, agg_map_equal_cb, (void*)b);
+		default:
+			return false;
+	}
+}
+
+static bool
+agg_map_equal_cb(const as_val* k, const as_val* v, void* udata)
+{
+	as_val* other = as_map_get((as_map*)udata, k);
+	return other && agg_val_equal(v, other);
+}
+
+static as_val*
+agg_merge_read(const as_stream* s)
+{
+	agg_merge_stream* ms = (agg_merge_stream*)as_stream_source(s);
+
+	if (ms->next >= ms->in->size) {
+		return NULL;
+	}
+
+	// The stream owns what it reads.
+	return as_val_reserve(as_vector_get_ptr(ms->in, ms->next++));
+}
+
+static as_stream_status
+agg_merge_write(const as_stream* s, as_val* v)
+{
+	if (v) {
+		agg_merge_stream* ms = (agg_merge_stream*)as_stream_source(s);
+		as_vector_append(ms->out, &v);
+	}
+	return AS_STREAM_OK;
+}
@@ -19,29 +19,95 @@
 // Includes.
 //
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
 
 #include <aerospike/aerospike.h>
+#include <aerospike/aerospike_info.h>
 #include <aerospike/aerospike_scan.h>
+#include <aerospike/aerospike_truncate.h>
 #include <aerospike/as_aerospike.h>
 #include <aerospike/as_config.h>
 #include <aerospike/as_error.h>
+#include <aerospike/as_msgpack.h>
+#include <aerospike/as_node.h>
 #include <aerospike/as_scan.h>
 
 #include <aerospike/as_arraylist.h>
+#include <aerospike/as_hashmap.h>
 #include <aerospike/as_list.h>
+#include <aerospike/as_string.h>
 
 #include <renderer.h>
 #include <asql.h>
+#include <asql_compare.h>
+#include <asql_profile.h>
+#include <asql_info_parser.h>
+#include <asql_key.h>
 #include <asql_scan.h>
 
+//=========================================================
+// Typedefs & constants.
+//
+
+typedef struct {
+	const char* stat;
+	uint64_t sum;
+	uint64_t max;
+} info_stat;
+
+typedef struct {
+	void* rview;
+	uint64_t rows;
+} tail_udata;
+
+// One node of SCAN NODES, scanned on its own thread.
+typedef struct {
+	char name[AS_NODE_NAME_SIZE];
+	pthread_t thread;
+	as_error err;
+	const as_policy_scan* policy;
+	const as_scan* scan;
+	as_serializer ser;
+	uint64_t records;
+	uint64_t bytes;
+	uint64_t elapsed_ms;
+} node_scan;
+
+// Granularity at which TAIL notices Ctrl-C while waiting between passes.
+#define TAIL_POLL_MS 100
+
+// TRUNCATE progress is polled until the object count reaches 0.
+#define TRUNCATE_POLL_MS 500
+#define TRUNCATE_WAIT_MS (60 * 1000)
+
+
 //=========================================================
 // Forward Declarations.
 //
 
 extern int asql_query_aggregate(asql_config* c, scan_config* s);
+extern void asql_query_render_count(uint64_t count);
+extern void asql_filter_since(as_exp** filter, int64_t since);
 
 static int scan_select(asql_config* c, scan_config* s);
 static int scan_execute(asql_config* c, scan_config* s);
+static int scan_update(asql_config* c, scan_config* s);
+static int scan_count(asql_config* c, scan_config* s);
+static int scan_count_records(asql_config* c, scan_config* s);
+static bool ns_migrating(asql_config* c, const char* ns, as_error* err);
+static bool count_callback(const as_val* val, void* udata);
+static int scan_tail(asql_config* c, scan_config* s);
+static int scan_truncate(asql_config* c, scan_config* s);
+static int scan_nodes(asql_config* c, scan_config* s);
+static void* node_scan_run(void* udata);
+static bool node_scan_callback(const as_val* val, void* udata);
+static int node_scan_cmp(const void* a, const void* b);
+static bool tail_callback(const as_val* val, void* udata);
+static bool info_stat_cb(const as_error* err, const as_node* node, const char* req, char* res, void* udata);
 
 
 //=========================================================
@@ -55,16 +121,80 @@ asql_scan(asql_config* c, aconfig* ac)
 
 	switch (s->optype) {
 		case ASQL_OP_SELECT:
+			if (s->s.count) {
+				return s->s.since ? scan_count_records(c, s) : scan_count(c, s);
+			}
+			return scan_select(c, s);
+		case ASQL_OP_INSERT:
+			// INSERT INTO ... SELECT
 			return scan_select(c, s);
 		case ASQL_OP_EXECUTE:
 			return scan_execute(c, s);
+		case ASQL_OP_UPDATE:
+		case ASQL_OP_TOUCH:
+			return scan_update(c, s);
 		case ASQL_OP_AGGREGATE:
 			return asql_query_aggregate(c, s);
+		case ASQL_OP_TAIL:
+			return scan_tail(c, s);
+		case ASQL_OP_COMPARE:
+			return asql_compare(c, s);
+		case ASQL_OP_PROFILE:
+			return asql_profile(c, s);
+		case ASQL_OP_SCAN:
+			return scan_nodes(c, s);
+		case ASQL_OP_TRUNCATE:
+			return scan_truncate(c, s);
 		default:
 			return 0;
 	}
 }
 
+// Set (or namespace) object counts summed over all nodes, divided by the
+// replication factor.
+as_status
+asql_set_object_count(asql_config* c, const char* ns, const char* set,
+		uint64_t* count, as_error* err)
+{
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	char ns_req[256];
+	snprintf(ns_req, sizeof(ns_req), "namespace/%s", ns);
+
+	char objects_req[256];
+	if (set) {
+		snprintf(objects_req, sizeof(objects_req), "sets/%s/%s", ns, set);
+	}
+	else {
+		snprintf(objects_req, sizeof(objects_req), "%s", ns_req);
+	}
+
+	info_stat objects = { .stat = "objects", .sum = 0, .max = 0 };
+	info_stat rf = { .stat = "effective_replication_factor", .sum = 0, .max = 0 };
+
+	if (aerospike_info_foreach(g_aerospike, err, &info_policy, objects_req,
+			info_stat_cb, &objects) == AEROSPIKE_OK) {
+		aerospike_info_foreach(g_aerospike, err, &info_policy, ns_req,
+				info_stat_cb, &rf);
+	}
+
+	if (err->code == AEROSPIKE_OK && rf.max == 0) {
+		// Servers older than 4.3 only report the configured factor.
+		rf.stat = "replication-factor";
+		aerospike_info_foreach(g_aerospike, err, &info_policy, ns_req,
+				info_stat_cb, &rf);
+	}
+
+	if (err->code != AEROSPIKE_OK) {
+		return err->code;
+	}
+
+	*count = objects.sum / (rf.max ? rf.max : 1);
+	return AEROSPIKE_OK;
+}
+
 
 //=========================================================
 // Local Helpers.
@@ -78,12 +208,8 @@ scan_select(asql_config* c, scan_config* s)
 	as_error_init(&err);
 
 	as_policy_scan scan_policy;
-	as_policy_scan_init(&scan_policy);
-	scan_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		scan_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
 	scan_policy.durable_delete = c->durable_delete;
 	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
 
@@ -105,15 +231,43 @@ scan_select(asql_config* c, scan_config* s)
 		return 1;
 	}
 
+	// ON NODE, output is labeled with the node.
+	as_node* node = NULL;
+
+	if (s->node) {
+		node = as_node_get_by_name(g_aerospike->cluster, s->node);
+
+		if (!node) {
+			char err_msg[1024];
+			snprintf(err_msg, 1023, "Node not found: '%s'", s->node);
+			g_renderer->render_error(AEROSPIKE_ERR_PARAM, err_msg, NULL);
+			return 1;
+		}
+	}
+
+	if (s->s.since) {
+		asql_filter_since(&scan_policy.base.filter_exp, s->s.since);
+	}
+
 	as_scan scan;
 	as_scan_init(&scan, s->ns, s->set);
 	scan.no_bins = c->no_bins;
+	scan.concurrent = c->concurrent;
 	bool select_all = false;
 
 	if (!s->s.bnames) {
 		// select all bins
 		select_all = true;
 	}
+	else if (s->s.header) {
+		// {ttl}, {gen} are in the record header
+		scan.no_bins = true;
+	}
+	else if (s->s.projs) {
+		// select CDT paths, evaluated on the server as read operations
+		scan.ops = as_operations_new(s->s.projs->size);
+		asql_projection_ops_init(&err, &s->s, scan.ops);
+	}
 	else {
 		// select specific bins
 		select_all = false;
@@ -131,14 +285,54 @@ scan_select(asql_config* c, scan_config* s)
 		}
 	}
 
-	void* rview = g_renderer->view_new(CLUSTER);
+	if (s->optype == ASQL_OP_INSERT) {
+		// Records go straight from the scan into batch writes.
+		asql_copy* cp = err.code == AEROSPIKE_OK
+				? asql_copy_create(c, &s->into, s->set, &err) : NULL;
+
+		if (cp) {
+			scan.concurrent = true;
+
+			if (node) {
+				aerospike_scan_node(g_aerospike, &err, &scan_policy, &scan,
+						node->name, asql_copy_callback, cp);
+			}
+			else {
+				aerospike_scan_foreach(g_aerospike, &err, &scan_policy, &scan,
+						asql_copy_callback, cp);
+			}
+			asql_copy_finish(cp, &err);
+		}
+		else {
+			g_renderer->render_error(err.code, err.message, NULL);
+		}
+
+		if (node) {
+			as_node_release(node);
+		}
+		as_scan_destroy(&scan);
+		as_exp_destroy(scan_policy.base.filter_exp);
+		return 0;
+	}
+
+	void* rview = g_renderer->view_new(node ? node : CLUSTER);
 
 	if (err.code == AEROSPIKE_OK) {
 		if (! select_all) {
 			g_renderer->view_set_cols(s->s.bnames, rview);
 		}
-		aerospike_scan_foreach(g_aerospike, &err, &scan_policy, &scan,
-		                       g_renderer->render, rview);
+
+		if (node) {
+			aerospike_scan_node(g_aerospike, &err, &scan_policy, &scan,
+					node->name,
+					s->s.header ? asql_render_header : g_renderer->render,
+					rview);
+		}
+		else {
+			aerospike_scan_foreach(g_aerospike, &err, &scan_policy, &scan,
+			                       s->s.header ? asql_render_header : g_renderer->render,
+			                       rview);
+		}
 	}
 
 	if (err.code == AEROSPIKE_OK) {
@@ -148,7 +342,12 @@ scan_select(asql_config* c, scan_config* s)
 	}
 
 	g_renderer->view_destroy(rview);
+
+	if (node) {
+		as_node_release(node);
+	}
 	as_scan_destroy(&scan);
+	as_exp_destroy(scan_policy.base.filter_exp);
 
 	return 0;
 }
@@ -160,12 +359,8 @@ scan_execute(asql_config* c, scan_config* s)
 	as_error_init(&err);
 
 	as_policy_scan scan_policy;
-	as_policy_scan_init(&scan_policy);
-	scan_policy.base.total_timeout = c->base.timeout_ms;
-	if (c->base.socket_timeout_ms > -1) {
-		// set if non-default value
-		scan_policy.base.socket_timeout = c->base.socket_timeout_ms;
-	}
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
 	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
 
 	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
@@ -222,3 +417,604 @@ scan_execute(asql_config* c, scan_config* s)
 
 	return 0;
 }
+
+// Apply UPDATE/TOUCH operations to every record of the set as a background
+// scan job. No UDF is involved.
+static int
+scan_update(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_scan scan_policy;
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
+	scan_policy.durable_delete = c->durable_delete;
+	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_scan scan;
+	as_scan_init(&scan, s->ns, s->set);
+	scan.ttl = s->up.has_ttl ? s->up.ttl : c->record_ttl_sec;
+
+	// NB: scan object owns ops, destroyed by as_scan_destroy
+	scan.ops = as_operations_new(s->up.ops->size);
+	asql_update_ops_init(&err, s->up.ops, scan.ops);
+
+	uint64_t scanid = 0;
+	if (err.code == AEROSPIKE_OK) {
+		aerospike_scan_background(g_aerospike, &err, &scan_policy, &scan,
+				&scanid);
+	}
+
+	if (err.code == AEROSPIKE_OK) {
+		char ok_msg[1024];
+		snprintf(ok_msg, 1023, "Scan job (%"PRIu64") created.", scanid);
+		g_renderer->render_ok(ok_msg, NULL);
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_scan_destroy(&scan);
+
+	return 0;
+}
+
+// COUNT(*) without a WHERE clause is answered from set metadata, no records
+// are read. Per-node object counts divided by the replication factor are only
+// exact while no partitions migrate, during migrations records are counted.
+static int
+scan_count(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	if (ns_migrating(c, s->ns, &err)) {
+		return scan_count_records(c, s);
+	}
+
+	if (err.code != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	uint64_t count = 0;
+
+	if (asql_set_object_count(c, s->ns, s->set, &count, &err) != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	asql_query_render_count(count);
+	return 0;
+}
+
+static bool
+info_stat_cb(const as_error* err, const as_node* node, const char* req,
+		char* res, void* udata)
+{
+	if (err->code != AEROSPIKE_OK) {
+		return false;
+	}
+
+	char* resp = info_res_split(res);
+
+	if (resp == NULL) {
+		return true;
+	}
+
+	resp = strdup(resp);
+
+	info_stat* stat = (info_stat*)udata;
+	as_vector* parsed_result = as_vector_create(sizeof(as_hashmap*), 1);
+
+	list_res_parser(parsed_result, node, req, resp);
+
+	as_string key;
+	as_string_init(&key, (char*)stat->stat, false);
+
+	for (uint32_t i = 0; i < parsed_result->size; i++) {
+		as_hashmap* map = as_vector_get_ptr(parsed_result, i);
+		const char* val = as_string_get(as_string_fromval(
+				as_hashmap_get(map, as_string_toval(&key))));
+
+		if (val) {
+			uint64_t v = strtoull(val, NULL, 10);
+			stat->sum += v;
+
+			if (v > stat->max) {
+				stat->max = v;
+			}
+		}
+		as_hashmap_destroy(map);
+	}
+
+	as_vector_destroy(parsed_result);
+	free(resp);
+	return true;
+}
+
+// Whether any node still has partitions to send or receive for the namespace.
+static bool
+ns_migrating(asql_config* c, const char* ns, as_error* err)
+{
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	char ns_req[256];
+	snprintf(ns_req, sizeof(ns_req), "namespace/%s", ns);
+
+	info_stat rx = { .stat = "migrate_rx_partitions_remaining", .sum = 0, .max = 0 };
+	info_stat tx = { .stat = "migrate_tx_partitions_remaining", .sum = 0, .max = 0 };
+
+	if (aerospike_info_foreach(g_aerospike, err, &info_policy, ns_req,
+			info_stat_cb, &rx) == AEROSPIKE_OK) {
+		aerospike_info_foreach(g_aerospike, err, &info_policy, ns_req,
+				info_stat_cb, &tx);
+	}
+
+	return err->code == AEROSPIKE_OK && (rx.sum != 0 || tx.sum != 0);
+}
+
+// Exact COUNT(*), digests of a no-bin scan are counted. Used for SINCE, which
+// set metadata can't answer, and while partitions migrate.
+static int
+scan_count_records(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	as_policy_scan scan_policy;
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
+	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
+
+	if (s->s.since) {
+		asql_filter_since(&scan_policy.base.filter_exp, s->s.since);
+	}
+
+	as_scan scan;
+	as_scan_init(&scan, s->ns, s->set);
+	scan.no_bins = true;
+
+	atomic_uint_fast64_t count;
+	atomic_init(&count, 0);
+
+	aerospike_scan_foreach(g_aerospike, &err, &scan_policy, &scan,
+			count_callback, &count);
+
+	if (err.code == AEROSPIKE_OK) {
+		asql_query_render_count(atomic_load(&count));
+	}
+	else {
+		g_renderer->render_error(err.code, err.message, NULL);
+	}
+
+	as_scan_destroy(&scan);
+
+	if (s->s.since) {
+		as_exp_destroy(scan_policy.base.filter_exp);
+	}
+	return 0;
+}
+
+static bool
+count_callback(const as_val* val, void* udata)
+{
+	if (val) {
+		atomic_fetch_add((atomic_uint_fast64_t*)udata, 1);
+	}
+	return true;
+}
+
+// TAIL scans repeatedly for records updated since the previous pass started.
+// The watermark comes from the client clock, so records written while a pass
+// runs may show up again in the next one. Stops on Ctrl-C.
+static int
+scan_tail(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	// Nothing interrupts a --serve or libaql statement, and every other
+	// caller waits for it.
+	if (c->base.shared) {
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT,
+				"TAIL runs until Ctrl-C, it is not available in --serve and libaql sessions",
+				NULL);
+		return 1;
+	}
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_policy_scan scan_policy;
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
+	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
+
+	as_scan scan;
+	as_scan_init(&scan, s->ns, s->set);
+
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	int64_t watermark = (int64_t)now.tv_sec * 1000000000L + now.tv_nsec;
+
+	char msg[256];
+	snprintf(msg, sizeof(msg), "Tailing %s%s%s every %u ms, Ctrl-C to stop.",
+			s->ns, s->set ? "." : "", s->set ? s->set : "", s->interval_ms);
+	g_renderer->render_progress(msg, NULL);
+	g_renderer->render_progress(NULL, NULL);
+
+	g_interrupted = 0;
+
+	while (!g_interrupted) {
+		for (uint32_t waited = 0; waited < s->interval_ms && !g_interrupted;
+				waited += TAIL_POLL_MS) {
+			usleep(TAIL_POLL_MS * 1000);
+		}
+
+		if (g_interrupted) {
+			break;
+		}
+
+		clock_gettime(CLOCK_REALTIME, &now);
+		int64_t next = (int64_t)now.tv_sec * 1000000000L + now.tv_nsec;
+
+		as_exp_destroy(scan_policy.base.filter_exp);
+		scan_policy.base.filter_exp = NULL;
+		asql_filter_since(&scan_policy.base.filter_exp, watermark);
+
+		tail_udata udata = { .rview = g_renderer->view_new(CLUSTER), .rows = 0 };
+
+		aerospike_scan_foreach(g_aerospike, &err, &scan_policy, &scan,
+				tail_callback, &udata);
+
+		if (err.code != AEROSPIKE_OK) {
+			g_renderer->render_error(err.code, err.message, udata.rview);
+			g_renderer->view_destroy(udata.rview);
+			break;
+		}
+
+		if (udata.rows) {
+			g_renderer->render_ok("", udata.rview);
+		}
+		g_renderer->view_destroy(udata.rview);
+		watermark = next;
+	}
+
+	as_scan_destroy(&scan);
+	as_exp_destroy(scan_policy.base.filter_exp);
+	return 0;
+}
+
+// Only render passes that found records, stop the scan on Ctrl-C.
+static bool
+tail_callback(const as_val* val, void* udata)
+{
+	tail_udata* tu = (tail_udata*)udata;
+
+	if (!val) {
+		if (tu->rows) {
+			g_renderer->render(val, tu->rview);
+		}
+		return false;
+	}
+
+	if (g_interrupted) {
+		return false;
+	}
+
+	tu->rows++;
+	return g_renderer->render(val, tu->rview);
+}
+
+// TRUNCATE is a metadata operation on the server, records are dropped in the
+// background. Progress is the object count falling to 0.
+static int
+scan_truncate(asql_config* c, scan_config* s)
+{
+	as_error err;
+	as_error_init(&err);
+
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	// Only ask when someone can answer, scripts run unattended. A --serve
+	// session's stdin is the daemon's, not the client's.
+	if (!c->base.unattended && isatty(STDIN_FILENO)) {
+		char prompt[256];
+		snprintf(prompt, sizeof(prompt), "Truncate %s records of %s%s%s? [y/N] ",
+				s->before ? "older" : "all", s->ns, s->set ? "." : "",
+				s->set ? s->set : "");
+		g_renderer->render_progress(prompt, NULL);
+
+		char answer[16];
+		if (!fgets(answer, sizeof(answer), stdin)
+				|| (answer[0] != 'y' && answer[0] != 'Y')) {
+			g_renderer->render_ok("Truncate cancelled.", NULL);
+			return 0;
+		}
+	}
+
+	as_policy_info info_policy;
+	as_policy_info_init(&info_policy);
+	info_policy.timeout = c->base.timeout_ms;
+
+	if (aerospike_truncate(g_aerospike, &err, &info_policy, s->ns, s->set,
+			(uint64_t)s->before) != AEROSPIKE_OK) {
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 1;
+	}
+
+	// Records newer than BEFORE stay, the count never reaches 0.
+	if (s->before) {
+		g_renderer->render_ok("Truncate accepted, older records are removed in the background.",
+				NULL);
+		return 0;
+	}
+
+	// Other --serve sessions and libaql callers would wait on the poll.
+	if (c->base.shared) {
+		g_renderer->render_ok("Truncate accepted, records are removed in the background.",
+				NULL);
+		return 0;
+	}
+
+	uint64_t left = 0;
+	uint64_t prev = UINT64_MAX;
+	uint64_t deadline = cf_getms() + TRUNCATE_WAIT_MS;
+	g_interrupted = 0;
+
+	// Nodes drop records at their own pace, a count that holds still for one
+	// poll is not done.
+	while (!g_interrupted) {
+		if (asql_set_object_count(c, s->ns, s->set, &left, &err) != AEROSPIKE_OK) {
+			break;
+		}
+
+		if (left != prev) {
+			char msg[64];
+			snprintf(msg, sizeof(msg), "%" PRIu64 " records left", left);
+			g_renderer->render_progress(msg, NULL);
+			prev = left;
+		}
+
+		if (left == 0 || cf_getms() >= deadline) {
+			break;
+		}
+
+		usleep(TRUNCATE_POLL_MS * 1000);
+	}
+
+	if (prev != UINT64_MAX) {
+		g_renderer->render_progress(NULL, NULL);
+	}
+
+	if (err.code != AEROSPIKE_OK) {
+		// The truncate itself was accepted.
+		as_error_append(&err, "\nTruncate was accepted, progress is unknown");
+		g_renderer->render_error(err.code, err.message, NULL);
+		return 0;
+	}
+
+	if (left != 0) {
+		char msg[128];
+		snprintf(msg, sizeof(msg),
+				"Truncate was accepted, %" PRIu64 " records still left%s", left,
+				g_interrupted ? "" : " when the wait timed out");
+		g_renderer->render_error(g_interrupted ? AEROSPIKE_ERR_CLIENT_ABORT :
+				AEROSPIKE_ERR_TIMEOUT, msg, NULL);
+		return 1;
+	}
+
+	g_renderer->render_ok("Truncate done.", NULL);
+	return 0;
+}
+
+// SCAN NODES: scan each node on its own thread and report its throughput,
+// slowest node first.
+static int
+scan_nodes(asql_config* c, scan_config* s)
+{
+	if (strlen(s->ns) >= AS_NAMESPACE_MAX_SIZE) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Namespace name is too long: '%s'", s->ns);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	if (s->set && (strlen(s->set) >= AS_SET_MAX_SIZE)) {
+		char err_msg[1024];
+		snprintf(err_msg, 1023, "Set name is too long: '%s'", s->set);
+		g_renderer->render_error(AEROSPIKE_ERR_CLIENT, err_msg, NULL);
+		return 1;
+	}
+
+	as_policy_scan scan_policy;
+	as_policy_scan_copy(&g_aerospike->config.policies.scan, &scan_policy);
+	asql_policy_base_init(c, &scan_policy.base);
+	scan_policy.records_per_second = (uint32_t)c->scan_records_per_second;
+
+	as_scan scan;
+	as_scan_init(&scan, s->ns, s->set);
+	scan.no_bins = c->no_bins;
+
+	as_nodes* nodes = as_nodes_reserve(g_aerospike->cluster);
+	uint32_t n_nodes = nodes->size;
+	node_scan* scans = calloc(n_nodes, sizeof(node_scan));
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		strcpy(scans[i].name, nodes->array[i]->name);
+		as_error_init(&scans[i].err);
+		scans[i].policy = &scan_policy;
+		scans[i].scan = &scan;
+		as_msgpack_init(&scans[i].ser);
+	}
+	as_nodes_release(nodes);
+
+	uint32_t n_started = 0;
+
+	while (n_started < n_nodes && pthread_create(&scans[n_started].thread,
+			NULL, node_scan_run, &scans[n_started]) == 0) {
+		n_started++;
+	}
+
+	// Nodes left unscanned report the failure instead of 0 records.
+	for (uint32_t i = n_started; i < n_nodes; i++) {
+		as_error_update(&scans[i].err, AEROSPIKE_ERR_CLIENT,
+				"Unable to start scan thread");
+	}
+
+	for (uint32_t i = 0; i < n_started; i++) {
+		pthread_join(scans[i].thread, NULL);
+	}
+
+	qsort(scans, n_nodes, sizeof(node_scan), node_scan_cmp);
+
+	as_vector cols;
+	as_vector_inita(&cols, sizeof(char*), 7);
+	const char* names[] = { "node", "records", "bytes", "elapsed_ms",
+			"records/s", "bytes/s", "status" };
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		as_vector_append(&cols, &names[i]);
+	}
+
+	void* rview = g_renderer->view_new(CLUSTER);
+	g_renderer->view_set_cols(&cols, rview);
+
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		node_scan* n = &scans[i];
+		uint64_t ms = n->elapsed_ms ? n->elapsed_ms : 1;
+
+		as_hashmap m;
+		as_hashmap_init(&m, 8);
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("node"),
+				(as_val*)as_string_new_strdup(n->name));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("records"),
+				(as_val*)as_integer_new((int64_t)n->records));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("bytes"),
+				(as_val*)as_integer_new((int64_t)n->bytes));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("elapsed_ms"),
+				(as_val*)as_integer_new((int64_t)n->elapsed_ms));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("records/s"),
+				(as_val*)as_integer_new((int64_t)(n->records * 1000 / ms)));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("bytes/s"),
+				(as_val*)as_integer_new((int64_t)(n->bytes * 1000 / ms)));
+		as_hashmap_set(&m, (as_val*)as_string_new_strdup("status"),
+				(as_val*)as_string_new_strdup(n->err.code == AEROSPIKE_OK ?
+						"OK" : n->err.message));
+
+		g_renderer->render((as_val*)&m, rview);
+		as_hashmap_destroy(&m);
+		as_serializer_destroy(&n->ser);
+	}
+
+	g_renderer->render(NULL, rview);
+	g_renderer->render_ok("", rview);
+	g_renderer->view_destroy(rview);
+
+	as_vector_destroy(&cols);
+	as_scan_destroy(&scan);
+	free(scans);
+	return 0;
+}
+
+static void*
+node_scan_run(void* udata)
+{
+	node_scan* n = (node_scan*)udata;
+	uint64_t start = cf_getms();
+
+	aerospike_scan_node(g_aerospike, &n->err, n->policy, n->scan, n->name,
+			node_scan_callback, n);
+
+	n->elapsed_ms = cf_getms() - start;
+	return NULL;
+}
+
+// A node scan is a single command, records arrive on one thread. Bytes are
+// the bins' msgpack size, what the records cost on the wire give or take
+// the headers.
+static bool
+node_scan_callback(const as_val* val, void* udata)
+{
+	if (!val) {
+		return true;
+	}
+
+	node_scan* n = (node_scan*)udata;
+	as_record* rec = as_record_fromval(val);
+
+	if (!rec) {
+		return true;
+	}
+
+	n->records++;
+
+	for (uint16_t i = 0; i < rec->bins.size; i++) {
+		as_bin* bin = &rec->bins.entries[i];
+		n->bytes += strlen(bin->name);
+
+		if (bin->valuep) {
+			n->bytes += as_serializer_serialize_getsize(&n->ser,
+					(as_val*)bin->valuep);
+		}
+	}
+
+	return !g_interrupted;
+}
+
+// Ascending records/s, failed nodes first.
+static int
+node_scan_cmp(const void* a, const void* b)
+{
+	const node_scan* na = (const node_scan*)a;
+	const node_scan* nb = (const node_scan*)b;
+
+	if ((na->err.code != AEROSPIKE_OK) != (nb->err.code != AEROSPIKE_OK)) {
+		return na->err.code != AEROSPIKE_OK ? -1 : 1;
+	}
+
+	double ra = (double)na->records / (na->elapsed_ms ? na->elapsed_ms : 1);
+	double rb = (double)nb->records / (nb->elapsed_ms ? nb->elapsed_ms : 1);
+	return ra < rb ? -1 : ra > rb ? 1 : 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <renderer.h>
+#include <asql.h>
+#include <asql_serve.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+#define SERVE_BACKLOG 128
+#define SERVE_BUF_SIZE (64 * 1024)
+
+// One thin client connection. Settings changed with SET only live as long as
+// the session.
+typedef struct {
+	int fd;
+	asql_config conf;
+	renderer* rend;
+} serve_session;
+
+
+//=========================================================
+// Globals.
+//
+
+extern asql_config* g_config;
+extern renderer* g_renderer;
+extern bool g_inprogress;
+extern volatile sig_atomic_t g_interrupted;
+
+// Statements write through stdout and read g_config / g_renderer, so sessions
+// take turns executing while their sockets are read concurrently. The
+// daemon saves the connect per statement, it does not run statements from
+// different sessions in parallel. The statement arena (asql_arena.c) relies
+// on this lock too.
+static pthread_mutex_t s_exec_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char s_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static void* serve_session_run(void* udata);
+static bool serve_statement(serve_session* s, char* cmd);
+static void serve_unlink(void);
+
+
+//=========================================================
+// Public API.
+//
+
+bool
+asql_serve(asql_config* c, const char* path)
+{
+	if (strlen(path) >= sizeof(s_path)) {
+		fprintf(stderr, "Socket path %s is too long\n", path);
+		return false;
+	}
+
+	int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (lfd < 0) {
+		fprintf(stderr, "Error creating socket: %s\n", strerror(errno));
+		return false;
+	}
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	// Remove a stale socket left by a previous daemon, but nothing else.
+	struct stat st;
+
+	if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(path);
+	}
+
+	// Statements run with this process' credentials, keep the socket to the
+	// owner.
+	mode_t old_mask = umask(0077);
+	int rv = bind(lfd, (struct sockaddr*)&addr, sizeof(addr));
+	umask(old_mask);
+
+	if (rv < 0 || listen(lfd, SERVE_BACKLOG) < 0) {
+		fprintf(stderr, "Error listening on %s: %s\n", path, strerror(errno));
+		close(lfd);
+		return false;
+	}
+
+	strcpy(s_path, path);
+	atexit(serve_unlink);
+
+	fprintf(stdout, "Serving on %s\n", path);
+	fflush(stdout);
+
+	while (true) {
+		int fd = accept(lfd, NULL, NULL);
+
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+
+			fprintf(stderr, "Error accepting on %s: %s\n", path,
+					strerror(errno));
+			break;
+		}
+
+		serve_session* s = malloc(sizeof(serve_session));
+		s->fd = fd;
+
+		// Sessions start from the daemon's settings, echo statements like
+		// -c does and never prompt. The only string SET option is owned per
+		// session.
+		memcpy(&s->conf, c, sizeof(asql_config));
+		s->conf.base.echo = true;
+		s->conf.base.unattended = true;
+		s->conf.base.shared = true;
+		s->conf.base.lua_userpath = c->base.lua_userpath
+				? strdup(c->base.lua_userpath) : NULL;
+		s->rend = g_renderer;
+
+		pthread_t thread;
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+		if (pthread_create(&thread, &attr, serve_session_run, s) != 0) {
+			fprintf(stderr, "Error starting session thread\n");
+			free(s->conf.base.lua_userpath);
+			free(s);
+			close(fd);
+		}
+
+		pthread_attr_destroy(&attr);
+	}
+
+	close(lfd);
+	return false;
+}
+
+int
+asql_serve_client(const char* path, const char* cmd, int in_fd)
+{
+	struct sockaddr_un addr;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path %s is too long\n", path);
+		return -1;
+	}
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (fd < 0) {
+		fprintf(stderr, "Error creating socket: %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "Error connecting to aql daemon at %s: %s\n", path,
+				strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	char* buf = malloc(SERVE_BUF_SIZE);
+	bool ok = true;
+
+	// Send the whole batch up front and half close, so a pipeline costs one
+	// round trip instead of a cluster connect.
+	if (cmd) {
+		size_t len = strlen(cmd);
+		ok = send(fd, cmd, len, MSG_NOSIGNAL) == (ssize_t)len
+				&& send(fd, "\n", 1, MSG_NOSIGNAL) == 1;
+	}
+	else {
+		ssize_t n;
+
+		while (ok && (n = read(in_fd, buf, SERVE_BUF_SIZE)) > 0) {
+			ok = send(fd, buf, n, MSG_NOSIGNAL) == n;
+		}
+	}
+
+	shutdown(fd, SHUT_WR);
+
+	ssize_t n;
+
+	while ((n = recv(fd, buf, SERVE_BUF_SIZE, 0)) > 0) {
+		if (fwrite(buf, 1, n, stdout) != (size_t)n) {
+			ok = false;
+			break;
+		}
+	}
+
+	fflush(stdout);
+	free(buf);
+	close(fd);
+
+	if (! ok || n < 0) {
+		fprintf(stderr, "Error talking to aql daemon at %s\n", path);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+//=========================================================
+// Local API.
+//
+
+static void*
+serve_session_run(void* udata)
+{
+	serve_session* s = (serve_session*)udata;
+	FILE* in = fdopen(dup(s->fd), "r");
+
+	if (in) {
+		char* line = NULL;
+		size_t cap = 0;
+		ssize_t len;
+
+		while ((len = getline(&line, &cap, in)) > 0) {
+			while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+				line[--len] = 0;
+			}
+
+			if (len == 0) {
+				continue;
+			}
+
+			if (! serve_statement(s, line)) {
+				break;
+			}
+		}
+
+		free(line);
+		fclose(in);
+	}
+
+	close(s->fd);
+	free(s->conf.base.lua_userpath);
+	free(s);
+	return NULL;
+}
+
+// Runs one line in the session's context with stdout and stderr pointing at
+// the client. Returns false when the session should end.
+static bool
+serve_statement(serve_session* s, char* cmd)
+{
+	pthread_mutex_lock(&s_exec_lock);
+
+	fflush(stdout);
+	fflush(stderr);
+
+	int saved_out = dup(STDOUT_FILENO);
+	int saved_err = dup(STDERR_FILENO);
+
+	dup2(s->fd, STDOUT_FILENO);
+	dup2(s->fd, STDERR_FILENO);
+
+	asql_config* saved_config = g_config;
+	renderer* saved_renderer = g_renderer;
+
+	g_config = &s->conf;
+	g_renderer = s->rend;
+	g_interrupted = 0;
+	g_inprogress = true;
+
+	bool rv = parse_and_run_colon_delim(&s->conf, cmd);
+
+	g_inprogress = false;
+
+	fflush(stdout);
+	fflush(stderr);
+
+	// SET OUTPUT switches g_renderer, keep it for the session.
+	s->rend = g_renderer;
+	g_config = saved_config;
+	g_renderer = saved_renderer;
+
+	dup2(saved_out, STDOUT_FILENO);
+	dup2(saved_err, STDERR_FILENO);
+	close(saved_out);
+	close(saved_err);
+
+	pthread_mutex_unlock(&s_exec_lock);
+	return rv;
+}
+
+static void
+serve_unlink(void)
+{
+	if (s_path[0]) {
+		unlink(s_path);
+	}
+}
@@ -53,6 +53,7 @@ destroy_tokenizer(tokenizer* tknzr)
 	if (tknzr->ocmd) {
 		free(tknzr->ocmd);
 	}
+	free(tknzr->tok_copy);
 	yylex_destroy();
 }
 
@@ -19,10 +19,18 @@
 // Includes.
 //
 
+#include <aerospike/as_boolean.h>
+#include <aerospike/as_double.h>
+#include <aerospike/as_geojson.h>
+#include <aerospike/as_integer.h>
+#include <aerospike/as_nil.h>
+#include <aerospike/as_string.h>
+
 #include <json.h>
 #include <jansson.h>
 #include <asql_value.h>
 #include <asql.h>
+#include <asql_arena.h>
 
 
 //==========================================================
@@ -162,6 +170,49 @@ asql_set_args(as_error* err, as_vector* udfargs, as_arraylist* arglist)
 	return 0;
 }
 
+// Convert a parsed value into a new as_val. JSON, LIST and MAP values are
+// expanded to CDTs. Returns NULL and sets err on failure.
+as_val*
+asql_value_to_val(as_error* err, asql_value* value)
+{
+	switch (value->type) {
+		case AS_NIL:
+			return (as_val*)&as_nil;
+		case AS_INTEGER:
+			return (as_val*)as_integer_new(value->u.i64);
+		case AS_DOUBLE:
+			return (as_val*)as_double_new(value->u.dbl);
+		case AS_BOOLEAN:
+			return (as_val*)as_boolean_new(value->u.bol);
+		case AS_GEOJSON:
+			return (as_val*)as_geojson_new(strdup(value->u.str), true);
+		case AS_STRING: {
+			char* str = value->u.str;
+
+			if (!str) {
+				return (as_val*)&as_nil;
+			}
+
+			if (ASQL_VALUE_TYPE_JSON == value->vt
+					|| ASQL_VALUE_TYPE_LIST == value->vt
+					|| ASQL_VALUE_TYPE_MAP == value->vt) {
+				as_val* val = as_json_arg(str, value->vt);
+
+				if (!val) {
+					as_error_update(err, AEROSPIKE_ERR_CLIENT,
+							"Error: Value is invalid JSON: %s", str);
+				}
+				return val;
+			}
+			return (as_val*)as_string_new_strdup(str);
+		}
+		default:
+			as_error_update(err, AEROSPIKE_ERR_CLIENT,
+					"Error: Invalid type: %d", value->type);
+			return NULL;
+	}
+}
+
 void
 asql_free_value(void* ptr)
 {
@@ -170,7 +221,7 @@ asql_free_value(void* ptr)
 			(value->type == AS_STRING ||
 			 value->type == AS_GEOJSON)) {
 		if (value->u.str) {
-			free(value->u.str);
+			asql_stmt_free(value->u.str);
 		}
 	}
 }
@@ -376,7 +427,7 @@ asql_parse_value_as(char* s, asql_value* value, asql_value_type_t vtype)
 				value->type = AS_STRING;
 			}
 
-			char* str = malloc(end + 1);
+			char* str = asql_stmt_malloc(end + 1);
 			memcpy(str, s + start, end);
 			str[end] = 0;
 			value->u.str = str;
@@ -282,6 +282,18 @@ as_json_print_as_val(const as_val* val, int indent, bool metadata, bool no_bins)
 	}
 }
 
+// Print {"<name>": <val>} the way a single bin record is printed, without
+// building the record.
+void
+as_json_print_named_val(const char* name, const as_val* val, int indent)
+{
+	fprintf(stdout, "\n");
+	json_t* obj = json_object();
+	json_obj_add_as_val(obj, name, val);
+	json_print_obj(obj, indent);
+	json_decref(obj);
+}
+
 
 //==========================================================
 // Local Helpers.
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aql.h>
+#include <asql.h>
+#include <asql_conf.h>
+
+#include "renderer/callback_renderer.h"
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+struct aql_stmt_s {
+	// NULL for statements which ran while being prepared (SET, GET, RESET).
+	aconfig* ac;
+
+	// Engine settings as of prepare, with the statement's hints applied. Owns
+	// its copy of the only string setting.
+	asql_config conf;
+
+	char* text;
+};
+
+
+//=========================================================
+// Globals.
+//
+
+extern bool g_inprogress;
+extern renderer* g_renderer;
+
+extern int run(void* o);
+extern int destroy_aconfig(aconfig* ac);
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static asql_config s_conf;
+static asql_set_option* s_option_table = NULL;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static renderer* engine_enter(const aql_callbacks* cb, void* udata);
+static bool engine_exit(renderer* saved);
+
+
+//=========================================================
+// Public API.
+//
+
+bool
+aql_init(aerospike* as)
+{
+	pthread_mutex_lock(&s_lock);
+
+	if (s_option_table) {
+		pthread_mutex_unlock(&s_lock);
+		return false;
+	}
+
+	s_option_table = option_table_new();
+
+	memset(&s_conf.base, 0, sizeof(asql_base_config));
+	option_init(&s_conf, s_option_table);
+
+	// Statements are not echoed, nothing is prompted for or printed, nothing
+	// runs until interrupted since callers take turns, and UDF
+	// registration and LOCAL look for modules where the caller's client does.
+	s_conf.base.echo = false;
+	s_conf.base.unattended = true;
+	s_conf.base.embedded = true;
+	s_conf.base.shared = true;
+
+	if (as->config.lua.user_path[0]) {
+		free(s_conf.base.lua_userpath);
+		s_conf.base.lua_userpath = strdup(as->config.lua.user_path);
+	}
+
+	g_config = &s_conf;
+	g_aerospike = as;
+
+	pthread_mutex_unlock(&s_lock);
+	return true;
+}
+
+void
+aql_destroy()
+{
+	pthread_mutex_lock(&s_lock);
+
+	if (s_option_table) {
+		option_free(s_option_table);
+		config_free(&s_conf);
+		s_option_table = NULL;
+		g_config = NULL;
+		g_aerospike = NULL;
+	}
+
+	pthread_mutex_unlock(&s_lock);
+}
+
+bool
+aql_set(const char* name, const char* value)
+{
+	char* n = strdup(name);
+	char* v = strdup(value);
+
+	renderer* saved = engine_enter(NULL, NULL);
+	bool rv = option_set(&s_conf, n, v);
+	engine_exit(saved);
+
+	free(n);
+	free(v);
+	return rv;
+}
+
+aql_stmt*
+aql_prepare(const char* cmd, const aql_callbacks* cb, void* udata)
+{
+	aql_stmt* stmt = malloc(sizeof(aql_stmt));
+
+	// The parsed statement may point into its text.
+	stmt->text = strdup(cmd);
+
+	renderer* saved = engine_enter(cb, udata);
+
+	stmt->ac = asql_prepare(&s_conf, stmt->text, &stmt->conf);
+	stmt->conf.base.lua_userpath = s_conf.base.lua_userpath
+			? strdup(s_conf.base.lua_userpath) : NULL;
+
+	bool errored = engine_exit(saved);
+
+	if (errored) {
+		aql_stmt_destroy(stmt);
+		return NULL;
+	}
+
+	return stmt;
+}
+
+bool
+aql_execute(aql_stmt* stmt, const aql_callbacks* cb, void* udata)
+{
+	if (!stmt->ac) {
+		return true;
+	}
+
+	renderer* saved = engine_enter(cb, udata);
+
+	asql_op op = { .c = &stmt->conf, .ac = stmt->ac, .backout = false, };
+	run((void*)&op);
+
+	return !engine_exit(saved);
+}
+
+void
+aql_stmt_destroy(aql_stmt* stmt)
+{
+	if (stmt) {
+		destroy_aconfig(stmt->ac);
+		free(stmt->conf.base.lua_userpath);
+		free(stmt->text);
+		free(stmt);
+	}
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+// Takes the engine and points its output at cb for the duration of a call.
+// SET OUTPUT has no say here, rows always go to the callbacks.
+static renderer*
+engine_enter(const aql_callbacks* cb, void* udata)
+{
+	pthread_mutex_lock(&s_lock);
+
+	renderer* saved = g_renderer;
+
+	g_renderer = &callback_renderer;
+	callback_renderer_bind(cb, udata);
+	g_interrupted = 0;
+	g_inprogress = true;
+
+	return saved;
+}
+
+// Returns whether an error was rendered since engine_enter.
+static bool
+engine_exit(renderer* saved)
+{
+	g_inprogress = false;
+
+	bool errored = callback_renderer_bind(NULL, NULL);
+
+	g_renderer = saved;
+
+	pthread_mutex_unlock(&s_lock);
+	return errored;
+}
@@ -19,11 +19,14 @@
 // Includes.
 //
 
+#include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -34,6 +37,7 @@
 #include "asql.h"
 #include "asql_conf.h"
 #include "asql_print.h"
+#include "asql_serve.h"
 
 #include "renderer/table.h"
 #include "renderer/json_renderer.h"
@@ -55,10 +59,7 @@
 
 char* g_prompt = "aql> ";
 static aerospike s_aerospike;
-bool g_inprogress = false;
-asql_config* g_config = NULL;
-aerospike* g_aerospike = &s_aerospike;
-renderer* g_renderer = &table_renderer;
+extern bool g_inprogress;
 
 
 //=========================================================
@@ -68,6 +69,7 @@ renderer* g_renderer = &table_renderer;
 static void do_single(asql_config* c, char* cmd);
 static void do_file(asql_config* c, char* fname);
 static void do_prompt(asql_config* c);
+static int do_client(asql_config* c, char* cmd, char* fname);
 
 static bool asql_init(asql_config* c);
 static void asql_shutdown(asql_config* c);
@@ -75,19 +77,10 @@ static void sig_hdlr(int sig_num);
 static void sig_hdlr_init();
 static bool client_log_cb(as_log_level level, const char* func, const char* file, uint32_t line, const char* fmt, ...);
 
+static bool read_routing_init(asql_config* c, as_config* config);
 static bool tls_read_password(char* value, char** ptr);
 static void add_tls_host(asql_config* c, as_config* config);
 
-//=========================================================
-// Inline and Macros.
-//
-
-#define ASQL_SET_OPTION_BOOL(var, name, help, val) {ASQL_SET_OPTION_TYPE_BOOL, offsetof(struct asql_config, var), name, help, .default_value=val}
-#define ASQL_SET_OPTION_INT(var, name, help, val) {ASQL_SET_OPTION_TYPE_INT, offsetof(struct asql_config, var), name, help, .default_value=val}
-#define ASQL_SET_OPTION_ENUM(var, name, map, val) {ASQL_SET_OPTION_TYPE_ENUM, offsetof(struct asql_config, var), name, .enum_map=map, .default_value=val}
-#define ASQL_SET_OPTION_STRING(var, name, help, val, fn) {ASQL_SET_OPTION_TYPE_STRING, offsetof(struct asql_config, var), name, help, .default_string=strdup(val), .validate=fn}
-
-
 //=========================================================
 // Main.
 //
@@ -96,36 +89,7 @@ static void add_tls_host(asql_config* c, as_config* config);
 int
 main(int argc, char** argv)
 {
-	map_enum_string output_t_map[] = {
-		{TABLE, "TABLE"},
-		{JSON, "JSON"},
-		{MUTE, "MUTE"},
-		{RAW, "RAW"},
-		{0, NULL}
-	};
-
-	asql_set_option asql_set_option_table[] = {
-		// General set options, also available at command line.
-		ASQL_SET_OPTION_BOOL(base.echo, "ECHO", NULL, false),
-		ASQL_SET_OPTION_BOOL(base.verbose, "VERBOSE", NULL, false),
-		// C client thread pool size (negative value means use the default.)
-		ASQL_SET_OPTION_ENUM(base.outputmode, "OUTPUT", output_t_map, TABLE),
-		ASQL_SET_OPTION_BOOL(base.outputtypes, "OUTPUT_TYPES",	NULL, true),
-		ASQL_SET_OPTION_INT(base.timeout_ms, "TIMEOUT", "time in ms", 1000),
-		ASQL_SET_OPTION_INT(base.socket_timeout_ms, "SOCKET_TIMEOUT", "time in ms", -1),
-		ASQL_SET_OPTION_STRING(base.lua_userpath, "LUA_USERPATH", "<path>", "/opt/aerospike/usr/udf/lua", NULL),
-
-		// Operation specific set options, not available at command line.
-		ASQL_SET_OPTION_INT(record_ttl_sec, "RECORD_TTL", "time in sec", 0),
-		ASQL_SET_OPTION_BOOL(record_print_metadata, "RECORD_PRINT_METADATA", "prints record metadata", false),
-		ASQL_SET_OPTION_BOOL(key_send, "KEY_SEND", NULL, true),
-		ASQL_SET_OPTION_BOOL(durable_delete, "DURABLE_DELETE", NULL, false),
-		ASQL_SET_OPTION_INT(scan_records_per_second, "SCAN_RECORDS_PER_SECOND", "Limit returned records per second (rps) rate for each server", 0),
-		ASQL_SET_OPTION_BOOL(no_bins, "NO_BINS", "No bins as part of scan and query result", false),
-
-		{.offset=-1}
-	};
-	
+	asql_set_option* asql_set_option_table = option_table_new();
 	asql_config conf;
 
 	// INIT Base Config
@@ -147,14 +111,33 @@ main(int argc, char** argv)
 		return 0;
 	}
 
+	if (conf.base.socket_path) {
+		int rv = do_client(&conf, cmd, fname);
+
+		option_free(asql_set_option_table);
+		config_free(&conf);
+		return rv;
+	}
+
 	g_config = &conf;
+	g_aerospike = &s_aerospike;
 	
 	if (! asql_init(g_config)) {
 		config_free(&conf);
 		return -1;
 	}
 
-	if (cmd) {
+	// A daemon or an interactive session is going to need the cluster, find
+	// out about a bad seed right away. -c and -f connect on demand.
+	if ((conf.base.serve_path || (! cmd && ! fname)) && ! asql_connect()) {
+		config_free(&conf);
+		return -1;
+	}
+
+	if (conf.base.serve_path) {
+		asql_serve(g_config, conf.base.serve_path);
+	}
+	else if (cmd) {
 		do_single(g_config, cmd);
 	}
 	else if (fname) {
@@ -213,6 +196,34 @@ do_file(asql_config* c, char* fname)
 	free(cmd);
 }
 
+static int
+do_client(asql_config* c, char* cmd, char* fname)
+{
+	if (cmd) {
+		return asql_serve_client(c->base.socket_path, cmd, -1);
+	}
+
+	if (fname) {
+		// A session runs lines as RUN does, send the file's lines rather
+		// than a RUN the daemon would have to open.
+		int fd = open(fname, O_RDONLY);
+
+		if (fd < 0) {
+			fprintf(stderr, "Error: cannot open file %s : %s\n", fname,
+					strerror(errno));
+			return -1;
+		}
+
+		int rv = asql_serve_client(c->base.socket_path, NULL, fd);
+
+		close(fd);
+		return rv;
+	}
+
+	// Statements piped on stdin.
+	return asql_serve_client(c->base.socket_path, NULL, STDIN_FILENO);
+}
+
 static void
 do_prompt(asql_config* c)
 {
@@ -284,6 +295,16 @@ asql_init(asql_config* c)
 	config.fail_if_not_connected = true;
 	config.use_services_alternate = c->base.use_services_alternate;
 
+	// With shared memory only one process on the host tends the cluster,
+	// the others attach to its node and partition maps on connect.
+	if (c->base.use_shm) {
+		config.use_shm = true;
+
+		if (c->base.shm_key) {
+			config.shm_key = c->base.shm_key;
+		}
+	}
+
 	// (A negative value means use the C client default.)
 	if (c->base.threadpoolsize >= 0) {
 		config.thread_pool_size = c->base.threadpoolsize;
@@ -295,6 +316,10 @@ asql_init(asql_config* c)
 		return false;
 	}
 
+	if (! read_routing_init(c, &config)) {
+		return false;
+	}
+
 	if (c->base.tls.keyfile && c->base.tls.keyfile_pw) {
 		if (strcmp(c->base.tls.keyfile_pw, DEFAULTPASSWORD) == 0) {
 			c->base.tls.keyfile_pw = strdup(getpass("Enter TLS-Keyfile Password: "));
@@ -322,15 +347,6 @@ asql_init(asql_config* c)
 	// to be logged in stderr via a callback.
 	as_log_set_callback(client_log_cb);
 
-	as_error err;
-
-	aerospike_connect(g_aerospike, &err);
-
-	if (err.code != AEROSPIKE_OK) {
-		fprintf(stderr, "Error %d: %s\n", err.code, err.message);
-		return false;
-	}
-
 	read_cmd_history();
 
 	return true;
@@ -341,12 +357,14 @@ asql_shutdown(asql_config* c)
 {
 	write_cmd_history();
 
-	as_error err;
-	aerospike_close(g_aerospike, &err);
+	if (g_aerospike->cluster) {
+		as_error err;
+		aerospike_close(g_aerospike, &err);
 
-	if (err.code != AEROSPIKE_OK) {
-		g_renderer->render_error(err.code, err.message, NULL);
-		return;
+		if (err.code != AEROSPIKE_OK) {
+			g_renderer->render_error(err.code, err.message, NULL);
+			return;
+		}
 	}
 
 	aerospike_destroy(g_aerospike);
@@ -363,6 +381,8 @@ sig_hdlr(int sig_num)
 		asql_shutdown(g_config);
 		exit(-1);
 	}
+	// Long running commands like TAIL poll this to stop.
+	g_interrupted = 1;
 }
 
 static void
@@ -399,6 +419,93 @@ client_log_cb(as_log_level level, const char* func, const char* file,
 	return true;
 }
 
+static bool
+enum_from_string(map_enum_string map[], const char* name, int* value)
+{
+	for (size_t i = 0; map[i].name; i++) {
+		if (! strcasecmp(map[i].name, name)) {
+			*value = map[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Read routing goes into the cluster's default policies, commands copy their
+// policies from there.
+static bool
+read_routing_init(asql_config* c, as_config* config)
+{
+	map_enum_string replica_map[] = {
+		{AS_POLICY_REPLICA_MASTER, "master"},
+		{AS_POLICY_REPLICA_ANY, "any"},
+		{AS_POLICY_REPLICA_SEQUENCE, "sequence"},
+		{AS_POLICY_REPLICA_PREFER_RACK, "prefer-rack"},
+		{0, NULL}
+	};
+
+	map_enum_string ap_map[] = {
+		{AS_POLICY_READ_MODE_AP_ONE, "one"},
+		{AS_POLICY_READ_MODE_AP_ALL, "all"},
+		{0, NULL}
+	};
+
+	map_enum_string sc_map[] = {
+		{AS_POLICY_READ_MODE_SC_SESSION, "session"},
+		{AS_POLICY_READ_MODE_SC_LINEARIZE, "linearize"},
+		{AS_POLICY_READ_MODE_SC_ALLOW_REPLICA, "allow-replica"},
+		{AS_POLICY_READ_MODE_SC_ALLOW_UNAVAILABLE, "allow-unavailable"},
+		{0, NULL}
+	};
+
+	int replica = AS_POLICY_REPLICA_SEQUENCE;
+	int ap = AS_POLICY_READ_MODE_AP_ONE;
+	int sc = AS_POLICY_READ_MODE_SC_SESSION;
+
+	if (c->base.rack_id >= 0) {
+		config->rack_aware = true;
+		config->rack_id = c->base.rack_id;
+		replica = AS_POLICY_REPLICA_PREFER_RACK;
+	}
+
+	if (c->base.replica && ! enum_from_string(replica_map, c->base.replica, &replica)) {
+		fprintf(stderr, "Invalid replica %s. Allowed values are master / any / sequence / prefer-rack\n",
+				c->base.replica);
+		return false;
+	}
+
+	if (replica == AS_POLICY_REPLICA_PREFER_RACK && ! config->rack_aware) {
+		fprintf(stderr, "Replica prefer-rack requires rack-id\n");
+		return false;
+	}
+
+	if (c->base.read_mode_ap && ! enum_from_string(ap_map, c->base.read_mode_ap, &ap)) {
+		fprintf(stderr, "Invalid read mode %s. Allowed values are one / all\n",
+				c->base.read_mode_ap);
+		return false;
+	}
+
+	if (c->base.read_mode_sc && ! enum_from_string(sc_map, c->base.read_mode_sc, &sc)) {
+		fprintf(stderr, "Invalid read mode %s. Allowed values are session / linearize / allow-replica / allow-unavailable\n",
+				c->base.read_mode_sc);
+		return false;
+	}
+
+	as_policies* p = &config->policies;
+
+	p->read.replica = (as_policy_replica)replica;
+	p->read.read_mode_ap = (as_policy_read_mode_ap)ap;
+	p->read.read_mode_sc = (as_policy_read_mode_sc)sc;
+
+	p->batch.replica = (as_policy_replica)replica;
+	p->batch.read_mode_ap = (as_policy_read_mode_ap)ap;
+	p->batch.read_mode_sc = (as_policy_read_mode_sc)sc;
+
+	p->scan.replica = (as_policy_replica)replica;
+	p->query.replica = (as_policy_replica)replica;
+	return true;
+}
+
 static bool
 password_env(const char *var, char **ptr)
 {
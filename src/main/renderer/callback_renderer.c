@@ -0,0 +1,201 @@
+/*
+ * Copyright 2015-2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include <aerospike/as_val.h>
+
+#include "callback_renderer.h"
+#include "renderer.h"
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+// Scan and query callbacks arrive on client threads, rows of one view are
+// handed over one at a time so the embedder does not need to lock.
+typedef struct callback_view_s {
+	const as_node* node;
+	pthread_mutex_t l;
+} callback_view;
+
+
+//=========================================================
+// Globals.
+//
+
+static const aql_callbacks* s_cb = NULL;
+static void* s_udata = NULL;
+static bool s_errored = false;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static void* view_new(const as_node* node);
+static void view_destroy(void* self);
+static void view_set_node(const as_node* node, void* view);
+static void view_set_cols(as_vector* bnames, void* view);
+static bool render(const as_val* val, void* view);
+static bool render_values(const char* name, as_val** vals, uint32_t n_vals, void* view);
+static void render_error(const int32_t code, const char* msg, void* view);
+static void render_ok(const char* msg, void* view);
+static void render_progress(const char* msg, void* view);
+
+
+//=========================================================
+// Function Table.
+//
+
+renderer callback_renderer = {
+	.view_new = view_new,
+	.view_destroy = view_destroy,
+	.render = render,
+	.render_values = render_values,
+	.render_error = render_error,
+	.render_ok = render_ok,
+	.render_progress = render_progress,
+	.view_set_node = view_set_node,
+	.view_set_cols = view_set_cols
+};
+
+
+//=========================================================
+// Public API.
+//
+
+bool
+callback_renderer_bind(const aql_callbacks* cb, void* udata)
+{
+	bool errored = s_errored;
+
+	s_cb = cb;
+	s_udata = udata;
+	s_errored = false;
+	return errored;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+static void*
+view_new(const as_node* node)
+{
+	callback_view* self = (callback_view*)malloc(sizeof(callback_view));
+	if (!self) {
+		return NULL;
+	}
+
+	self->node = node;
+	pthread_mutex_init(&self->l, 0);
+
+	return self;
+}
+
+static void
+view_destroy(void* self)
+{
+	if (self) {
+		pthread_mutex_destroy(&((callback_view*)self)->l);
+		free(self);
+	}
+}
+
+static void
+view_set_node(const as_node* node, void* view)
+{
+	callback_view* self = (callback_view*)view;
+	self->node = node;
+}
+
+static void
+view_set_cols(as_vector* bnames, void* view)
+{
+	// No-Op, records carry their bin names.
+	return;
+}
+
+// Values are lent to the callback and only valid during the call, a callback
+// which keeps one must deep copy it. A NULL value marks the end of a result
+// set.
+static bool
+render(const as_val* val, void* view)
+{
+	callback_view* self = (callback_view*)view;
+	if (!self) {
+		return false;
+	}
+
+	if (!s_cb || !s_cb->row) {
+		return true;
+	}
+
+	const as_node* node = self->node == CLUSTER ? NULL : self->node;
+
+	pthread_mutex_lock(&self->l);
+	bool rv = s_cb->row(val, node, s_udata);
+	pthread_mutex_unlock(&self->l);
+
+	return rv;
+}
+
+static bool
+render_values(const char* name, as_val** vals, uint32_t n_vals, void* view)
+{
+	for (uint32_t i = 0; i < n_vals; i++) {
+		if (!render(vals[i], view)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+render_error(const int32_t code, const char* msg, void* view)
+{
+	s_errored = true;
+
+	if (s_cb && s_cb->error) {
+		s_cb->error(code, msg ? msg : "", s_udata);
+	}
+}
+
+static void
+render_ok(const char* msg, void* view)
+{
+	if (s_cb && s_cb->ok) {
+		s_cb->ok(msg ? msg : "", s_udata);
+	}
+}
+
+static void
+render_progress(const char* msg, void* view)
+{
+	if (msg && s_cb && s_cb->progress) {
+		s_cb->progress(msg, s_udata);
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "renderer.h"
+#include "aql.h"
+
+extern renderer callback_renderer;
+
+// Routes everything rendered from now on to cb. Returns whether an error was
+// rendered since the previous bind.
+bool callback_renderer_bind(const aql_callbacks* cb, void* udata);
@@ -71,8 +71,10 @@ static void view_destroy(void* self);
 static void view_set_node(const as_node* node, void* view);
 static void view_set_cols(as_vector* bnames, void* view);
 static bool render(const as_val* val, void* view);
+static bool render_values(const char* name, as_val** vals, uint32_t n_vals, void* view);
 static void render_error(const int32_t code, const char* msg, void* view);
 static void render_ok(const char* msg, void* view);
+static void render_progress(const char* msg, void* view);
 static void render_nodeid(json* self);
 static char* spaces(uint8_t indent);
 
@@ -85,8 +87,10 @@ renderer json_renderer = {
 	.view_new = view_new,
 	.view_destroy = view_destroy,
 	.render = render,
+	.render_values = render_values,
 	.render_error = render_error,
 	.render_ok = render_ok,
+	.render_progress = render_progress,
 	.view_set_node = view_set_node,
 	.view_set_cols = view_set_cols
 };
@@ -196,6 +200,27 @@ render(const as_val* val, void* view)
 	return true;
 }
 
+static bool
+render_values(const char* name, as_val** vals, uint32_t n_vals, void* view)
+{
+	json* self = (json*)view;
+
+	pthread_mutex_lock(&self->l);
+
+	for (uint32_t i = 0; i < n_vals; i++) {
+		if (self->entries > 0) {
+			fprintf(stdout, ",");
+		}
+
+		as_json_print_named_val(name, vals[i],
+				self->node ? self->indent + 2 : self->indent + 1);
+		self->entries++;
+	}
+
+	pthread_mutex_unlock(&self->l);
+	return true;
+}
+
 static void
 render_status(as_val* val, void* self)
 {
@@ -268,6 +293,19 @@ render_ok(const char* msg, void* self)
 	return;
 }
 
+static void
+render_progress(const char* msg, void* self)
+{
+	// Kept off stdout, status lines would break the JSON document.
+	if (msg) {
+		fprintf(stderr, "\r%s\033[K", msg);
+	}
+	else {
+		fprintf(stderr, "\n");
+	}
+	fflush(stderr);
+}
+
 static void
 render_nodeid(json* self)
 {
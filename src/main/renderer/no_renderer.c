@@ -55,8 +55,10 @@ static void view_destroy(void* self);
 static void view_set_node(const as_node* node, void* view);
 static void view_set_cols(as_vector* bnames, void* view);
 static bool render(const as_val* val, void* view);
+static bool render_values(const char* name, as_val** vals, uint32_t n_vals, void* view);
 static void render_error(const int32_t code, const char* msg, void* view);
 static void render_ok(const char* msg, void* view);
+static void render_progress(const char* msg, void* view);
 
 
 //=========================================================
@@ -67,8 +69,10 @@ renderer no_renderer = {
 	.view_new = view_new,
 	.view_destroy = view_destroy,
 	.render = render,
+	.render_values = render_values,
 	.render_error = render_error,
 	.render_ok = render_ok,
+	.render_progress = render_progress,
 	.view_set_node = view_set_node,
 	.view_set_cols = view_set_cols
 };
@@ -160,6 +164,20 @@ render(const as_val* val, void* view)
 	return true;
 }
 
+static bool
+render_values(const char* name, as_val** vals, uint32_t n_vals, void* view)
+{
+	mute* self = (mute*)view;
+	if (!self) {
+		return false;
+	}
+
+	pthread_mutex_lock(&self->l);
+	self->rows_total += n_vals;
+	pthread_mutex_unlock(&self->l);
+	return true;
+}
+
 static void
 render_error(const int32_t code, const char* msg, void* view)
 {
@@ -181,3 +199,15 @@ render_ok(const char* msg, void* view)
 		fprintf(stdout, "OK\n\n");
 	}
 }
+
+static void
+render_progress(const char* msg, void* view)
+{
+	if (msg) {
+		fprintf(stdout, "\r%s\033[K", msg);
+	}
+	else {
+		fprintf(stdout, "\n");
+	}
+	fflush(stdout);
+}
@@ -62,8 +62,10 @@ static void view_destroy(void* self);
 static void view_set_node(const as_node* node, void* view);
 static void view_set_cols(as_vector* bnames, void* view);
 static bool render(const as_val* val, void* view);
+static bool render_values(const char* name, as_val** vals, uint32_t n_vals, void* view);
 static void render_error(const int32_t code, const char* msg, void* view);
 static void render_ok(const char* msg, void* view);
+static void render_progress(const char* msg, void* view);
 
 static bool each_bin(const char* name, const as_val* val, void* udata);
 static bool each_map_entry(const as_val* key, const as_val* val, void* udata);
@@ -78,8 +80,10 @@ renderer raw_renderer = {
 	.view_new = view_new,
 	.view_destroy = view_destroy,
 	.render = render,
+	.render_values = render_values,
 	.render_error = render_error,
 	.render_ok = render_ok,
+	.render_progress = render_progress,
 	.view_set_node = view_set_node,
 	.view_set_cols = view_set_cols
 };
@@ -297,6 +301,27 @@ render(const as_val* val, void* view)
 	return true;
 }
 
+static bool
+render_values(const char* name, as_val** vals, uint32_t n_vals, void* view)
+{
+	raw* self = (raw*)view;
+	if (!self) {
+		return false;
+	}
+
+	pthread_mutex_lock(&self->l);
+
+	for (uint32_t i = 0; i < n_vals; i++) {
+		fprintf(stdout, "*************************** %d. row ***************************\n",
+				self->rows_total + 1);
+		each_bin(name, vals[i], self);
+		self->rows_total++;
+	}
+
+	pthread_mutex_unlock(&self->l);
+	return true;
+}
+
 static void
 render_error(const int32_t code, const char* msg, void* view)
 {
@@ -319,6 +344,18 @@ render_ok(const char* msg, void* view)
 	}
 }
 
+static void
+render_progress(const char* msg, void* view)
+{
+	if (msg) {
+		fprintf(stdout, "\r%s\033[K", msg);
+	}
+	else {
+		fprintf(stdout, "\n");
+	}
+	fflush(stdout);
+}
+
 static bool
 each_bin(const char* name, const as_val* val, void* udata)
 {
@@ -32,6 +32,7 @@
 #include <aerospike/as_rec.h>
 #include <aerospike/as_map.h>
 #include <aerospike/as_hashmap.h>
+#include <aerospike/as_integer.h>
 #include <aerospike/as_string.h>
 #include <aerospike/as_record.h>
 #include <aerospike/as_key.h>
@@ -41,6 +42,7 @@
 #include "table.h"
 #include "renderer.h"
 #include "asql.h"
+#include "asql_arena.h"
 
 
 //==========================================================
@@ -56,14 +58,18 @@
 // Maximum number of chars in a cell.
 #define TABLE_CELL_MAX 256
 
+// Cell strings of one batch, with room for every cell to be set twice.
+#define TABLE_ARENA_RESERVE (2 * (TABLE_ROWS_MAX + 1) * TABLE_COLS_MAX * TABLE_CELL_MAX)
+
 
 /**
  * Represents a table column. The column contains
- * a value and the width (strlen of value).
+ * a value and the width (strlen of value). The value
+ * lives in the table's batch arena, NULL is empty.
  */
 typedef struct table_col_s {
 
-	char value[TABLE_CELL_MAX];
+	const char* value;
 	uint32_t width;
 
 } table_col;
@@ -101,9 +107,22 @@ typedef struct table_s {
 	as_node* node;
 	pthread_mutex_t l;
 
+	/**
+	 * Header and cell strings of the rows not flushed yet, rewound in one
+	 * shot by each flush.
+	 */
+	asql_arena batch;
+
 } table;
 
 
+//=========================================================
+// Inline and Macros.
+//
+
+#define CELL(v) ((v) ? (v) : "")
+
+
 //=========================================================
 // Forward Declarations.
 //
@@ -115,8 +134,10 @@ static void view_destroy(void* self);
 static void view_set_node(const as_node* node, void* view);
 static void view_set_cols(as_vector* bnames, void* view);
 static bool render(const as_val* val, void* view);
+static bool render_values(const char* name, as_val** vals, uint32_t n_vals, void* view);
 static void render_error(const int32_t code, const char* msg, void* view);
 static void render_ok(const char* msg, void* view);
+static void render_progress(const char* msg, void* view);
 
 static bool each_bin(const char* name, const as_val* val, void* udata);
 static bool each_map_entry(const as_val* key, const as_val* val, void* udata);
@@ -133,8 +154,10 @@ renderer table_renderer = {
 	.view_new = view_new,
 	.view_destroy = view_destroy,
 	.render = render,
+	.render_values = render_values,
 	.render_error = render_error,
 	.render_ok = render_ok,
+	.render_progress = render_progress,
 	.view_set_node = view_set_node,
 	.view_set_cols = view_set_cols
 };
@@ -158,12 +181,13 @@ view_new(const as_node* node)
 	self->cols_count = 0;
 	self->node = (as_node*)node;
 	pthread_mutex_init(&self->l, 0);
+	asql_arena_init(&self->batch, TABLE_ARENA_RESERVE);
 
 	for (int c = 0; c < TABLE_COLS_MAX; c++) {
-		self->cols[c].value[0] = '\0';
+		self->cols[c].value = NULL;
 		self->cols[c].width = 0;
 		for (int r = 0; r < TABLE_ROWS_MAX; r++) {
-			self->rows[r].cols[c].value[0] = '\0';
+			self->rows[r].cols[c].value = NULL;
 			self->rows[r].cols[c].width = 0;
 		}
 	}
@@ -175,6 +199,7 @@ static void
 view_destroy(void* self)
 {
 	if (self) {
+		asql_arena_destroy(&((table*)self)->batch);
 		free(self);
 	}
 }
@@ -199,7 +224,7 @@ view_set_cols(as_vector *bnames, void* view)
 	for (uint16_t i = 0; i < bnames->size; i++) {
 		char* bname = as_vector_get_ptr(bnames, i);
 		uint32_t len = strlen(bname);
-		as_strncpy(self->cols[i].value, bname, len + 1);
+		self->cols[i].value = asql_arena_strndup(&self->batch, bname, len);
 		self->cols[i].width = len + 1;
 	}
 	self->cols_count = bnames->size;
@@ -380,6 +405,30 @@ render(const as_val* val, void* view)
 	return true;
 }
 
+static bool
+render_values(const char* name, as_val** vals, uint32_t n_vals, void* view)
+{
+	table* self = (table*)view;
+	if (!self) {
+		return false;
+	}
+
+	pthread_mutex_lock(&self->l);
+
+	for (uint32_t i = 0; i < n_vals; i++) {
+		each_bin(name, vals[i], self);
+		self->rows_count++;
+		self->rows_total++;
+
+		if (self->rows_count >= TABLE_ROWS_MAX - 1) {
+			flush(self);
+		}
+	}
+
+	pthread_mutex_unlock(&self->l);
+	return true;
+}
+
 static void
 render_error(const int32_t code, const char* msg, void* self)
 {
@@ -404,6 +453,18 @@ render_ok(const char* msg, void* self)
 	return;
 }
 
+static void
+render_progress(const char* msg, void* view)
+{
+	if (msg) {
+		fprintf(stdout, "\r%s\033[K", msg);
+	}
+	else {
+		fprintf(stdout, "\n");
+	}
+	fflush(stdout);
+}
+
 static bool
 each_bin(const char* name, const as_val* val, void* udata)
 {
@@ -419,7 +480,7 @@ each_bin(const char* name, const as_val* val, void* udata)
 	// First, we will use the bin name to find a matching column.
 	// a -1 indicates the column does not exist.
 	for (int i = 0; i < self->cols_count; i++) {
-		if (strcmp(self->cols[i].value, name) == 0) {
+		if (self->cols[i].value && strcmp(self->cols[i].value, name) == 0) {
 			col = i;
 			break;
 		}
@@ -437,13 +498,9 @@ each_bin(const char* name, const as_val* val, void* udata)
 				len = TABLE_CELL_MAX - 2;
 			}
 
-			// as_strncpy() guarantees null termination while strncpy() does not.
-			// Do not call as_strncpy() for NULL strings
-
-			uint32_t name_sz = name ? len + 1: 0;
-
 			if (name) {
-				as_strncpy(self->cols[col].value, name, name_sz);
+				self->cols[col].value = asql_arena_strndup(&self->batch, name,
+						len);
 			}
 			self->cols[col].width = len;
 			self->cols_count++;
@@ -454,7 +511,19 @@ each_bin(const char* name, const as_val* val, void* udata)
 	// the column.
 	if (col != -1) {
 
-		char* str = asql_val_str(val);
+		// Integers, the most common cells, are formatted without going
+		// through the heap.
+		char ibuf[32];
+		char* str;
+
+		if (val->count && as_val_type(val) == AS_INTEGER) {
+			snprintf(ibuf, sizeof(ibuf), "%" PRId64,
+					as_integer_get((const as_integer*)val));
+			str = ibuf;
+		}
+		else {
+			str = asql_val_str(val);
+		}
 
 		uint32_t len = str ? (uint32_t)strlen(str): 0;
 
@@ -462,14 +531,8 @@ each_bin(const char* name, const as_val* val, void* udata)
 			len = TABLE_CELL_MAX - 2;
 		}
 
-		// as_strncpy() guarantees null termination while strncpy() does not.
-		// Do not call as_strncpy() for NULL strings
-
-		uint32_t str_sz = str ? len + 1: 0;
-
-		if (str) {
-			as_strncpy(self->rows[row].cols[col].value, str, str_sz);
-		}
+		self->rows[row].cols[col].value = str
+				? asql_arena_strndup(&self->batch, str, len) : NULL;
 
 		self->rows[row].cols[col].width = len;
 
@@ -477,7 +540,9 @@ each_bin(const char* name, const as_val* val, void* udata)
 			self->cols[col].width = self->rows[row].cols[col].width;
 		}
 
-		free(str);
+		if (str != ibuf) {
+			free(str);
+		}
 	}
 
 	return true;
@@ -520,7 +585,7 @@ flush(table* self)
 		// header
 		for (int c = 0; c < self->cols_count; c++) {
 			fprintf(stdout, "| %-*s ", self->cols[c].width,
-			        self->cols[c].value);
+			        CELL(self->cols[c].value));
 		}
 		fprintf(stdout, "|\n");
 
@@ -530,7 +595,7 @@ flush(table* self)
 		for (int r = 0; r < self->rows_count; r++) {
 			for (int c = 0; c < self->cols_count; c++) {
 				fprintf(stdout, "| %-*s ", self->cols[c].width,
-				        self->rows[r].cols[c].value);
+				        CELL(self->rows[r].cols[c].value));
 			}
 			fprintf(stdout, "|\n");
 		}
@@ -541,14 +606,16 @@ flush(table* self)
 		self->cols_count = 0;
 
 		for (int c = 0; c < TABLE_COLS_MAX; c++) {
-			self->cols[c].value[0] = '\0';
+			self->cols[c].value = NULL;
 			self->cols[c].width = 0;
 			for (int r = 0; r < TABLE_ROWS_MAX; r++) {
-				self->rows[r].cols[c].value[0] = '\0';
+				self->rows[r].cols[c].value = NULL;
 				self->rows[r].cols[c].width = 0;
 			}
 		}
 
+		asql_arena_rewind(&self->batch, (asql_arena_mark){ .used = 0 });
+
 		return true;
 	}
 	return false;
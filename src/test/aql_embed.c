@@ -0,0 +1,200 @@
+/*
+ * Copyright 2026 Aerospike, Inc.
+ *
+ * Portions may be licensed to Aerospike, Inc. under one or more contributor
+ * license agreements.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ */
+
+/*
+ * Runs statements through libaql for test/libaql_test.py. Every callback is
+ * printed as one tagged line, anything else on stdout is the library's:
+ *
+ *	ROW <bin>=<value> ...    a record
+ *	ROW <value>              any other value
+ *	END                      end of a result set
+ *	OK <msg>
+ *	ERROR <code> <msg>
+ *	PROGRESS <msg>
+ *
+ * -n <rows> makes the row callback return false after that many rows.
+ */
+
+//==========================================================
+// Includes.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <aerospike/aerospike.h>
+#include <aerospike/as_record.h>
+#include <aerospike/as_record_iterator.h>
+
+#include <aql.h>
+
+
+//==========================================================
+// Typedefs & constants.
+//
+
+typedef struct {
+	long max_rows; // -1 for all
+	long n_rows;
+} embed_state;
+
+
+//=========================================================
+// Forward Declarations.
+//
+
+static bool on_row(const as_val* val, const as_node* node, void* udata);
+static void on_error(int32_t code, const char* msg, void* udata);
+static void on_ok(const char* msg, void* udata);
+static void on_progress(const char* msg, void* udata);
+
+
+//=========================================================
+// Main.
+//
+
+int
+main(int argc, char** argv)
+{
+	const char* host = "127.0.0.1";
+	int port = 3000;
+	embed_state state = { .max_rows = -1, .n_rows = 0 };
+	int opt;
+
+	while ((opt = getopt(argc, argv, "h:p:n:")) != -1) {
+		switch (opt) {
+			case 'h':
+				host = optarg;
+				break;
+			case 'p':
+				port = atoi(optarg);
+				break;
+			case 'n':
+				state.max_rows = atol(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-h host] [-p port] [-n rows] "
+						"statement ...\n", argv[0]);
+				return 2;
+		}
+	}
+
+	as_config config;
+	as_config_init(&config);
+	as_config_add_host(&config, host, port);
+
+	// Left disconnected, the first statement which needs the cluster connects.
+	aerospike as;
+	aerospike_init(&as, &config);
+
+	aql_init(&as);
+
+	aql_callbacks cb = {
+		.row = on_row,
+		.error = on_error,
+		.ok = on_ok,
+		.progress = on_progress
+	};
+	int rv = 0;
+
+	for (int i = optind; i < argc; i++) {
+		state.n_rows = 0;
+
+		aql_stmt* stmt = aql_prepare(argv[i], &cb, &state);
+
+		if (!stmt) {
+			rv = 1;
+			continue;
+		}
+
+		if (!aql_execute(stmt, &cb, &state)) {
+			rv = 1;
+		}
+
+		aql_stmt_destroy(stmt);
+		fflush(stdout);
+	}
+
+	aql_destroy();
+
+	if (as.cluster) {
+		as_error err;
+		aerospike_close(&as, &err);
+	}
+	aerospike_destroy(&as);
+
+	return rv;
+}
+
+
+//=========================================================
+// Local Helpers.
+//
+
+static bool
+on_row(const as_val* val, const as_node* node, void* udata)
+{
+	embed_state* state = (embed_state*)udata;
+
+	if (!val) {
+		fprintf(stdout, "END\n");
+		return true;
+	}
+
+	if (as_val_type(val) == AS_REC) {
+		as_record_iterator it;
+		as_record_iterator_init(&it, (as_record*)val);
+
+		fprintf(stdout, "ROW");
+		while (as_record_iterator_has_next(&it)) {
+			as_bin* bin = as_record_iterator_next(&it);
+			char* s = as_val_tostring((as_val*)as_bin_get_value(bin));
+			fprintf(stdout, " %s=%s", as_bin_get_name(bin), s);
+			free(s);
+		}
+		fprintf(stdout, "\n");
+
+		as_record_iterator_destroy(&it);
+	}
+	else {
+		char* s = as_val_tostring(val);
+		fprintf(stdout, "ROW %s\n", s);
+		free(s);
+	}
+
+	state->n_rows++;
+	return state->max_rows < 0 || state->n_rows < state->max_rows;
+}
+
+static void
+on_error(int32_t code, const char* msg, void* udata)
+{
+	fprintf(stdout, "ERROR %d %s\n", code, msg);
+}
+
+static void
+on_ok(const char* msg, void* udata)
+{
+	fprintf(stdout, "OK %s\n", msg);
+}
+
+static void
+on_progress(const char* msg, void* udata)
+{
+	fprintf(stdout, "PROGRESS %s\n", msg);
+}
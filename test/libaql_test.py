@@ -0,0 +1,100 @@
+import os
+import pty
+import unittest
+import utils
+
+LIB_SET = "aql-lib-tests"
+
+
+class LibaqlTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(LIB_SET)
+        utils.run_aql(
+            [
+                "-h", cls.ips[0], "-p", str(utils.PORT), "-c",
+                "register module '{}'".format(utils.absolute_path("lua", "aggtest.lua")),
+            ]
+        )
+
+    def run_embed(self, stmts, args=None, **kwargs):
+        args = [] if args is None else args
+        output = utils.run_aql_embed(
+            ["-h", self.ips[0], "-p", str(utils.PORT)] + args + stmts, **kwargs
+        )
+        # Every line is one of the driver's callbacks, the library itself
+        # prints nothing.
+        lines = output.stdout.decode().splitlines()
+        for line in lines:
+            self.assertRegex(line, "^(ROW|END|OK|ERROR|PROGRESS)( |$)")
+        return output.returncode, lines
+
+    def test_select_rows(self):
+        rc, lines = self.run_embed(
+            ["select * from test.{} where pk = 'key3'".format(LIB_SET)]
+        )
+        self.assertEqual(rc, 0)
+        rows = [line for line in lines if line.startswith("ROW")]
+        self.assertEqual(len(rows), 1)
+        self.assertIn("int=3", rows[0])
+        self.assertIn("END", lines)
+
+    def test_error(self):
+        rc, lines = self.run_embed(["select * from"])
+        self.assertEqual(rc, 1)
+        self.assertTrue(any(line.startswith("ERROR") for line in lines))
+
+    def test_options_go_to_ok(self):
+        rc, lines = self.run_embed(
+            ["set timeout 500", "get timeout", "set output json"]
+        )
+        self.assertEqual(rc, 0)
+        self.assertIn("OK TIMEOUT = 500", lines)
+        self.assertEqual(lines.count("OK TIMEOUT = 500"), 2)
+        self.assertIn("OK OUTPUT = JSON", lines)
+
+    def test_output_mode_does_not_apply(self):
+        rc, lines = self.run_embed(
+            [
+                "set output json",
+                "select * from test.{} where pk = 'key3'".format(LIB_SET),
+            ]
+        )
+        self.assertEqual(rc, 0)
+        self.assertTrue(any(line.startswith("ROW") for line in lines))
+
+    def test_aggregation_stops_on_false(self):
+        # Each of the 100 records yields a value, the callback wants two.
+        rc, lines = self.run_embed(
+            ["aggregate aggtest.int_values() on test.{}".format(LIB_SET)],
+            ["-n", "2"],
+        )
+        self.assertEqual(rc, 0)
+        self.assertEqual(len([line for line in lines if line.startswith("ROW")]), 2)
+        self.assertEqual(lines.count("END"), 1)
+
+    def test_truncate_does_not_read_stdin(self):
+        # A terminal on stdin must not be prompted, and the library does not
+        # wait for the records to be gone.
+        master, tty = pty.openpty()
+        self.addCleanup(os.close, master)
+        try:
+            rc, lines = self.run_embed(
+                ["truncate test.{}".format(LIB_SET)], stdin=tty, timeout=90
+            )
+        finally:
+            os.close(tty)
+        utils.populate_db(LIB_SET)
+        self.assertEqual(rc, 0)
+        self.assertFalse(any("[y/N]" in line for line in lines))
+        self.assertTrue(any(line.startswith("OK Truncate accepted") for line in lines))
+
+    def test_tail_is_refused(self):
+        rc, lines = self.run_embed(
+            ["tail test.{} interval 1s".format(LIB_SET)], timeout=10
+        )
+        self.assertEqual(rc, 1)
+        self.assertTrue(any(line.startswith("ERROR") and "TAIL" in line for line in lines))
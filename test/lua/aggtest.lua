@@ -0,0 +1,23 @@
+local function int_bin(rec)
+  return rec['int']
+end
+
+local function add(a, b)
+  return a + b
+end
+
+function int_values(stream)
+  return stream : map(int_bin)
+end
+
+function sum_int(stream)
+  return stream : map(int_bin) : reduce(add)
+end
+
+-- The map() after reduce() must not run on the merged ranges twice.
+function sum_int_labeled(stream)
+  local function label(total)
+    return map{total = total}
+  end
+  return stream : map(int_bin) : reduce(add) : map(label)
+end
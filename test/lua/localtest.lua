@@ -0,0 +1,17 @@
+function int_bin(rec)
+  return rec['int']
+end
+
+function fail(rec)
+  error('local failure')
+end
+
+function count(stream)
+  local function one(rec)
+    return 1
+  end
+  local function add(a, b)
+    return a + b
+  end
+  return stream : map(one) : reduce(add)
+end
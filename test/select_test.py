@@ -1,4 +1,5 @@
 
+import subprocess
 import sys
 import time
 import unittest
@@ -117,6 +118,230 @@ class SelectPositiveTest(unittest.TestCase):
         self.assertEqual(output.returncode, 0)
         self.assertRegex(str(output.stdout), check_str)
 
+    def test_select_computed_columns(self):
+        # int is 3 for key3, str is a string and reads as nil.
+        cmd = "select int * 2 as dbl, str * 2 as bad from test.{} where pk = 'key3'".format(
+            utils.SET_NAME
+        )
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), "1 row in set")
+        self.assertRegex(str(output.stdout), r"\| 6 +\|")
+        self.assertNotIn("Error", str(output.stderr))
+
+    def test_select_computed_column_types(self):
+        # key3: int is 3, b-int is 3 and float is 9.42.
+        cmd = (
+            "set output json; "
+            "select int, b-int, int * 1.5 as x, float * 2.0 as y, int * 100 / 7 as z "
+            "from test.{} where pk = 'key3'".format(utils.SET_NAME)
+        )
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        row = utils.parse_json_output(output.stdout)[0][0]
+        self.assertEqual(row["int"], 3)
+        self.assertEqual(row["b-int"], 3)
+        self.assertAlmostEqual(row["x"], 4.5)
+        self.assertAlmostEqual(row["y"], 18.84)
+        # Integer division truncates.
+        self.assertEqual(row["z"], 42)
+
+    def test_select_cdt_paths(self):
+        cdt_set = "aql-cdt-tests"
+        utils.as_client.put(
+            ("test", cdt_set, "cdt1"),
+            {
+                "events": list(range(1, 21)),
+                "profile": {"country": "NZ", "tags": ["a", "b", "c"]},
+            },
+            policy={"key": utils.aerospike.POLICY_KEY_SEND},
+        )
+        cmd = (
+            "set output json; "
+            "select events[-3:] as last, events[0] as first, "
+            "profile['country'] as country, profile['tags'][1] as tag "
+            "from test.{} where pk = 'cdt1'".format(cdt_set)
+        )
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        row = utils.parse_json_output(output.stdout)[0][0]
+        self.assertEqual(row["last"], [18, 19, 20])
+        self.assertEqual(row["first"], 1)
+        self.assertEqual(row["country"], "NZ")
+        self.assertEqual(row["tag"], "b")
+
+        # Without a PK the same paths go out as scan operations.
+        cmd = "select events[1:3] as mid from test.{}".format(cdt_set)
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), r"\[2, 3\]")
+        self.assertRegex(str(output.stdout), "1 row in set")
+
+    @parameterized.expand(
+        [
+            (
+                "select count(*) from test.{}".format(utils.SET_NAME),
+                r"\| 100 +\|",
+            ),
+            (
+                "select count(*) from test.{} where a-int = 0".format(utils.SET_NAME),
+                r"\| 20 +\|",
+            ),
+            (
+                # SINCE always counts records, it must agree with metadata.
+                "select count(*) from test.{} since '2000-01-01T00:00:00Z'".format(utils.SET_NAME),
+                r"\| 100 +\|",
+            ),
+        ]
+    )
+    def test_select_count(self, cmd, check_str):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), check_str)
+
+    @parameterized.expand(
+        [
+            (
+                "select exists from test.{} where pk in ('key1', 'key2', 'nokey')".format(utils.SET_NAME),
+                "3 rows in set",
+            ),
+            (
+                "select {{ttl}}, {{gen}} from test.{} where pk in ('key1', 'key2', 'nokey')".format(utils.SET_NAME),
+                "2 rows in set",
+            ),
+            (
+                "select {{gen}} from test.{}".format(utils.SET_NAME),
+                "100 rows in set",
+            ),
+        ]
+    )
+    def test_select_header(self, cmd, check_str):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), check_str)
+
+    @parameterized.expand(
+        [
+            (
+                "select * from test.{} since '2000-01-01T00:00:00Z'".format(utils.SET_NAME),
+                "100 rows in set",
+            ),
+            (
+                "select * from test.{} since '2100-01-01T00:00:00Z'".format(utils.SET_NAME),
+                "0 rows in set",
+            ),
+        ]
+    )
+    def test_select_since(self, cmd, check_str):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), check_str)
+
+    @parameterized.expand(
+        [
+            (
+                "select * from test.{} where int = 0; show index advice".format(utils.SET_NAME),
+                "int.*NUMERIC.*DEFAULT.*1 row in set",
+            ),
+            (
+                "select * from test.{} where a-int = 0 and int = 0; show index advice".format(
+                    utils.SET_NAME
+                ),
+                "int.*NUMERIC.*DEFAULT.*1 row in set",
+            ),
+            (
+                "select * from test.{} where a-int = 0; show index advice".format(utils.SET_NAME),
+                "0 rows in set",
+            ),
+            (
+                # Earlier runs are not remembered, the output says why.
+                "show index advice",
+                "0 rows in set.*this aql process only",
+            ),
+            (
+                # Both bins are indexed, the one not queried is still recorded as filtered.
+                "select * from test.{} where a-int = 0 and b-int = 5; show index advice".format(
+                    utils.SET_NAME
+                ),
+                r"[ab]-int.*NUMERIC.*DEFAULT.*\| 0 +\| 1 +\|.*1 row in set",
+            ),
+        ]
+    )
+    def test_select_index_advice(self, cmd, check_str):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), check_str)
+
+    def test_use_shm(self):
+        shm = ["--use-shm", "--shm-key", "0xA8000100"]
+        # Keeps the segment attached, later runs reuse its tended cluster.
+        holder = utils.spawn_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT)] + shm,
+            stdin=subprocess.PIPE,
+        )
+        self.addCleanup(holder.wait)
+        self.addCleanup(holder.stdin.close)
+        time.sleep(2)
+
+        for cmd in (
+            "select * from test.{} where pk = 'key1'".format(utils.SET_NAME),
+            "explain select * from test.{} where pk = 'key1'".format(utils.SET_NAME),
+        ):
+            output = utils.run_aql(
+                ["-h", self.ips[0], "-p", str(utils.PORT)] + shm + ["-c", cmd]
+            )
+            self.assertEqual(output.returncode, 0)
+            self.assertRegex(str(output.stdout), "1 row in set")
+            self.assertNotIn("Error", str(output.stdout))
+
+    def test_compare_with_self(self):
+        cmd = "compare test.{} with host '{}:{}'".format(
+            utils.SET_NAME, self.ips[0], utils.PORT
+        )
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), "0 of 4096 partitions differ")
+
+    def test_scan_nodes(self):
+        cmd = "scan nodes test.{}".format(utils.SET_NAME)
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), "records/s")
+        self.assertRegex(str(output.stdout), "OK")
+
+    def test_profile(self):
+        cmd = "profile test.{}".format(utils.SET_NAME)
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertRegex(str(output.stdout), "lut_age.*< 1h")
+        self.assertRegex(str(output.stdout), "generation.*0-1")
+        self.assertRegex(str(output.stdout), r"record_size \(all replicas\)")
+        # All 100 records were just written, in one bucket per histogram.
+        self.assertRegex(str(output.stdout), r"lut_age +\| < 1h +\|.*\| 100 +\|")
+        self.assertNotRegex(str(output.stdout), r"OK\\n")
+
     @parameterized.expand(
         [
             (
@@ -347,6 +572,14 @@ class SelectNegativeTest(unittest.TestCase):
                 "select * from test.{} where b = 3 and a = 3.3".format(utils.SET_NAME),
                 "Error: Equality match is only available for int and string bins",
             ),
+            (
+                "select exists from test.testset",
+                "EXISTS requires WHERE PK = <key> or WHERE PK IN (<key>, ...)",
+            ),
+            (
+                "select * from test.testset on node 'BB9' where pk = 'key1'",
+                "ON NODE is only supported on scans",
+            ),
         ]
     )
     def test_select_syntax_error(self, cmd, assert_str):
@@ -354,3 +587,145 @@ class SelectNegativeTest(unittest.TestCase):
         self.assertEqual(output.returncode, 0)
         print(str(output.stderr))
         self.assertTrue(assert_str in output.stderr.decode(sys.stdout.encoding))
+
+
+class SelectRoutingTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(utils.SET_NAME)
+
+    @parameterized.expand(
+        [
+            (["--replica", "master"],),
+            (["--replica", "any"],),
+            (["--read-mode-ap", "all"],),
+            (["--read-mode-sc", "allow-replica"],),
+        ]
+    )
+    def test_select_routed(self, routing):
+        # Plain reads and projections, which read through operate.
+        cmd = (
+            "select * from test.{0} where pk = 'key1'; "
+            "select int * 2 as dbl from test.{0} where pk = 'key1'"
+        ).format(utils.SET_NAME)
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT)] + routing + ["-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        self.assertEqual(str(output.stdout).count("1 row in set"), 2)
+        self.assertRegex(str(output.stdout), r"\| 2 +\|")
+
+    @parameterized.expand(
+        [
+            (["--replica", "nearest"], "Invalid replica nearest"),
+            (["--replica", "prefer-rack"], "Replica prefer-rack requires rack-id"),
+            (["--read-mode-ap", "some"], "Invalid read mode some"),
+        ]
+    )
+    def test_select_routing_invalid(self, routing, assert_str):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT)] + routing + ["-c", "show sets"]
+        )
+        self.assertIn(assert_str, output.stderr.decode(sys.stdout.encoding))
+
+
+class HintTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(utils.SET_NAME)
+
+    def run_cmd(self, cmd):
+        output = utils.run_aql(["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd])
+        self.assertEqual(output.returncode, 0)
+        return output.stdout.decode(), output.stderr.decode(sys.stdout.encoding)
+
+    def test_hint_applies(self):
+        stdout, stderr = self.run_cmd(
+            "select /*+ PARALLEL COMPRESS RETRIES( 3 ) RPS (5000) */ * from test.{}".format(
+                utils.SET_NAME
+            )
+        )
+        self.assertIn("100 rows in set", stdout)
+        self.assertNotIn("hint", stderr)
+
+    @parameterized.expand(
+        [
+            ("select /*+ BOGUS */ * from test.{}", "Unknown hint BOGUS"),
+            ("select /*+ PARALLEL(0) */ * from test.{}", "Unknown hint PARALLEL"),
+            ("select /*+ PARALLEL( 8 ) */ * from test.{}", "PARALLEL degree not supported"),
+            ("select /*+ RPS(fast) */ * from test.{}", "Unknown hint RPS"),
+            ("select /*+ PROFILE(fast) */ * from test.{}", "Unknown hint PROFILE"),
+            ("select /*+ COMPRESS * from test.{}", "Unterminated hint"),
+        ]
+    )
+    def test_hint_invalid(self, cmd, error):
+        stdout, stderr = self.run_cmd(cmd.format(utils.SET_NAME))
+        self.assertIn(error, stderr)
+        self.assertNotIn("rows in set", stdout)
+
+    def test_hint_in_string_is_data(self):
+        stdout, stderr = self.run_cmd(
+            "insert into test.{0} (PK, note) values ('hint1', 'a /*+ BOGUS */ b'); "
+            "select note from test.{0} where pk = 'hint1'".format(utils.SET_NAME)
+        )
+        self.assertNotIn("Unknown hint", stderr)
+        self.assertIn("a /*+ BOGUS */ b", stdout)
+
+    def test_hint_after_escaped_quote_is_data(self):
+        # The escaped quote keeps the string open, the comment is inside it.
+        stdout, stderr = self.run_cmd(
+            "select * from test.{} where pk = 'it\\'s /*+ BOGUS */'".format(
+                utils.SET_NAME
+            )
+        )
+        self.assertNotIn("Unknown hint", stderr)
+
+    @parameterized.expand(
+        [
+            ("interactive", "RECORD_EXISTS = CREATE", "MAX_RETRIES = 1"),
+            ("bulk", "RECORD_EXISTS = IGNORE", "MAX_RETRIES = 5"),
+        ]
+    )
+    def test_profile_loads(self, profile, exists, retries):
+        stdout, _ = self.run_cmd("set profile {}".format(profile))
+        self.assertIn(exists, stdout)
+        self.assertIn(retries, stdout)
+
+    def test_profile_option_makes_custom(self):
+        # A hand set option keeps the rest of the profile.
+        stdout, _ = self.run_cmd(
+            "set profile bulk; set compress false; get profile; get max_retries"
+        )
+        self.assertIn("PROFILE = CUSTOM", stdout)
+        self.assertIn("MAX_RETRIES = 5", stdout)
+
+    def test_profile_hint_is_one_statement(self):
+        stdout, _ = self.run_cmd(
+            "set profile interactive; "
+            "select /*+ PROFILE(bulk) */ * from test.{} where pk = 'key1'; "
+            "get profile; get record_exists".format(utils.SET_NAME)
+        )
+        self.assertIn("1 row in set", stdout)
+        self.assertTrue(stdout.rstrip().endswith("RECORD_EXISTS = CREATE"))
+        self.assertEqual(stdout.count("PROFILE = INTERACTIVE"), 2)
+
+    def test_profile_record_exists(self):
+        insert = "insert {} into test.{} (PK, int) values ('key2', 2)"
+
+        _, stderr = self.run_cmd(
+            "set profile interactive; " + insert.format("", utils.SET_NAME)
+        )
+        self.assertRegex(stderr, "(?i)exists")
+
+        # The hint overrides the session's profile for the statement.
+        _, stderr = self.run_cmd(
+            "set profile interactive; "
+            + insert.format("/*+ PROFILE(bulk) */", utils.SET_NAME)
+        )
+        self.assertNotRegex(stderr, "(?i)exists")
@@ -0,0 +1,91 @@
+import os
+import pty
+import tempfile
+import time
+import unittest
+import utils
+
+TRUNCATE_SET = "aql-serve-truncate"
+
+
+class ServeTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(utils.SET_NAME)
+        utils.populate_db(TRUNCATE_SET)
+
+        cls.dir = tempfile.mkdtemp()
+        cls.sock = os.path.join(cls.dir, "aql.sock")
+        # A terminal on the daemon's stdin, sessions must still never prompt.
+        cls.pty, tty = pty.openpty()
+        cls.addClassCleanup(os.close, cls.pty)
+        cls.daemon = utils.spawn_aql(
+            ["-h", cls.ips[0], "-p", str(utils.PORT), "--serve", cls.sock],
+            stdin=tty,
+        )
+        os.close(tty)
+        cls.addClassCleanup(cls.daemon.wait)
+        cls.addClassCleanup(cls.daemon.terminate)
+
+        for _ in range(50):
+            if os.path.exists(cls.sock):
+                break
+            time.sleep(0.1)
+
+    def run_client(self, args, **kwargs):
+        output = utils.run_aql(["--socket", self.sock] + args, **kwargs)
+        self.assertEqual(output.returncode, 0)
+        return str(output.stdout)
+
+    def test_command(self):
+        stdout = self.run_client(
+            ["-c", "select * from test.{} where pk = 'key1'".format(utils.SET_NAME)]
+        )
+        self.assertRegex(stdout, "1 row in set")
+
+    def test_file_with_quote_in_path(self):
+        # The file's lines are sent, its path never reaches the parser.
+        path = os.path.join(self.dir, "it's.aql")
+
+        with open(path, "w") as f:
+            f.write("select * from test.{} where pk = 'key2'\n".format(utils.SET_NAME))
+
+        stdout = self.run_client(["-f", path])
+        self.assertRegex(stdout, "1 row in set")
+
+    def test_sessions_keep_their_settings(self):
+        self.run_client(["-c", "set output json"])
+        stdout = self.run_client(
+            ["-c", "select * from test.{} where pk = 'key3'".format(utils.SET_NAME)]
+        )
+        self.assertRegex(stdout, "1 row in set")
+
+    def test_stdin(self):
+        stdout = self.run_client(
+            [],
+            input="select * from test.{} where pk = 'key4'\n".format(utils.SET_NAME).encode(),
+        )
+        self.assertRegex(stdout, "1 row in set")
+
+    def test_truncate_does_not_prompt(self):
+        stdout = self.run_client(
+            ["-c", "truncate test.{}".format(TRUNCATE_SET)], timeout=60
+        )
+        self.assertNotIn("[y/N]", stdout)
+        self.assertNotIn("Truncate cancelled", stdout)
+        self.assertIn("Truncate accepted", stdout)
+
+    def test_tail_is_refused(self):
+        # TAIL would hold every other session until the daemon is interrupted.
+        stdout = self.run_client(
+            ["-c", "tail test.{} interval 1s".format(utils.SET_NAME)], timeout=10
+        )
+        self.assertIn("not available in --serve", stdout)
+        stdout = self.run_client(
+            ["-c", "select * from test.{} where pk = 'key1'".format(utils.SET_NAME)],
+            timeout=10,
+        )
+        self.assertRegex(stdout, "1 row in set")
@@ -1,3 +1,4 @@
+import re
 import unittest
 from parameterized import parameterized
 import utils
@@ -74,3 +75,83 @@ class ShowPositiveTest(unittest.TestCase):
 
         self.assertCountEqual(list(rows[-1].keys()), ["node"])
         self.assertEqual(status[0]["Status"], 0)
+
+    @parameterized.expand(
+        [
+            (
+                "create index int_index on test.{} (int) numeric wait; drop index test int_index".format(
+                    utils.SET_NAME
+                ),
+                ["1 index created and readable", "1 index removed"],
+            ),
+            (
+                "create mapkeys index map_index on test.{} (map) string ctx ['a']; drop index test map_index".format(
+                    utils.SET_NAME
+                ),
+                ["1 index created", "1 index removed"],
+            ),
+            (
+                "set index_wait_timeout 60000; get index_wait_timeout; "
+                "create index int_wait_index on test.{} (int) numeric wait; "
+                "drop index test int_wait_index".format(utils.SET_NAME),
+                [
+                    "INDEX_WAIT_TIMEOUT = 60000",
+                    "1 index created and readable",
+                    "1 index removed",
+                ],
+            ),
+        ]
+    )
+    def test_create_drop_index(self, cmd: str, check_strs: list[str]):
+        output = utils.run_aql(["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd])
+        self.assertEqual(output.returncode, 0)
+
+        for check_str in check_strs:
+            self.assertIn(check_str, str(output.stdout))
+
+    def test_show_pool(self):
+        cmd = "set min_conns_per_node 4; show pool"
+        output = utils.run_aql(["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd])
+        self.assertEqual(output.returncode, 0)
+        self.assertIn("in_pool", str(output.stdout))
+        self.assertIn("MIN_CONNS_PER_NODE = 4", str(output.stdout))
+
+    def test_show_pool_arena(self):
+        # last_peak is the statement before SHOW POOL.
+        cmd = "select * from test.{} where pk = 'key1'; show pool".format(utils.SET_NAME)
+        output = utils.run_aql(["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd])
+        self.assertEqual(output.returncode, 0)
+        match = re.search(
+            r'\| "?statement"? +\| (\d+) +\| (\d+) +\| (\d+) +\|',
+            output.stdout.decode(),
+        )
+        self.assertIsNotNone(match)
+        last_peak, max_peak, committed = (int(g) for g in match.groups())
+        self.assertGreater(last_peak, 0)
+        self.assertGreaterEqual(max_peak, last_peak)
+        self.assertGreaterEqual(committed, max_peak)
+
+    def test_lazy_connect(self):
+        # Nothing listens on port 1. Settings alone never connect, a read does.
+        args = ["-h", "127.0.0.1", "-p", "1", "--timeout", "500"]
+        output = utils.run_aql(args + ["-c", "set record_ttl 100; get record_ttl"])
+        self.assertEqual(output.returncode, 0)
+        self.assertIn("RECORD_TTL = 100", str(output.stdout))
+        self.assertNotIn("Error", output.stderr.decode())
+
+        output = utils.run_aql(
+            args + ["-c", "select * from test.{} where pk = 'key1'".format(utils.SET_NAME)]
+        )
+        self.assertIn("Error", output.stderr.decode())
+
+    def test_pool_resize_after_connect(self):
+        # The note is logged, stdout only carries the setting.
+        cmd = "show pool; set max_conns_per_node 50"
+        output = utils.run_aql(["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd])
+        self.assertEqual(output.returncode, 0)
+        self.assertIn("MAX_CONNS_PER_NODE = 50", str(output.stdout))
+        self.assertNotIn("take effect", str(output.stdout))
+        self.assertIn(
+            "Connection pool sizes take effect on the next connect",
+            output.stderr.decode(),
+        )
@@ -0,0 +1,113 @@
+import sys
+import unittest
+import utils
+
+UDF_SET = "aql-udf-tests"
+
+
+class UdfLocalTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(UDF_SET)
+
+    def run_local(self, cmd):
+        output = utils.run_aql(
+            [
+                "-h", self.ips[0], "-p", str(utils.PORT),
+                "-u", utils.absolute_path("lua"),
+                "-c", cmd,
+            ]
+        )
+        self.assertEqual(output.returncode, 0)
+        return output
+
+    def test_execute_local_sample(self):
+        # Sampled records outlive the scan callback, their bins must too.
+        output = self.run_local(
+            "execute local localtest.int_bin() on test.{} sample 10".format(UDF_SET)
+        )
+        stdout = str(output.stdout)
+        self.assertRegex(stdout, "10 record\\(s\\), 10 call\\(s\\)")
+        self.assertRegex(stdout, r"\| +[0-4] +\|")
+
+    def test_execute_local_failure(self):
+        output = self.run_local(
+            "execute local localtest.fail() on test.{} sample 1".format(UDF_SET)
+        )
+        stderr = output.stderr.decode(sys.stdout.encoding)
+        self.assertIn("localtest.fail failed in the local Lua runtime", stderr)
+        self.assertIn("local failure", stderr)
+        self.assertNotIn("record(s)", str(output.stdout))
+
+
+class UdfAggregateTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(UDF_SET)
+        utils.run_aql(
+            [
+                "-h", cls.ips[0], "-p", str(utils.PORT), "-c",
+                "register module '{}'".format(utils.absolute_path("lua", "aggtest.lua")),
+            ]
+        )
+
+    def run_aql(self, cmd):
+        # The client runs the final reduce from its own copy of the module.
+        output = utils.run_aql(
+            [
+                "-h", self.ips[0], "-p", str(utils.PORT),
+                "-u", utils.absolute_path("lua"),
+                "-c", cmd,
+            ]
+        )
+        self.assertEqual(output.returncode, 0)
+        return str(output.stdout)
+
+    def aggregate(self, func, reduce_threads):
+        return self.run_aql(
+            "set reduce_threads {}; aggregate aggtest.{}() on test.{}".format(
+                reduce_threads, func, UDF_SET
+            )
+        )
+
+    def test_reduce_threads_merge(self):
+        # int is idx % 5 over 100 records.
+        serial = self.aggregate("sum_int", 0)
+        parallel = self.aggregate("sum_int", 4)
+        self.assertRegex(serial, r"\| 200 +\|")
+        self.assertRegex(parallel, r"\| 200 +\|")
+        self.assertRegex(parallel, "1 row in set")
+
+    def test_stream_values(self):
+        # One row per record, rendered without a record around each value.
+        table = self.run_aql(
+            "set record_print_metadata true; aggregate aggtest.int_values() on test.{}".format(UDF_SET)
+        )
+        self.assertRegex(table, "100 rows in set")
+        self.assertNotIn("{ttl}", table)
+
+        output = utils.run_aql(
+            [
+                "-h", self.ips[0], "-p", str(utils.PORT),
+                "-u", utils.absolute_path("lua"),
+                "-c", "set output json; aggregate aggtest.int_values() on test.{}".format(UDF_SET),
+            ]
+        )
+        self.assertEqual(output.returncode, 0)
+        rows = utils.parse_json_output(output.stdout)[0]
+        self.assertEqual(len(rows), 100)
+        self.assertTrue(all(len(row) == 1 for row in rows))
+        self.assertEqual(sum(list(row.values())[0] for row in rows), 200)
+
+    def test_reduce_threads_map_after_reduce(self):
+        serial = self.aggregate("sum_int_labeled", 0)
+        parallel = self.aggregate("sum_int_labeled", 4)
+        self.assertRegex(serial, "total.*200")
+        self.assertRegex(parallel, "total.*200")
+        self.assertNotIn("Merging reduce results failed", parallel)
@@ -189,20 +189,41 @@ def check_for_valgrind() -> bool:
     return os.path.isfile("valgrind")
 
 
-def run_aql(args=None) -> subprocess.CompletedProcess:
+def _target_cmd(name, args=None) -> list[str]:
     cmds = [
-        "../target/Linux-x86_64/bin/aql",
-        "../target/Darwin-x86_64/bin/aql",
-        "../target/Darwin-arm64/bin/aql",
-        "target/Linux-x86_64/bin/aql",
-        "target/Darwin-x86_64/bin/aql",
-        "target/Darwin-arm64/bin/aql",
+        "../target/Linux-x86_64/bin/" + name,
+        "../target/Darwin-x86_64/bin/" + name,
+        "../target/Darwin-arm64/bin/" + name,
+        "target/Linux-x86_64/bin/" + name,
+        "target/Darwin-x86_64/bin/" + name,
+        "target/Darwin-arm64/bin/" + name,
     ]
 
     cmd = [cmd for cmd in cmds if os.path.isfile(cmd)]
     args = [] if args is None else args
     cmd.extend(args)
-    return subprocess.run(cmd, capture_output=True)
+    return cmd
+
+
+def _aql_cmd(args=None) -> list[str]:
+    return _target_cmd("aql", args)
+
+
+def run_aql(args=None, **kwargs) -> subprocess.CompletedProcess:
+    return subprocess.run(_aql_cmd(args), capture_output=True, **kwargs)
+
+
+def run_aql_embed(args=None, **kwargs) -> subprocess.CompletedProcess:
+    """Runs statements through libaql, see src/test/aql_embed.c."""
+    return subprocess.run(
+        _target_cmd("aql-embed", args), capture_output=True, **kwargs
+    )
+
+
+def spawn_aql(args=None, **kwargs) -> subprocess.Popen:
+    return subprocess.Popen(
+        _aql_cmd(args), stdout=subprocess.PIPE, stderr=subprocess.PIPE, **kwargs
+    )
 
 
 def create_client(seed: tuple[str, int] = None):
@@ -0,0 +1,114 @@
+import os
+import tempfile
+import time
+import unittest
+import utils
+
+WRITE_SET = "aql-write-tests"
+TRUNCATE_SET = "aql-truncate-tests"
+BACKGROUND_SET = "aql-background-tests"
+COPY_SRC_SET = "aql-copy-src-tests"
+COPY_DST_SET = "aql-copy-dst-tests"
+
+
+class WritePositiveTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls) -> None:
+        cls.ips = utils.run_containers(utils.SET_NAME, 1, version=utils.AEROSPIKE_VERSION)
+        cls.addClassCleanup(lambda: utils.shutdown_containers(utils.SET_NAME))
+        utils.create_client((cls.ips[0], utils.PORT))
+        utils.populate_db(WRITE_SET)
+
+    def run_cmd(self, cmd):
+        output = utils.run_aql(
+            ["-h", self.ips[0], "-p", str(utils.PORT), "-c", cmd]
+        )
+        self.assertEqual(output.returncode, 0)
+        return str(output.stdout)
+
+    def wait_for_records(self, set_name, check, timeout=30):
+        # Background jobs finish after aql returns, poll the records.
+        deadline = time.time() + timeout
+        while True:
+            records = [
+                utils.as_client.get(("test", set_name, "key" + str(i)))
+                for i in range(100)
+            ]
+            if all(check(meta, bins) for _, meta, bins in records):
+                return
+            if time.time() > deadline:
+                self.fail("background job did not reach every record")
+            time.sleep(0.5)
+
+    def test_background_update_and_touch(self):
+        utils.populate_db(BACKGROUND_SET)
+
+        stdout = self.run_cmd("update test.{} set tag = 'done'".format(BACKGROUND_SET))
+        self.assertRegex(stdout, r"Scan job \(\d+\) created")
+        self.wait_for_records(BACKGROUND_SET, lambda meta, bins: bins.get("tag") == "done")
+
+        stdout = self.run_cmd("touch test.{} ttl 86400".format(BACKGROUND_SET))
+        self.assertRegex(stdout, r"Scan job \(\d+\) created")
+        self.wait_for_records(BACKGROUND_SET, lambda meta, bins: 0 < meta["ttl"] <= 86400)
+
+    def test_insert_select_copies_set(self):
+        utils.populate_db(COPY_SRC_SET)
+        stdout = self.run_cmd(
+            "insert into test.{0} select * from test.{1}; "
+            "select * from test.{0}; "
+            "select int, str from test.{0} where pk = 'key7'".format(
+                COPY_DST_SET, COPY_SRC_SET
+            )
+        )
+        self.assertIn("100 records copied.", stdout)
+        self.assertRegex(stdout, "100 rows in set")
+        self.assertRegex(stdout, r'\| 2 +\| "?7"? +\|')
+
+    def test_update_decrement_without_spaces(self):
+        # "int-1" lexes as one identifier, it must still decrement "int".
+        stdout = self.run_cmd(
+            "update test.{0} set int = int-1 where pk = 'key1'; "
+            "select int from test.{0} where pk = 'key1'".format(WRITE_SET)
+        )
+        self.assertRegex(stdout, "1 record affected")
+        self.assertRegex(stdout, r"\| 0 +\|")
+
+    def test_truncate_waits_for_records(self):
+        utils.populate_db(TRUNCATE_SET)
+        stdout = self.run_cmd(
+            "truncate test.{0}; select * from test.{0}".format(TRUNCATE_SET)
+        )
+        self.assertIn("Truncate done.", stdout)
+        self.assertRegex(stdout, "0 rows in set")
+
+    def test_script_with_large_literal(self):
+        # Many statements nested under RUN, one literal larger than the
+        # arena's first pages.
+        big = "x" * 200000
+        with tempfile.NamedTemporaryFile("w", suffix=".aql", delete=False) as f:
+            for i in range(200):
+                f.write(
+                    "insert into test.{} (PK, n) values ('run{}', {})\n".format(
+                        WRITE_SET, i, i
+                    )
+                )
+            f.write(
+                "insert into test.{} (PK, big) values ('big', '{}')\n".format(
+                    WRITE_SET, big
+                )
+            )
+        self.addCleanup(os.remove, f.name)
+
+        output = utils.run_aql(
+            [
+                "-h", self.ips[0], "-p", str(utils.PORT), "-c",
+                "run '{0}'; set output json; "
+                "select n from test.{1} where pk = 'run199'; "
+                "select big from test.{1} where pk = 'big'".format(f.name, WRITE_SET),
+            ]
+        )
+        self.assertEqual(output.returncode, 0)
+        stdout = output.stdout.decode()
+        self.assertEqual(stdout.count("1 record affected"), 201)
+        self.assertRegex(stdout, r'"n":\s*199')
+        self.assertIn(big, stdout)